@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "benchStream.hpp"
+
+#define MAX_LINE 1024
+
+void BenchStream::feed(const uint8_t * bytes, size_t length)
+{
+	for(size_t i = 0; i < length; i++)
+	{
+		uint8_t byte = bytes[i];
+
+		if(byte == 0)
+		{
+			if(inFrame) frameEnd();
+			else inFrame = true;
+			continue;
+		}
+
+		if(inFrame)
+		{
+			// Nothing the brain sends is this long, so the toggle is out of step
+			if(frame.size() < RPC_MAX_FRAME * 2) frame.push_back(byte);
+			else
+			{
+				for(uint8_t text : frame) textByte(text);
+				frame.clear();
+				inFrame = false;
+				textByte(byte);
+			}
+		}
+		else textByte(byte);
+	}
+}
+
+void BenchStream::frameEnd()
+{
+	// 0x00 0x00 is a closing delimiter followed by an opening one: stay in a frame
+	if(frame.empty()) return;
+
+	decoded.resize(frame.size());
+	int length = cobsDecode(decoded.data(), frame.data(), frame.size());
+	uint32_t prefix = 0;
+	if(length >= 4) memcpy(&prefix, decoded.data(), 4);
+
+	if(prefix == RPC_STREAM_SAMPLES && length >= (int)(4 + sizeof(RpcSampleHeader)))
+	{
+		RpcSampleHeader header;
+		memcpy(&header, decoded.data() + 4, sizeof(header));
+		if(4 + sizeof(header) + header.count * sizeof(RpcSample) == (size_t)length)
+		{
+			std::vector<RpcSample> sample(header.count);
+			memcpy(sample.data(), decoded.data() + 4 + sizeof(header), header.count * sizeof(RpcSample));
+			sink.samples(header, sample.data());
+			frames++;
+		}
+		else dropped++;
+	}
+	else if(prefix == RPC_STREAM_RESPONSE && length >= 7)
+	{
+		const uint8_t * response = decoded.data() + 4;
+		size_t dataLength = length - 7;
+		RpcPortResult port = {};
+
+		if(response[0] == (RPC_DUMP_RESULTS | RPC_RESPONSE_FLAG) && response[2] == RPC_MORE && dataLength >= sizeof(port) - sizeof(port.result))
+		{
+			memcpy(&port, response + 3, std::min(dataLength, sizeof(port)));
+			BenchResult result = {};
+			result.haveTime = false;
+			result.port = port.port;
+			result.state = port.state;
+			result.flags = port.flags;
+			result.averageScore = port.averageScore;
+			result.coastTime = port.coastTime;
+			result.breakTime = port.breakTime;
+			result.resultCount = std::min((int)port.resultCount, 8);
+			memcpy(result.result, port.result, sizeof(result.result));
+			sink.result(result);
+		}
+		frames++;
+	}
+	else
+	{
+		// Not a frame after all, so this 0x00 opened one
+		for(uint8_t byte : frame) textByte(byte);
+		dropped++;
+	}
+
+	frame.clear();
+	inFrame = prefix != RPC_STREAM_SAMPLES && prefix != RPC_STREAM_RESPONSE;
+}
+
+void BenchStream::textByte(uint8_t byte)
+{
+	if(byte == '\n') textLine();
+	else if(byte != '\r' && line.size() < MAX_LINE) line.push_back(byte);
+}
+
+void BenchStream::textLine()
+{
+	BenchResult result;
+	if(parseResultLine(line, result)) sink.result(result);
+	else if(!line.empty()) sink.text(line);
+	line.clear();
+}
+
+bool parseResultLine(const std::string & line, BenchResult & result)
+{
+	unsigned long time;
+	int timedOut, notRunning, currentError, brakeError;
+	int consumed = 0;
+
+	result = {};
+	if(sscanf(line.c_str(), "RESULT %lu port=%d state=%d score=%f coast=%d brake=%d to=%d nr=%d c=%d b=%d%n", &time, &result.port, &result.state,
+		&result.averageScore, &result.coastTime, &result.breakTime, &timedOut, &notRunning, &currentError, &brakeError, &consumed) != 10)
+		return false;
+
+	result.haveTime = true;
+	result.brainTime = time;
+	result.flags = (timedOut ? RPC_TIMED_OUT : 0) | (notRunning ? 0 : RPC_MOTOR_WORKING)
+		| (currentError ? 0 : RPC_CURRENT_WORKING) | (brakeError ? 0 : RPC_BREAK_MODE_WORKING);
+
+	// Optional " e=1" for an encoder error, after the settle list
+	const char * encoder = strstr(line.c_str() + consumed, " e=");
+	if(encoder != NULL && atoi(encoder + 3) != 0) result.flags |= RPC_ENCODER_ERROR;
+
+	// Optional " settle=speed:current,speed:current,..."
+	const char * settle = strstr(line.c_str() + consumed, "settle=");
+	if(settle != NULL)
+	{
+		const char * cursor = settle + 7;
+		while(*cursor != 0 && *cursor != ' ' && result.resultCount < 8)
+		{
+			char * end;
+			float speed = strtof(cursor, &end);
+			if(end == cursor || *end != ':') break;
+			cursor = end + 1;
+			long current = strtol(cursor, &end, 10);
+			if(end == cursor) break;
+			result.result[result.resultCount++] = {speed, (int16_t)current};
+			cursor = *end == ',' ? end + 1 : end;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "rpc.hpp"
+
+/**
+ * A finished test as the brain reports it, either from a RESULT text line or
+ * from an RPC_DUMP_RESULTS frame. Mirrors the finished-test part of PortData.
+ */
+struct BenchResult
+{
+	bool haveTime;
+	uint32_t brainTime;
+	int port; // 1-21
+	int state;
+	int flags; // RpcResultFlag
+	float averageScore;
+	int coastTime;
+	int breakTime;
+	int resultCount;
+	RpcResult result[8];
+};
+
+class BenchSink
+{
+public:
+	virtual ~BenchSink() {}
+	virtual void samples(const RpcSampleHeader & header, const RpcSample * sample) = 0;
+	virtual void result(const BenchResult & result) = 0;
+	virtual void text(const std::string & line) {}
+};
+
+/**
+ * Splits the byte stream from one brain into RPC frames and text lines.
+ *
+ * The brain writes every frame as 0x00, COBS data, 0x00 and everything else
+ * is printf text. The splitter toggles between text and frame on each 0x00.
+ * When it joins mid-frame it gets the toggle backwards; the segment then
+ * fails to decode, is handled as text and the state flips back, so it is in
+ * step again from the next frame on.
+ */
+class BenchStream
+{
+public:
+	explicit BenchStream(BenchSink & sink) : sink(sink) {}
+
+	void feed(const uint8_t * bytes, size_t length);
+
+	uint64_t framesDecoded() const {return frames;}
+	uint64_t framesDropped() const {return dropped;}
+
+private:
+	void frameEnd();
+	void textByte(uint8_t byte);
+	void textLine();
+
+	BenchSink & sink;
+	bool inFrame = false;
+	std::vector<uint8_t> frame;
+	std::vector<uint8_t> decoded;
+	std::string line;
+	uint64_t frames = 0;
+	uint64_t dropped = 0;
+};
+
+/**
+ * Parses a RESULT line as printed by writeRecords(). Returns false for any
+ * other line.
+ */
+bool parseResultLine(const std::string & line, BenchResult & result);
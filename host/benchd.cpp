@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+#include "benchStream.hpp"
+#include "columnStore.hpp"
+
+/**
+ * Ingestion daemon: reads the serial stream of one or more benches and
+ * appends samples and results to a column store.
+ *
+ * A source is a tty, a FIFO, a recorded file or - for stdin. ttys and FIFOs
+ * are reopened when they close, so the daemon keeps running across a brain
+ * restart or a new writer; files and stdin are read to the end once. The
+ * daemon exits when nothing reopenable is left, or on SIGINT/SIGTERM.
+ */
+#define REOPEN_INTERVAL 2000
+#define READ_SIZE 4096
+
+static volatile sig_atomic_t stopping = 0;
+
+static int64_t nowMs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+class SourceSink : public BenchSink
+{
+public:
+	SourceSink(StoreWriter & store, int bench) : store(store), bench(bench) {}
+
+	void samples(const RpcSampleHeader & header, const RpcSample * sample) override
+	{
+		if(header.port < 1 || header.port > 21) return;
+
+		// The stream restarts at index 0 when a port is retested; otherwise skip what was already stored
+		uint32_t & next = nextIndex[header.port];
+		if(header.firstIndex == 0) next = 0;
+
+		for(int i = 0; i < header.count; i++)
+		{
+			if(header.firstIndex + i < next) continue;
+			int64_t row[SAMPLE_COLUMN_COUNT];
+			row[SAMPLE_TIME] = hostTime(sample[i].time);
+			row[SAMPLE_BRAIN_TIME] = sample[i].time;
+			row[SAMPLE_STATE] = header.state;
+			row[SAMPLE_APPLIED_VOLTAGE] = sample[i].appliedVoltage;
+			row[SAMPLE_REQUESTED_VOLTAGE] = sample[i].requestedVoltage;
+			row[SAMPLE_CURRENT] = sample[i].current;
+			row[SAMPLE_VELOCITY] = sample[i].velocity;
+			store.append(TABLE_SAMPLES, bench, header.port, row);
+			sampleCount++;
+		}
+		next = std::max(next, header.firstIndex + header.count);
+	}
+
+	void result(const BenchResult & result) override
+	{
+		if(result.port < 1 || result.port > 21) return;
+
+		// A results dump repeats what the RESULT lines already reported
+		BenchResult & last = lastResult[result.port];
+		if(!result.haveTime && last.port == result.port && last.state == result.state && last.flags == result.flags && last.averageScore == result.averageScore
+			&& last.coastTime == result.coastTime && last.breakTime == result.breakTime) return;
+		last = result;
+
+		uint32_t brainTime = result.haveTime ? result.brainTime : lastBrainTime;
+		int64_t row[RESULT_COLUMN_COUNT] = {};
+		row[RESULT_TIME] = result.haveTime ? hostTime(brainTime) : nowMs();
+		row[RESULT_BRAIN_TIME] = brainTime;
+		row[RESULT_STATE] = result.state;
+		row[RESULT_FLAGS] = result.flags;
+		row[RESULT_AVERAGE_SCORE] = llround(result.averageScore * 100);
+		row[RESULT_COAST_TIME] = result.coastTime;
+		row[RESULT_BREAK_TIME] = result.breakTime;
+		row[RESULT_COUNT] = result.resultCount;
+		for(int i = 0; i < result.resultCount && i < STORE_MAX_RESULTS; i++)
+		{
+			row[RESULT_SETTLE_SPEED + i] = llround(result.result[i].settleSpeed * 100);
+			row[RESULT_SETTLE_CURRENT + i] = result.result[i].settleCurrent;
+		}
+		store.append(TABLE_RESULTS, bench, result.port, row);
+		resultCount++;
+	}
+
+	uint64_t sampleCount = 0;
+	uint64_t resultCount = 0;
+
+private:
+	// Brain time is millis() since boot; pin it to the wall clock at first sight and again after a restart
+	int64_t hostTime(uint32_t brainTime)
+	{
+		if(!synced || brainTime + 1000 < lastBrainTime)
+		{
+			offset = nowMs() - brainTime;
+			synced = true;
+		}
+		lastBrainTime = brainTime;
+		return brainTime + offset;
+	}
+
+	StoreWriter & store;
+	int bench;
+	bool synced = false;
+	int64_t offset = 0;
+	uint32_t lastBrainTime = 0;
+	uint32_t nextIndex[22] = {};
+	BenchResult lastResult[22] = {};
+};
+
+struct Source
+{
+	std::string name;
+	std::string path;
+	int fd = -1;
+	bool reopen = false;
+	bool finished = false;
+	int64_t lastAttempt = 0;
+	FILE * record = NULL;
+	std::unique_ptr<SourceSink> sink;
+	std::unique_ptr<BenchStream> stream;
+};
+
+static bool openSource(Source & source)
+{
+	source.lastAttempt = nowMs();
+
+	if(source.path == "-")
+	{
+		source.fd = STDIN_FILENO;
+		return true;
+	}
+
+	source.fd = open(source.path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	if(source.fd < 0) return false;
+
+	struct stat status;
+	fstat(source.fd, &status);
+	source.reopen = S_ISCHR(status.st_mode) || S_ISFIFO(status.st_mode);
+
+	// The V5 USB port is CDC ACM, so the baud rate is nominal; raw mode is what matters
+	struct termios terminal;
+	if(isatty(source.fd) && tcgetattr(source.fd, &terminal) == 0)
+	{
+		cfmakeraw(&terminal);
+		cfsetspeed(&terminal, B115200);
+		tcsetattr(source.fd, TCSANOW, &terminal);
+	}
+
+	return true;
+}
+
+static void closeSource(Source & source)
+{
+	if(source.fd > STDIN_FILENO) close(source.fd);
+	source.fd = -1;
+	if(!source.reopen) source.finished = true;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: benchd -d STORE [-f SECONDS] [-r DIR] NAME=SOURCE...\n"
+		"  -d STORE    column store directory, created if missing\n"
+		"  -f SECONDS  write partial blocks after this long (default 5)\n"
+		"  -r DIR      also append each bench's raw stream to DIR/NAME.raw\n"
+		"  SOURCE      tty, FIFO, recorded stream file, or - for stdin\n");
+}
+
+static void stop(int signal) {stopping = 1;}
+
+int main(int argc, char ** argv)
+{
+	std::string storePath;
+	std::string recordPath;
+	int64_t flushAge = 5000;
+	std::vector<Source> sources;
+
+	int option;
+	while((option = getopt(argc, argv, "d:f:r:h")) != -1)
+	{
+		switch(option)
+		{
+		case 'd': storePath = optarg; break;
+		case 'f': flushAge = atof(optarg) * 1000; break;
+		case 'r': recordPath = optarg; break;
+		default: usage(); return 2;
+		}
+	}
+
+	for(int i = optind; i < argc; i++)
+	{
+		const char * equals = strchr(argv[i], '=');
+		if(equals == NULL || equals == argv[i])
+		{
+			usage();
+			return 2;
+		}
+		sources.emplace_back();
+		sources.back().name.assign(argv[i], equals - argv[i]);
+		sources.back().path = equals + 1;
+	}
+	if(storePath.empty() || sources.empty())
+	{
+		usage();
+		return 2;
+	}
+
+	StoreWriter store;
+	if(!store.open(storePath))
+	{
+		fprintf(stderr, "benchd: cannot open store %s: %s\n", storePath.c_str(), strerror(errno));
+		return 1;
+	}
+
+	for(Source & source : sources)
+	{
+		source.sink.reset(new SourceSink(store, store.benchId(source.name)));
+		source.stream.reset(new BenchStream(*source.sink));
+		if(!recordPath.empty()) source.record = fopen((recordPath + "/" + source.name + ".raw").c_str(), "ab");
+		if(!openSource(source))
+		{
+			fprintf(stderr, "benchd: %s: cannot open %s: %s\n", source.name.c_str(), source.path.c_str(), strerror(errno));
+			source.reopen = strncmp(source.path.c_str(), "/dev/", 5) == 0;
+			source.finished = !source.reopen;
+		}
+	}
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+
+	uint8_t buffer[READ_SIZE];
+	while(!stopping)
+	{
+		std::vector<pollfd> polled;
+		std::vector<Source *> owner;
+		bool active = false;
+
+		for(Source & source : sources)
+		{
+			if(source.finished) continue;
+			active = true;
+			if(source.fd < 0)
+			{
+				if(nowMs() - source.lastAttempt >= REOPEN_INTERVAL && openSource(source))
+					fprintf(stderr, "benchd: %s: reopened %s\n", source.name.c_str(), source.path.c_str());
+				if(source.fd < 0) continue;
+			}
+			polled.push_back({source.fd, POLLIN, 0});
+			owner.push_back(&source);
+		}
+		if(!active) break;
+
+		int ready = poll(polled.data(), polled.size(), 250);
+		if(ready < 0 && errno != EINTR) break;
+
+		for(size_t i = 0; i < polled.size() && ready > 0; i++)
+		{
+			Source & source = *owner[i];
+			if(polled[i].revents == 0) continue;
+
+			ssize_t length = read(source.fd, buffer, sizeof(buffer));
+			if(length > 0)
+			{
+				source.stream->feed(buffer, length);
+				if(source.record != NULL) fwrite(buffer, 1, length, source.record);
+			}
+			else if(length == 0 || (errno != EAGAIN && errno != EINTR)) closeSource(source);
+		}
+
+		store.flush(nowMs(), flushAge);
+	}
+
+	store.close();
+
+	for(Source & source : sources)
+	{
+		fprintf(stderr, "benchd: %s: %llu frames, %llu dropped, %llu samples, %llu results\n", source.name.c_str(), (unsigned long long)source.stream->framesDecoded(),
+			(unsigned long long)source.stream->framesDropped(), (unsigned long long)source.sink->sampleCount, (unsigned long long)source.sink->resultCount);
+		if(source.record != NULL) fclose(source.record);
+		if(source.fd > STDIN_FILENO) close(source.fd);
+	}
+
+	return 0;
+}
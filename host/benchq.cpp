@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "columnStore.hpp"
+#include "rpc.hpp"
+
+/**
+ * Query tool for a store written by benchd.
+ *
+ *   benchq STORE info
+ *   benchq STORE stats TABLE COLUMN [filters]
+ *   benchq STORE find CONDITION [filters]
+ *
+ * COLUMN settleSpeed or settleCurrent without a test point index reports
+ * every test point. Filters narrow by bench, port and time.
+ */
+static void usage()
+{
+	fprintf(stderr,
+		"usage: benchq STORE info\n"
+		"       benchq STORE stats samples|results COLUMN [filters]\n"
+		"       benchq STORE find CONDITION [filters]\n"
+		"conditions: brake-error, current-error, encoder-error, not-running, timeout, failed, passed, state=N, score<X, score>X\n"
+		"filters:    --bench NAME  --port N  --since 30m|24h|7d  --from UNIX  --to UNIX\n");
+}
+
+static int64_t nowMs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static bool parseDuration(const char * text, int64_t & ms)
+{
+	char * end;
+	double value = strtod(text, &end);
+	if(end == text) return false;
+
+	switch(*end)
+	{
+	case 's': ms = value * 1000; break;
+	case 'm': ms = value * 60000; break;
+	case 'h': ms = value * 3600000; break;
+	case 'd': ms = value * 86400000; break;
+	case 'w': ms = value * 604800000; break;
+	default: return false;
+	}
+	return true;
+}
+
+static std::string formatTime(int64_t ms)
+{
+	time_t seconds = ms / 1000;
+	struct tm local;
+	localtime_r(&seconds, &local);
+	char text[32];
+	strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+	return text;
+}
+
+static bool parseFilters(const StoreReader & reader, int argc, char ** argv, int first, StoreFilter & filter)
+{
+	for(int i = first; i < argc; i++)
+	{
+		if(i + 1 >= argc) return false;
+		const char * option = argv[i];
+		const char * value = argv[++i];
+
+		if(strcmp(option, "--bench") == 0)
+		{
+			filter.bench = reader.benchId(value);
+			if(filter.bench < 0)
+			{
+				fprintf(stderr, "benchq: no bench named %s\n", value);
+				return false;
+			}
+		}
+		else if(strcmp(option, "--port") == 0) filter.port = atoi(value);
+		else if(strcmp(option, "--since") == 0)
+		{
+			int64_t duration;
+			if(!parseDuration(value, duration)) return false;
+			filter.from = nowMs() - duration;
+		}
+		else if(strcmp(option, "--from") == 0) filter.from = atoll(value) * 1000;
+		else if(strcmp(option, "--to") == 0) filter.to = atoll(value) * 1000;
+		else return false;
+	}
+	return true;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int info(const StoreReader & reader)
+{
+	for(int t = 0; t < TABLE_COUNT; t++)
+	{
+		StoreTable table = (StoreTable)t;
+		uint64_t rows = 0;
+		for(const StoreBlock & block : reader.blocks(table)) rows += block.rows;
+
+		// Raw size as the equivalent row of int32 values
+		double raw = (double)rows * storeColumns(table).size() * 4;
+		printf("%-8s %10llu rows %7zu blocks %12llu B %6.2f B/row  %5.1fx vs int32\n", storeTableName(table), (unsigned long long)rows,
+			reader.blocks(table).size(), (unsigned long long)reader.dataBytes(table), rows ? (double)reader.dataBytes(table) / rows : 0,
+			reader.dataBytes(table) ? raw / reader.dataBytes(table) : 0);
+	}
+
+	printf("benches:");
+	for(const std::string & name : reader.benchNames()) printf(" %s", name.c_str());
+	printf("\n");
+	return 0;
+}
+
+static void printStats(const std::string & name, std::vector<int64_t> & values, int scale)
+{
+	if(values.empty())
+	{
+		printf("%-18s no rows\n", name.c_str());
+		return;
+	}
+
+	double sum = 0;
+	for(int64_t value : values) sum += value;
+
+	auto percentile = [&](double p)
+	{
+		size_t rank = std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5));
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+		return (double)values[rank] / scale;
+	};
+
+	double p50 = percentile(0.50);
+	double p95 = percentile(0.95);
+	double p99 = percentile(0.99);
+	auto range = std::minmax_element(values.begin(), values.end());
+
+	printf("%-18s n=%-10zu mean=%-9.2f min=%-9.2f p50=%-9.2f p95=%-9.2f p99=%-9.2f max=%.2f\n", name.c_str(), values.size(), sum / values.size() / scale,
+		(double)*range.first / scale, p50, p95, p99, (double)*range.second / scale);
+}
+
+static int stats(const StoreReader & reader, StoreTable table, const std::string & name, const StoreFilter & filter)
+{
+	const std::vector<StoreColumn> & columns = storeColumns(table);
+	std::vector<int> selected;
+
+	int exact = storeColumnIndex(table, name);
+	if(exact >= 0) selected.push_back(exact);
+	else for(size_t i = 0; i < columns.size(); i++) if(columns[i].testPoint >= 0 && columns[i].name.compare(0, name.size(), name) == 0) selected.push_back(i);
+
+	if(selected.empty())
+	{
+		fprintf(stderr, "benchq: %s has no column %s\n", storeTableName(table), name.c_str());
+		return 2;
+	}
+
+	// Settle columns past a row's resultCount are padding, not zero readings
+	bool testPoints = columns[selected[0]].testPoint >= 0;
+	std::vector<int> scanned = selected;
+	if(testPoints) scanned.push_back(RESULT_COUNT);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::vector<int64_t>> values(selected.size());
+	uint64_t rows = reader.scan(table, filter, scanned, [&](const StoreBlock & block, const int64_t * row)
+	{
+		for(size_t c = 0; c < selected.size(); c++)
+			if(!testPoints || columns[selected[c]].testPoint < row[selected.size()]) values[c].push_back(row[c]);
+	});
+
+	for(size_t c = 0; c < selected.size(); c++) if(!values[c].empty() || exact >= 0) printStats(columns[selected[c]].name, values[c], columns[selected[c]].scale);
+	printf("(%llu rows, %.1f ms)\n", (unsigned long long)rows, elapsedMs(start));
+	return 0;
+}
+
+static int find(const StoreReader & reader, const std::string & condition, const StoreFilter & filter)
+{
+	int mask = 0;
+	int expected = 0;
+	int state = -1;
+	int scoreSign = 0;
+	double score = 0;
+
+	if(condition == "brake-error") mask = RPC_BREAK_MODE_WORKING;
+	else if(condition == "current-error") mask = RPC_CURRENT_WORKING;
+	else if(condition == "encoder-error") mask = expected = RPC_ENCODER_ERROR;
+	else if(condition == "not-running") mask = RPC_MOTOR_WORKING;
+	else if(condition == "timeout") mask = expected = RPC_TIMED_OUT;
+	else if(condition == "failed") state = 102;
+	else if(condition == "passed") state = 100;
+	else if(condition.compare(0, 6, "state=") == 0) state = atoi(condition.c_str() + 6);
+	else if(condition.compare(0, 6, "score<") == 0 || condition.compare(0, 6, "score>") == 0)
+	{
+		scoreSign = condition[5] == '<' ? -1 : 1;
+		score = atof(condition.c_str() + 6);
+	}
+	else
+	{
+		usage();
+		return 2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t matches = 0;
+	std::vector<int> columns = {RESULT_TIME, RESULT_STATE, RESULT_FLAGS, RESULT_AVERAGE_SCORE, RESULT_COAST_TIME, RESULT_BREAK_TIME};
+
+	uint64_t rows = reader.scan(TABLE_RESULTS, filter, columns, [&](const StoreBlock & block, const int64_t * row)
+	{
+		if(mask != 0 && (row[2] & mask) != expected) return;
+		if(state >= 0 && row[1] != state) return;
+		if(scoreSign != 0 && (row[3] / 100.0 - score) * scoreSign <= 0) return;
+
+		printf("%-12s port %-2d %s state=%lld score=%.2f coast=%lld brake=%lld%s%s%s%s%s\n", reader.benchNames()[block.bench].c_str(), block.port,
+			formatTime(row[0]).c_str(), (long long)row[1], row[3] / 100.0, (long long)row[4], (long long)row[5], row[2] & RPC_TIMED_OUT ? " TIMEOUT" : "",
+			row[2] & RPC_MOTOR_WORKING ? "" : " NR-ERR", row[2] & RPC_CURRENT_WORKING ? "" : " C-ERR", row[2] & RPC_BREAK_MODE_WORKING ? "" : " B-ERR",
+			row[2] & RPC_ENCODER_ERROR ? " E-ERR" : "");
+		matches++;
+	});
+
+	printf("(%llu of %llu results, %.1f ms)\n", (unsigned long long)matches, (unsigned long long)rows, elapsedMs(start));
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	if(argc < 3)
+	{
+		usage();
+		return 2;
+	}
+
+	StoreReader reader;
+	if(!reader.open(argv[1]))
+	{
+		fprintf(stderr, "benchq: cannot open store %s\n", argv[1]);
+		return 1;
+	}
+
+	std::string command = argv[2];
+	StoreFilter filter;
+
+	if(command == "info") return info(reader);
+
+	if(command == "stats" && argc >= 5)
+	{
+		StoreTable table = strcmp(argv[3], "samples") == 0 ? TABLE_SAMPLES : strcmp(argv[3], "results") == 0 ? TABLE_RESULTS : TABLE_COUNT;
+		if(table == TABLE_COUNT || !parseFilters(reader, argc, argv, 5, filter))
+		{
+			usage();
+			return 2;
+		}
+		return stats(reader, table, argv[4], filter);
+	}
+
+	if(command == "find" && argc >= 4)
+	{
+		if(!parseFilters(reader, argc, argv, 4, filter))
+		{
+			usage();
+			return 2;
+		}
+		return find(reader, argv[3], filter);
+	}
+
+	usage();
+	return 2;
+}
@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "columnStore.hpp"
+#include "varint.hpp"
+
+static std::vector<StoreColumn> makeResultColumns()
+{
+	std::vector<StoreColumn> columns = {{"time", 1, -1}, {"brainTime", 1, -1}, {"state", 1, -1}, {"flags", 1, -1},
+		{"averageScore", 100, -1}, {"coastTime", 1, -1}, {"breakTime", 1, -1}, {"resultCount", 1, -1}};
+	for(int i = 0; i < STORE_MAX_RESULTS; i++) columns.push_back({"settleSpeed" + std::to_string(i), 100, i});
+	for(int i = 0; i < STORE_MAX_RESULTS; i++) columns.push_back({"settleCurrent" + std::to_string(i), 1, i});
+	return columns;
+}
+
+const std::vector<StoreColumn> & storeColumns(StoreTable table)
+{
+	static const std::vector<StoreColumn> samples = {{"time", 1, -1}, {"brainTime", 1, -1}, {"state", 1, -1},
+		{"appliedVoltage", 1, -1}, {"requestedVoltage", 1, -1}, {"current", 1, -1}, {"velocity", 1, -1}};
+	static const std::vector<StoreColumn> results = makeResultColumns();
+	return table == TABLE_SAMPLES ? samples : results;
+}
+
+const char * storeTableName(StoreTable table) {return table == TABLE_SAMPLES ? "samples" : "results";}
+
+int storeColumnIndex(StoreTable table, const std::string & name)
+{
+	const std::vector<StoreColumn> & columns = storeColumns(table);
+	for(size_t i = 0; i < columns.size(); i++) if(columns[i].name == name) return i;
+	return -1;
+}
+
+static std::string tablePath(const std::string & directory, StoreTable table, const char * extension)
+{
+	return directory + "/" + storeTableName(table) + extension;
+}
+
+static std::vector<std::string> readBenches(const std::string & directory)
+{
+	std::vector<std::string> benches;
+	FILE * file = fopen((directory + "/benches.txt").c_str(), "r");
+	if(file == NULL) return benches;
+
+	char line[256];
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		line[strcspn(line, "\r\n")] = 0;
+		benches.push_back(line);
+	}
+	fclose(file);
+	return benches;
+}
+
+static uint64_t blockEnd(const StoreBlock & block)
+{
+	uint64_t end = block.offset;
+	for(int i = 0; i < block.columnCount; i++) end += block.length[i];
+	return end;
+}
+
+StoreWriter::~StoreWriter() {close();}
+
+bool StoreWriter::open(const std::string & path)
+{
+	directory = path;
+	if(mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) return false;
+
+	lockFd = ::open((directory + "/lock").c_str(), O_RDWR | O_CREAT, 0644);
+	if(lockFd < 0 || flock(lockFd, LOCK_EX | LOCK_NB) != 0)
+	{
+		fprintf(stderr, "store %s: already in use\n", directory.c_str());
+		return false;
+	}
+
+	benches = readBenches(directory);
+
+	for(int t = 0; t < TABLE_COUNT; t++)
+	{
+		StoreTable table = (StoreTable)t;
+		data[t] = fopen(tablePath(directory, table, ".dat").c_str(), "ab");
+		index[t] = fopen(tablePath(directory, table, ".idx").c_str(), "ab");
+		if(data[t] == NULL || index[t] == NULL) return false;
+
+		// Drop a partial index record, then any data no record points at
+		struct stat status;
+		fstat(fileno(index[t]), &status);
+		off_t records = status.st_size / sizeof(StoreBlock);
+		if(ftruncate(fileno(index[t]), records * sizeof(StoreBlock)) != 0) return false;
+
+		dataEnd[t] = 0;
+		if(records > 0)
+		{
+			StoreBlock last;
+			if(pread(fileno(index[t]), &last, sizeof(last), (records - 1) * sizeof(StoreBlock)) != sizeof(last)) return false;
+			dataEnd[t] = blockEnd(last);
+		}
+		fstat(fileno(data[t]), &status);
+		if((uint64_t)status.st_size < dataEnd[t])
+		{
+			fprintf(stderr, "store %s: %s data is shorter than its index\n", directory.c_str(), storeTableName(table));
+			return false;
+		}
+		if(ftruncate(fileno(data[t]), dataEnd[t]) != 0) return false;
+	}
+
+	return true;
+}
+
+void StoreWriter::close()
+{
+	flush(0);
+	for(int t = 0; t < TABLE_COUNT; t++)
+	{
+		if(data[t] != NULL) fclose(data[t]);
+		if(index[t] != NULL) fclose(index[t]);
+		data[t] = index[t] = NULL;
+	}
+	if(lockFd >= 0) ::close(lockFd);
+	lockFd = -1;
+}
+
+int StoreWriter::benchId(const std::string & name)
+{
+	for(size_t i = 0; i < benches.size(); i++) if(benches[i] == name) return i;
+
+	FILE * file = fopen((directory + "/benches.txt").c_str(), "a");
+	if(file == NULL) return -1;
+	fprintf(file, "%s\n", name.c_str());
+	fclose(file);
+
+	benches.push_back(name);
+	return benches.size() - 1;
+}
+
+void StoreWriter::append(StoreTable table, int bench, int port, const int64_t * row)
+{
+	Buffer & buffer = buffers[table][{bench, port}];
+	size_t columns = storeColumns(table).size();
+
+	if(buffer.column[0].empty()) buffer.opened = clock;
+	for(size_t i = 0; i < columns; i++) buffer.column[i].push_back(row[i]);
+
+	if(buffer.column[0].size() >= STORE_BLOCK_ROWS) writeBlock(table, bench, port, buffer);
+}
+
+void StoreWriter::flush(int64_t now, int64_t age)
+{
+	clock = now;
+	for(int t = 0; t < TABLE_COUNT; t++)
+	{
+		if(data[t] == NULL) continue;
+		for(auto & entry : buffers[t])
+		{
+			Buffer & buffer = entry.second;
+			if(!buffer.column[0].empty() && (age == 0 || now - buffer.opened >= age)) writeBlock((StoreTable)t, entry.first.first, entry.first.second, buffer);
+		}
+	}
+}
+
+void StoreWriter::writeBlock(StoreTable table, int bench, int port, Buffer & buffer)
+{
+	size_t columns = storeColumns(table).size();
+	size_t rows = buffer.column[0].size();
+
+	StoreBlock block = {};
+	block.bench = bench;
+	block.port = port;
+	block.columnCount = columns;
+	block.rows = rows;
+	block.firstTime = block.lastTime = buffer.column[0][0];
+	block.offset = dataEnd[table];
+	for(int64_t time : buffer.column[0])
+	{
+		block.firstTime = std::min(block.firstTime, time);
+		block.lastTime = std::max(block.lastTime, time);
+	}
+
+	encoded.resize(rows * 10);
+	for(size_t i = 0; i < columns; i++)
+	{
+		const std::vector<int64_t> & values = buffer.column[i];
+		size_t length = 0;
+		int64_t previous = 0;
+		for(int64_t value : values)
+		{
+			length += varintPut(&encoded[length], zigzagEncode(value - previous));
+			previous = value;
+		}
+		fwrite(encoded.data(), 1, length, data[table]);
+		block.length[i] = length;
+		buffer.column[i].clear();
+	}
+
+	// Data has to reach the file before the record that points at it
+	fflush(data[table]);
+	fwrite(&block, sizeof(block), 1, index[table]);
+	fflush(index[table]);
+
+	dataEnd[table] = blockEnd(block);
+	written += rows;
+}
+
+StoreReader::~StoreReader()
+{
+	for(int t = 0; t < TABLE_COUNT; t++) if(mapped[t] != NULL) munmap((void *)mapped[t], size[t]);
+}
+
+bool StoreReader::open(const std::string & directory)
+{
+	benches = readBenches(directory);
+
+	for(int t = 0; t < TABLE_COUNT; t++)
+	{
+		StoreTable table = (StoreTable)t;
+
+		FILE * file = fopen(tablePath(directory, table, ".idx").c_str(), "rb");
+		if(file == NULL) return false;
+		StoreBlock block;
+		while(fread(&block, sizeof(block), 1, file) == 1) index[t].push_back(block);
+		fclose(file);
+
+		int fd = ::open(tablePath(directory, table, ".dat").c_str(), O_RDONLY);
+		if(fd < 0) return false;
+		struct stat status;
+		fstat(fd, &status);
+		size[t] = status.st_size;
+		if(size[t] > 0)
+		{
+			void * pointer = mmap(NULL, size[t], PROT_READ, MAP_SHARED, fd, 0);
+			mapped[t] = pointer == MAP_FAILED ? NULL : (const uint8_t *)pointer;
+		}
+		::close(fd);
+		if(size[t] > 0 && mapped[t] == NULL) return false;
+	}
+
+	return true;
+}
+
+int StoreReader::benchId(const std::string & name) const
+{
+	for(size_t i = 0; i < benches.size(); i++) if(benches[i] == name) return i;
+	return -1;
+}
+
+static bool decodeColumn(const uint8_t * in, size_t length, size_t rows, int64_t * out)
+{
+	const uint8_t * end = in + length;
+	int64_t value = 0;
+
+	for(size_t i = 0; i < rows; i++)
+	{
+		uint64_t delta;
+		size_t used = varintGet(in, end, delta);
+		if(used == 0) return false;
+		in += used;
+		value += zigzagDecode(delta);
+		out[i] = value;
+	}
+
+	return in == end;
+}
+
+uint64_t StoreReader::scan(StoreTable table, const StoreFilter & filter, const std::vector<int> & columns,
+	const std::function<void(const StoreBlock & block, const int64_t * values)> & visit) const
+{
+	std::vector<int64_t> time;
+	std::vector<std::vector<int64_t>> decoded(columns.size());
+	std::vector<int64_t> values(columns.size());
+	uint64_t visited = 0;
+
+	for(const StoreBlock & block : index[table])
+	{
+		if(filter.bench >= 0 && block.bench != filter.bench) continue;
+		if(filter.port >= 0 && block.port != filter.port) continue;
+		if(block.lastTime < filter.from || block.firstTime > filter.to) continue;
+		if(blockEnd(block) > size[table]) continue;
+
+		uint64_t offsets[STORE_MAX_COLUMNS];
+		uint64_t offset = block.offset;
+		for(int i = 0; i < block.columnCount; i++)
+		{
+			offsets[i] = offset;
+			offset += block.length[i];
+		}
+
+		bool whole = block.firstTime >= filter.from && block.lastTime <= filter.to;
+		time.resize(block.rows);
+		if(!whole && !decodeColumn(mapped[table] + offsets[0], block.length[0], block.rows, time.data())) continue;
+
+		bool ok = true;
+		for(size_t c = 0; c < columns.size() && ok; c++)
+		{
+			decoded[c].resize(block.rows);
+			ok = columns[c] < block.columnCount && decodeColumn(mapped[table] + offsets[columns[c]], block.length[columns[c]], block.rows, decoded[c].data());
+		}
+		if(!ok) continue;
+
+		for(uint32_t row = 0; row < block.rows; row++)
+		{
+			if(!whole && (time[row] < filter.from || time[row] > filter.to)) continue;
+			for(size_t c = 0; c < columns.size(); c++) values[c] = decoded[c][row];
+			visit(block, values.data());
+			visited++;
+		}
+	}
+
+	return visited;
+}
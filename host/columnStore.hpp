@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Append-only columnar store for telemetry from several benches.
+ *
+ * Each table is a data file and an index file. Rows are buffered per
+ * (bench, port) and written as blocks; a block stores every column one after
+ * the other, each as zig-zag varint deltas from the previous row. The index
+ * holds one fixed-size record per block with its bench, port, time range and
+ * column offsets, so a query reads the index, skips blocks outside its
+ * filter and decodes only the columns it asked for.
+ *
+ * Values are integers. Fractional metrics are stored in fixed point, see
+ * StoreColumn::scale.
+ *
+ * Data is written before its index record, so a reader that sees a record
+ * always sees its block, and a writer that died half way leaves a tail that
+ * the next open() truncates.
+ */
+#define STORE_MAX_COLUMNS 24
+#define STORE_MAX_RESULTS 8
+#define STORE_BLOCK_ROWS 4096
+
+enum StoreTable
+{
+	TABLE_SAMPLES,
+	TABLE_RESULTS,
+	TABLE_COUNT
+};
+
+// Mirrors the sampled vectors in PortData
+enum SampleColumn
+{
+	SAMPLE_TIME,
+	SAMPLE_BRAIN_TIME,
+	SAMPLE_STATE,
+	SAMPLE_APPLIED_VOLTAGE,
+	SAMPLE_REQUESTED_VOLTAGE,
+	SAMPLE_CURRENT,
+	SAMPLE_VELOCITY,
+	SAMPLE_COLUMN_COUNT
+};
+
+// Mirrors the finished-test fields of PortData, one TestPointResult per test point
+enum ResultColumn
+{
+	RESULT_TIME,
+	RESULT_BRAIN_TIME,
+	RESULT_STATE,
+	RESULT_FLAGS,
+	RESULT_AVERAGE_SCORE,
+	RESULT_COAST_TIME,
+	RESULT_BREAK_TIME,
+	RESULT_COUNT,
+	RESULT_SETTLE_SPEED,
+	RESULT_SETTLE_CURRENT = RESULT_SETTLE_SPEED + STORE_MAX_RESULTS,
+	RESULT_COLUMN_COUNT = RESULT_SETTLE_CURRENT + STORE_MAX_RESULTS
+};
+
+struct StoreColumn
+{
+	std::string name;
+	int scale;
+	int testPoint; // -1 unless the column belongs to one TestPointResult
+};
+
+struct __attribute__((packed)) StoreBlock
+{
+	uint16_t bench;
+	uint8_t port;
+	uint8_t columnCount;
+	uint32_t rows;
+	int64_t firstTime;
+	int64_t lastTime;
+	uint64_t offset;
+	uint32_t length[STORE_MAX_COLUMNS];
+};
+
+struct StoreFilter
+{
+	int bench = -1;
+	int port = -1;
+	int64_t from = INT64_MIN;
+	int64_t to = INT64_MAX;
+};
+
+const std::vector<StoreColumn> & storeColumns(StoreTable table);
+const char * storeTableName(StoreTable table);
+
+/**
+ * Returns the column index for name, or -1.
+ */
+int storeColumnIndex(StoreTable table, const std::string & name);
+
+class StoreWriter
+{
+public:
+	~StoreWriter();
+
+	/**
+	 * Creates the directory if needed, takes an exclusive lock on it and
+	 * truncates anything past the last complete block.
+	 */
+	bool open(const std::string & directory);
+	void close();
+
+	int benchId(const std::string & name);
+
+	// row holds storeColumns(table).size() values and row[0] is the time
+	void append(StoreTable table, int bench, int port, const int64_t * row);
+
+	/**
+	 * Writes out every buffer that has held rows for at least age ms, so
+	 * queries see recent data without waiting for a full block. now is any
+	 * clock the caller keeps steady; buffers opened since the last call are
+	 * aged from it.
+	 */
+	void flush(int64_t now, int64_t age = 0);
+
+	uint64_t rowsWritten() const {return written;}
+
+private:
+	struct Buffer
+	{
+		std::vector<int64_t> column[STORE_MAX_COLUMNS];
+		int64_t opened = 0;
+	};
+
+	void writeBlock(StoreTable table, int bench, int port, Buffer & buffer);
+
+	std::string directory;
+	int lockFd = -1;
+	FILE * data[TABLE_COUNT] = {};
+	FILE * index[TABLE_COUNT] = {};
+	uint64_t dataEnd[TABLE_COUNT] = {};
+	std::vector<std::string> benches;
+	std::map<std::pair<int, int>, Buffer> buffers[TABLE_COUNT];
+	std::vector<uint8_t> encoded;
+	int64_t clock = 0;
+	uint64_t written = 0;
+};
+
+class StoreReader
+{
+public:
+	~StoreReader();
+
+	bool open(const std::string & directory);
+
+	const std::vector<std::string> & benchNames() const {return benches;}
+	int benchId(const std::string & name) const;
+	const std::vector<StoreBlock> & blocks(StoreTable table) const {return index[table];}
+	uint64_t dataBytes(StoreTable table) const {return size[table];}
+
+	/**
+	 * Calls visit for every row that passes filter, with the requested
+	 * columns in values (in the order given). Returns the number of rows
+	 * visited.
+	 */
+	uint64_t scan(StoreTable table, const StoreFilter & filter, const std::vector<int> & columns,
+		const std::function<void(const StoreBlock & block, const int64_t * values)> & visit) const;
+
+private:
+	std::vector<std::string> benches;
+	std::vector<StoreBlock> index[TABLE_COUNT];
+	const uint8_t * mapped[TABLE_COUNT] = {};
+	uint64_t size[TABLE_COUNT] = {};
+};
@@ -0,0 +1,87 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "engineParameters.hpp"
+#include "testEngine.hpp"
+
+struct Parameter
+{
+	std::string name;
+	double * real;
+	int * integer;
+	double initial;
+};
+
+static std::vector<Parameter> & parameters()
+{
+	static std::vector<Parameter> list;
+	if(!list.empty()) return list;
+
+	auto add = [](const std::string & name, double * real, int * integer) {list.push_back({name, real, integer, real != NULL ? *real : *integer});};
+	add("settleStartAcceleration", &settleStartAcceleration, NULL);
+	add("settledAcceleration", &settledAcceleration, NULL);
+	add("unsettledAcceleration", &unsettledAcceleration, NULL);
+	add("failScore", &failScore, NULL);
+	add("warnScore", &warnScore, NULL);
+	add("errorPercent", &errorPercent, NULL);
+	add("testingTimeout", NULL, &testingTimeout);
+	add("averageCoastTime", NULL, &averageCoastTime);
+	add("averageBreakTime", NULL, &averageBreakTime);
+	add("velocityStepTest", NULL, &velocityStepTest);
+	add("velocityStepTimeout", NULL, &velocityStepTimeout);
+	add("rampSweepTest", NULL, &rampSweepTest);
+	add("rampSweepTime", NULL, &rampSweepTime);
+	add("encoderTest", NULL, &encoderTest);
+	add("encoderWindow", NULL, &encoderWindow);
+	add("encoderMinSpeed", &encoderMinSpeed, NULL);
+	add("encoderMaxAcceleration", &encoderMaxAcceleration, NULL);
+	add("encoderReversalLimit", NULL, &encoderReversalLimit);
+	add("encoderSkipTolerance", &encoderSkipTolerance, NULL);
+	add("encoderSkipLimit", &encoderSkipLimit, NULL);
+	add("encoderJitterLimit", &encoderJitterLimit, NULL);
+	add("positionTest", NULL, &positionTest);
+	add("positionTestBudget", NULL, &positionTestBudget);
+	add("positionMoveTimeout", NULL, &positionMoveTimeout);
+	add("positionTolerance", &positionTolerance, NULL);
+	add("positionErrorAllowance", &positionErrorAllowance, NULL);
+	for(int i = 0; i < testPointCount; i++)
+	{
+		add("settleSpeed" + std::to_string(i + 1), &testPointList[i].settleSpeed, NULL);
+		add("settleCurrent" + std::to_string(i + 1), NULL, &testPointList[i].settleCurrent);
+		add("velocitySetpoint" + std::to_string(i + 1), NULL, &velocityStepList[i]);
+	}
+	return list;
+}
+
+static void set(const Parameter & parameter, double value)
+{
+	if(parameter.real != NULL) *parameter.real = value;
+	else *parameter.integer = lround(value);
+}
+
+bool parameterParse(ParameterSettings & settings, const char * text)
+{
+	const char * equals = strchr(text, '=');
+	if(equals == NULL) return false;
+
+	std::string name(text, equals - text);
+	for(size_t i = 0; i < parameters().size(); i++)
+	{
+		if(parameters()[i].name != name) continue;
+		settings.push_back({(int)i, atof(equals + 1)});
+		return true;
+	}
+	return false;
+}
+
+void parameterApply(const ParameterSettings & settings)
+{
+	for(const Parameter & parameter : parameters()) set(parameter, parameter.initial);
+	for(const auto & setting : settings) set(parameters()[setting.first], setting.second);
+}
+
+void parameterList(FILE * out)
+{
+	for(const Parameter & parameter : parameters()) fprintf(out, "  %s (%g)\n", parameter.name.c_str(), parameter.initial);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+/**
+ * Engine parameters the host tools can set by name, as NAME=VALUE on the
+ * command line: the settle thresholds, score cutoffs, timeout, reference
+ * coast and brake times, each test point's settle speed and current, the
+ * velocity steps, the ramp sweep, the encoder check and the position test.
+ */
+typedef std::vector<std::pair<int, double>> ParameterSettings;
+
+// False if text isn't NAME=VALUE for a known name
+bool parameterParse(ParameterSettings & settings, const char * text);
+
+// Puts every parameter back to its built-in value, then applies settings
+void parameterApply(const ParameterSettings & settings);
+
+// Every name with its built-in value, one per line
+void parameterList(FILE * out);
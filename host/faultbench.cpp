@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <unistd.h>
+#include "engineParameters.hpp"
+#include "simMotor.hpp"
+#include "testEngine.hpp"
+
+/**
+ * Measures how well the engine's checks catch each simulated fault.
+ *
+ *   faultbench [-n TRIALS] [-s SEED] [-x SEVERITY] [-o MAX_ONSET] [-f FAULT]
+ *              [-a NAME=VALUE]...
+ *
+ * Every trial plugs a V5Motor (simMotor.hpp), varied from the nominal one
+ * by a few percent, into port 1 and runs the engine until the test
+ * finishes or 30 virtual seconds pass. The fault comes on at a random time
+ * from plug-in up to MAX_ONSET ms (default 2000; 0 means from plug-in).
+ *
+ * Per fault, and for healthy motors as the false positive baseline, it
+ * reports how many tests failed (102), warned (101), passed or never
+ * finished; which checks flagged (to = timedOut, nr = !motorWorking,
+ * c = !currentWorking, b = !breakModeWorking, e = !encoderWorking,
+ * score = below failScore, ev = logged a motor fault or flag event);
+ * the time from onset to a failing result; and how often the port dropped
+ * back to a fresh test. For the velocity steps (velocityStepTest) it gives
+ * the share of steps that never settled, the median settling time and the
+ * 95th percentile steady-state error in rpm, and for the position test
+ * (positionTest) the moves finished per test and the median final error and
+ * repeatability in degrees. -a sets engine parameters, so a change to the
+ * checks can be measured against the same faults.
+ */
+#define TRIAL_LIMIT_MS 30000
+
+struct FaultStats
+{
+	int trials = 0;
+	int outcome[4] = {}; // fail, warn, pass, unfinished
+	int flagged[7] = {}; // to, nr, c, b, e, score, ev
+	int restarts = 0;
+	std::vector<uint32_t> detectMs;
+	std::vector<uint32_t> velocitySettleMs;
+	std::vector<double> velocityError;
+	int velocitySteps = 0;
+	int velocityUnsettled = 0;
+	std::vector<double> positionError;
+	std::vector<double> positionSpread;
+	int positionMoves = 0;
+	uint64_t lengthMs = 0;
+	int finished = 0;
+};
+
+template <class T> static T percentile(std::vector<T> & values, double fraction)
+{
+	if(values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+static void trial(int fault, double severity, uint32_t maxOnset, std::mt19937 & random, FaultStats & stats)
+{
+	auto vary = [&](double value, double spread) {return value * std::uniform_real_distribution<double>(1 - spread, 1 + spread)(random);};
+	MotorModel model;
+	model.frictionCurrent = vary(model.frictionCurrent, 0.1);
+	model.viscousCurrent = vary(model.viscousCurrent, 0.1);
+	model.dragCurrent = vary(model.dragCurrent, 0.1);
+	model.resistance = vary(model.resistance, 0.05);
+	model.backEmf = vary(model.backEmf, 0.03);
+	model.inertia = vary(model.inertia, 0.1);
+	model.brakeResistance = vary(model.brakeResistance, 0.1);
+
+	uint32_t plug = simNow();
+	uint32_t onset = plug + (maxOnset == 0 ? 0 : random() % maxOnset);
+	V5Motor motor(model, random());
+	if(fault >= 0) motor.inject((SimFault)fault, onset, severity);
+
+	{
+		EngineLock lock;
+		portData[0] = PortData();
+	}
+	simAttach(0, &motor);
+
+	int state = 0;
+	bool started = false;
+	TestRecord record;
+	bool finished = false;
+	while(simNow() - plug < TRIAL_LIMIT_MS)
+	{
+		engineTick();
+		int now = portData[0].state;
+		if(started && now < 3 && state >= 3) stats.restarts++;
+		if(now >= 3) started = true;
+		state = now;
+		if(state >= 100)
+		{
+			finished = enginePopRecord(record);
+			break;
+		}
+		simSetTime(simNow() + 1);
+	}
+
+	stats.trials++;
+	if(!finished) stats.outcome[3]++;
+	else
+	{
+		stats.outcome[record.state == 102 ? 0 : record.state == 101 ? 1 : 2]++;
+		stats.flagged[0] += record.timedOut;
+		stats.flagged[1] += !record.motorWorking;
+		stats.flagged[2] += !record.currentWorking;
+		stats.flagged[3] += !record.breakModeWorking;
+		stats.flagged[4] += !record.encoderWorking;
+		stats.flagged[5] += record.averageScore < failScore;
+		stats.flagged[6] += !portData[0].events.empty();
+		if(record.state == 102 && record.time >= onset) stats.detectMs.push_back(record.time - onset);
+		stats.lengthMs += record.time - plug;
+		stats.finished++;
+
+		EngineLock lock;
+		for(const VelocityStepResult & step : portData[0].velocityResults)
+		{
+			stats.velocitySteps++;
+			if(step.settleTime < 0) stats.velocityUnsettled++;
+			else stats.velocitySettleMs.push_back(step.settleTime);
+			stats.velocityError.push_back(fabs(step.steadyStateError));
+		}
+
+		PositionSummary position = enginePositionSummary(portData[0]);
+		stats.positionMoves += position.moves;
+		if(position.moves > 0)
+		{
+			stats.positionError.push_back(position.meanError);
+			stats.positionSpread.push_back(position.spread);
+		}
+	}
+
+	simAttach(0, NULL);
+	engineTick();
+	engineAbort();
+	engineResume();
+	simSetTime(simNow() + 1000);
+}
+
+static const char * usage = "usage: faultbench [-n TRIALS] [-s SEED] [-x SEVERITY] [-o MAX_ONSET] [-f FAULT] [-a NAME=VALUE]...\n";
+
+int main(int argc, char ** argv)
+{
+	int trials = 100;
+	uint32_t seed = 1;
+	double severity = 1;
+	uint32_t maxOnset = 2000;
+	int only = -2;
+	ParameterSettings settings;
+
+	int option;
+	while((option = getopt(argc, argv, "n:s:x:o:f:a:")) != -1)
+	{
+		switch(option)
+		{
+		case 'n': trials = atoi(optarg); break;
+		case 's': seed = atoi(optarg); break;
+		case 'x': severity = atof(optarg); break;
+		case 'o': maxOnset = atoi(optarg); break;
+		case 'f':
+			only = strcmp(optarg, "none") == 0 ? -1 : -2;
+			for(int i = 0; i < FAULT_COUNT; i++) if(strcmp(optarg, simFaultName[i]) == 0) only = i;
+			if(only == -2)
+			{
+				fprintf(stderr, "faultbench: unknown fault %s; one of: none", optarg);
+				for(int i = 0; i < FAULT_COUNT; i++) fprintf(stderr, " %s", simFaultName[i]);
+				fprintf(stderr, "\n");
+				return 2;
+			}
+			break;
+		case 'a':
+			if(!parameterParse(settings, optarg))
+			{
+				fprintf(stderr, "faultbench: unknown parameter %s; one of:\n", optarg);
+				parameterList(stderr);
+				return 2;
+			}
+			break;
+		default:
+			fputs(usage, stderr);
+			return 2;
+		}
+	}
+	parameterApply(settings);
+
+	// Keeps the engine's STARTUP line out of the report
+	firstMotorAdmitted = 0;
+	simSetTime(1000);
+
+	printf("%-15s %5s %5s %5s %5s %5s  %4s %4s %4s %4s %4s %5s %4s  %7s %6s %6s  %8s %7s  %6s %5s %5s  %5s %5s %5s\n", "fault", "n", "fail", "warn", "pass", "open",
+		"to", "nr", "c", "b", "e", "score", "ev", "mean ms", "p50", "p95", "restarts", "test ms", "v open", "v p50", "v err", "p n", "p err", "p rep");
+	for(int fault = -1; fault < FAULT_COUNT; fault++)
+	{
+		if(only != -2 && fault != only) continue;
+
+		std::mt19937 random(seed + fault * 7919);
+		FaultStats stats;
+		for(int i = 0; i < trials; i++) trial(fault, severity, maxOnset, random, stats);
+
+		double mean = 0;
+		for(uint32_t ms : stats.detectMs) mean += ms;
+		if(!stats.detectMs.empty()) mean /= stats.detectMs.size();
+
+		auto percent = [&](int count) {return count * 100.0 / stats.trials;};
+		printf("%-15s %5d %4.0f%% %4.0f%% %4.0f%% %4.0f%%  %3.0f%% %3.0f%% %3.0f%% %3.0f%% %3.0f%% %4.0f%% %3.0f%%  %7.0f %6u %6u  %8.2f %7.0f  %5.0f%% %5u %5.1f  %5.1f %5.1f %5.1f\n",
+			fault < 0 ? "none" : simFaultName[fault], stats.trials, percent(stats.outcome[0]), percent(stats.outcome[1]), percent(stats.outcome[2]),
+			percent(stats.outcome[3]), percent(stats.flagged[0]), percent(stats.flagged[1]), percent(stats.flagged[2]), percent(stats.flagged[3]),
+			percent(stats.flagged[4]), percent(stats.flagged[5]), percent(stats.flagged[6]), mean, percentile(stats.detectMs, 0.5), percentile(stats.detectMs, 0.95),
+			stats.restarts / (double)stats.trials, stats.finished == 0 ? 0 : stats.lengthMs / (double)stats.finished,
+			stats.velocitySteps == 0 ? 0 : stats.velocityUnsettled * 100.0 / stats.velocitySteps, percentile(stats.velocitySettleMs, 0.5),
+			percentile(stats.velocityError, 0.95), stats.finished == 0 ? 0 : stats.positionMoves / (double)stats.finished,
+			percentile(stats.positionError, 0.5), percentile(stats.positionSpread, 0.5));
+	}
+
+	return 0;
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "engineParameters.hpp"
+#include "simDevice.hpp"
+#include "testEngine.hpp"
+#include "traceLogReader.hpp"
+
+/**
+ * Replays recorded test traces through the test engine in virtual time.
+ *
+ *   replay [-s STEP] [-v] [-p PORT] [-a NAME=VALUE]... [-b NAME=VALUE]...
+ *          [-o OUT.csv] [-d PREVIOUS.csv] FILE
+ *
+ * Each record of a traces.bin is plugged into its port as a simulated motor
+ * that plays back the recorded voltage, current and velocity, and the engine
+ * runs the whole test with engineTick() every STEP virtual ms (default 1).
+ * The engine sets the recording's clock going when it first drives the motor,
+ * and samples exactly when the brain did, so its filters see the same data.
+ *
+ * -a sets engine parameters for the run (an unknown name lists them); with -b the archive is
+ * replayed a second time with those and every record that classifies
+ * differently is listed. -o writes the outcome per record as CSV and -d
+ * compares against one written by another build. -v prints each record's
+ * state transitions.
+ */
+#define REPLAY_LIMIT_MS 60000
+#define REPLAY_VELOCITY_TREND 8
+
+/**
+ * Plays a recorded trace back as a motor. Until the engine first drives it
+ * the motor reads as stopped; from then on recorded sample i shows up at
+ * the virtual time anchor + (its time - the first sample's time) and holds
+ * until the next one.
+ *
+ * The recorded velocity went through the engine's 0.7/0.3 filter, so the
+ * raw reading is recovered by inverting it; fed back through the filter it
+ * gives the recorded values again. A finished test's recording ends where
+ * the brain saw the motor stop, so past the end it reads as stopped.
+ */
+class ReplayMotor : public SimMotor
+{
+public:
+	ReplayMotor(const std::vector<TraceSample> & samples) : samples(samples), raw(samples.size())
+	{
+		// The engine stores the filter output truncated toward zero, so each recorded value only pins the raw
+		// reading to a range 3.3 rpm wide, and a slowly changing reading can sit anywhere in it for several
+		// samples. Carry half the recent trend forward (a full one overshoots as the motor coasts down) and keep
+		// it inside the range. Only earlier samples are used: later ones already show how the brain reacted to
+		// the reading being estimated.
+		for(size_t i = 0; i < samples.size(); i++)
+		{
+			int32_t stored = samples[i].value[TRACE_VELOCITY];
+			double previous = i == 0 ? 0 : samples[i - 1].value[TRACE_VELOCITY] * 0.7;
+			double scale = i == 0 ? 1 : 0.3;
+			double low = ((stored > 0 ? stored : stored - 1) + 1e-4 - previous) / scale;
+			double high = ((stored < 0 ? stored : stored + 1) - 1e-4 - previous) / scale;
+
+			double estimate = (low + high) / 2;
+			if(i > 0)
+			{
+				size_t span = std::min(i - 1, (size_t)REPLAY_VELOCITY_TREND);
+				estimate = raw[i - 1] + (span == 0 ? 0 : (raw[i - 1] - raw[i - 1 - span]) / span / 2);
+			}
+			raw[i] = std::min(std::max(estimate, low), high);
+		}
+	}
+
+	void command(int32_t voltage) override
+	{
+		if(anchor < 0 && voltage != 0) anchor = simNow();
+	}
+
+	void commandVelocity(int32_t velocity) override {command(velocity);}
+	void commandPosition(double position, int32_t velocity) override {command(velocity);}
+
+	double velocity() override {return anchor < 0 || pastEnd() ? 0 : raw[index()];}
+	int32_t current() override {return anchor < 0 || pastEnd() ? 0 : samples[index()].value[TRACE_CURRENT];}
+	int32_t voltage() override {return anchor < 0 || pastEnd() ? 0 : samples[index()].value[TRACE_APPLIED_VOLTAGE];}
+
+	bool anchored() const {return anchor >= 0;}
+	bool pastEnd() const {return anchor >= 0 && (long)simNow() > at(samples.size() - 1);}
+
+	// Past the end by more than the brain would have taken to see the motor stop and end the test
+	bool overran() const {return pastEnd() && (long)simNow() > 2 * at(samples.size() - 1) - at(samples.size() > 1 ? samples.size() - 2 : 0);}
+
+	// Virtual time of the first recorded sample at or after now, spaced out past the end
+	long nextSample(long now) const
+	{
+		size_t last = samples.size() - 1;
+		if(now <= at(last))
+		{
+			size_t i = cursor;
+			while(at(i) < now) i++;
+			return at(i);
+		}
+		long spacing = last > 0 ? at(last) - at(last - 1) : 4;
+		if(spacing <= 0) spacing = 1;
+		return at(last) + ((now - at(last) + spacing - 1) / spacing) * spacing;
+	}
+
+private:
+	long at(size_t i) const {return anchor + samples[i].value[TRACE_TIME] - samples[0].value[TRACE_TIME];}
+
+	size_t index()
+	{
+		while(cursor + 1 < samples.size() && at(cursor + 1) <= (long)simNow()) cursor++;
+		return cursor;
+	}
+
+	const std::vector<TraceSample> & samples;
+	std::vector<double> raw;
+	long anchor = -1;
+	size_t cursor = 0;
+};
+
+struct Outcome
+{
+	int state;
+	double score;
+	int coastTime;
+	int breakTime;
+	bool timedOut;
+	bool motorWorking;
+	bool currentWorking;
+	bool breakModeWorking;
+	bool pastEnd;
+	std::vector<std::pair<long, int>> transitions;
+};
+
+static int step = 1;
+
+static Outcome replayRecord(int port, const std::vector<TraceSample> & samples)
+{
+	Outcome outcome = {};
+	ReplayMotor motor(samples);
+	{
+		EngineLock lock;
+		portData[port] = PortData();
+	}
+	simAttach(port, &motor);
+
+	long start = simNow();
+	int state = 0;
+	while((long)simNow() - start < REPLAY_LIMIT_MS)
+	{
+		// The recording fixes when samples were taken; set the interval so the engine takes the next one right then
+		if(motor.anchored())
+		{
+			long interval = motor.nextSample(simNow()) - portData[port].lastReading - 1;
+			readingInterval = headlessReadingInterval = interval < 0 ? 0 : interval;
+		}
+
+		engineTick();
+
+		if(portData[port].state != state)
+		{
+			state = portData[port].state;
+			outcome.transitions.push_back({(long)simNow() - start, state});
+		}
+		if(state >= 100) break;
+		if(motor.overran()) outcome.pastEnd = true;
+
+		long next = simNow() + step;
+		if(motor.anchored()) next = std::min(next, motor.nextSample(simNow() + 1));
+		simSetTime(next);
+	}
+
+	TestRecord record;
+	if(enginePopRecord(record))
+	{
+		outcome.state = record.state;
+		outcome.score = record.averageScore;
+		outcome.coastTime = record.coastTime;
+		outcome.breakTime = record.breakTime;
+		outcome.timedOut = record.timedOut;
+		outcome.motorWorking = record.motorWorking;
+		outcome.currentWorking = record.currentWorking;
+		outcome.breakModeWorking = record.breakModeWorking;
+	}
+	else outcome.state = state;
+
+	// Unplug, then clear the running count the unplug leaves behind
+	simAttach(port, NULL);
+	engineTick();
+	engineAbort();
+	engineResume();
+	simSetTime(simNow() + 1000);
+	return outcome;
+}
+
+static void printTransitions(const char * label, const Outcome & outcome)
+{
+	printf("    %s:", label);
+	for(const auto & transition : outcome.transitions) printf(" %ld:%d", transition.first, transition.second);
+	printf("%s\n", outcome.pastEnd ? " (past end of recording)" : "");
+}
+
+static bool sameClass(const Outcome & a, const Outcome & b)
+{
+	return a.state == b.state && a.timedOut == b.timedOut && a.motorWorking == b.motorWorking && a.currentWorking == b.currentWorking && a.breakModeWorking == b.breakModeWorking;
+}
+
+static const char * usage = "usage: replay [-s STEP] [-v] [-p PORT] [-a NAME=VALUE]... [-b NAME=VALUE]... [-o OUT.csv] [-d PREVIOUS.csv] FILE\n";
+
+int main(int argc, char ** argv)
+{
+	ParameterSettings settingsA, settingsB;
+	bool compare = false, verbose = false;
+	int onlyPort = 0;
+	const char * outPath = NULL;
+	const char * diffPath = NULL;
+
+	int option;
+	while((option = getopt(argc, argv, "s:vp:a:b:o:d:")) != -1)
+	{
+		switch(option)
+		{
+		case 's': step = std::max(1, atoi(optarg)); break;
+		case 'v': verbose = true; break;
+		case 'p': onlyPort = atoi(optarg); break;
+		case 'a':
+		case 'b':
+			if(!parameterParse(option == 'a' ? settingsA : settingsB, optarg))
+			{
+				fprintf(stderr, "replay: unknown parameter %s; one of:\n", optarg);
+				parameterList(stderr);
+				return 2;
+			}
+			if(option == 'b') compare = true;
+			break;
+		case 'o': outPath = optarg; break;
+		case 'd': diffPath = optarg; break;
+		default:
+			fputs(usage, stderr);
+			return 2;
+		}
+	}
+	if(optind >= argc)
+	{
+		fputs(usage, stderr);
+		return 2;
+	}
+
+	FILE * file = fopen(argv[optind], "rb");
+	if(file == NULL)
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	// A previous run's CSV, by record number
+	std::map<unsigned long, std::pair<int, double>> previous;
+	if(diffPath != NULL)
+	{
+		FILE * diff = fopen(diffPath, "r");
+		if(diff == NULL)
+		{
+			perror(diffPath);
+			return 1;
+		}
+		char line[256];
+		unsigned long record;
+		int port, recorded, state;
+		double score;
+		while(fgets(line, sizeof(line), diff)) if(sscanf(line, "%lu,%d,%d,%d,%lf", &record, &port, &recorded, &state, &score) == 5) previous[record] = {state, score};
+		fclose(diff);
+	}
+
+	FILE * out = NULL;
+	if(outPath != NULL)
+	{
+		out = fopen(outPath, "w");
+		if(out == NULL)
+		{
+			perror(outPath);
+			return 1;
+		}
+		fprintf(out, "record,port,recordedState,state,score,coast,brake,to,nr,c,b,pastEnd\n");
+	}
+
+	TraceLogReader reader(file);
+	std::vector<TraceSample> samples;
+	uint64_t replayed = 0, agree = 0, pastEnd = 0, changedAB = 0, changedDiff = 0, compared = 0;
+	uint64_t recordedMs = 0;
+	double wallMs = 0;
+	std::map<std::pair<int, int>, int> confusion;
+
+	// Keeps the engine's STARTUP line out of the report
+	firstMotorAdmitted = 0;
+	simSetTime(1000);
+	while(reader.next())
+	{
+		const TraceLogHeader & header = reader.header;
+		unsigned long record = reader.records - 1;
+		if(onlyPort != 0 && header.port != onlyPort) continue;
+		if(header.port < 1 || header.port > PORT_COUNT || !reader.decode(samples) || samples.empty())
+		{
+			fprintf(stderr, "replay: skipping record %lu, its samples don't decode\n", record);
+			continue;
+		}
+
+		uint32_t virtualStart = simNow();
+		auto wallStart = std::chrono::steady_clock::now();
+		parameterApply(settingsA);
+		Outcome a = replayRecord(header.port - 1, samples);
+		Outcome b;
+		if(compare)
+		{
+			parameterApply(settingsB);
+			b = replayRecord(header.port - 1, samples);
+		}
+		wallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+		recordedMs += simNow() - virtualStart;
+
+		replayed++;
+		if(a.state == header.state) agree++;
+		else confusion[{header.state, a.state}]++;
+		if(a.pastEnd) pastEnd++;
+
+		bool show = verbose;
+		if(a.state != header.state)
+		{
+			printf("record %lu port %d: recorded %d, replayed %d score %.2f%s\n", record, header.port, header.state, a.state, a.score, a.pastEnd ? " (past end of recording)" : "");
+			show = true;
+		}
+		if(compare && !sameClass(a, b))
+		{
+			changedAB++;
+			printf("record %lu port %d: A %d score %.2f, B %d score %.2f\n", record, header.port, a.state, a.score, b.state, b.score);
+			show = true;
+		}
+		if(diffPath != NULL && previous.count(record))
+		{
+			compared++;
+			if(previous[record].first != a.state)
+			{
+				changedDiff++;
+				printf("record %lu port %d: previous run %d score %.2f, now %d score %.2f\n", record, header.port, previous[record].first, previous[record].second, a.state, a.score);
+				show = true;
+			}
+		}
+		if(show)
+		{
+			printTransitions(compare ? "A" : "transitions", a);
+			if(compare) printTransitions("B", b);
+		}
+
+		if(out != NULL) fprintf(out, "%lu,%d,%d,%d,%.2f,%d,%d,%d,%d,%d,%d,%d\n", record, header.port, header.state, a.state, a.score, a.coastTime, a.breakTime,
+			a.timedOut, !a.motorWorking, !a.currentWorking, !a.breakModeWorking, a.pastEnd);
+	}
+	fclose(file);
+	if(out != NULL) fclose(out);
+
+	if(reader.error() != NULL) fprintf(stderr, "replay: record %llu: %s\n", (unsigned long long)reader.records, reader.error());
+
+	printf("%llu records replayed, %llu agree with the recorded state (%.1f%%), %llu ran past the end of the recording\n", (unsigned long long)replayed,
+		(unsigned long long)agree, replayed == 0 ? 0 : agree * 100.0 / replayed, (unsigned long long)pastEnd);
+	for(const auto & entry : confusion) printf("  recorded %d -> replayed %d: %d\n", entry.first.first, entry.first.second, entry.second);
+	if(compare) printf("A/B: %llu records classify differently\n", (unsigned long long)changedAB);
+	if(diffPath != NULL) printf("against %s: %llu of %llu records changed state\n", diffPath, (unsigned long long)changedDiff, (unsigned long long)compared);
+	printf("%.1f s of virtual time in %.0f ms, %.0fx real time\n", recordedMs / 1000.0, wallMs, wallMs == 0 ? 0 : recordedMs / wallMs);
+
+	return reader.error() != NULL;
+}
@@ -0,0 +1,118 @@
+#include "simDevice.hpp"
+#include "pros/apix.h"
+#include "vdml/registry.h"
+#include "checkpoint.hpp"
+#include "taskMonitor.hpp"
+
+static SimMotor * motors[32] = {};
+static uint32_t now = 0;
+
+void simAttach(int port, SimMotor * motor) {motors[port] = motor;}
+SimMotor * simMotor(int port) {return motors[port];}
+
+uint32_t simNow() {return now;}
+void simSetTime(uint32_t time) {now = time;}
+
+extern "C" uint64_t vexSystemHighResTimeGet(void) {return (uint64_t)now * 1000;}
+
+// The replay never restores results or keeps task statistics
+bool checkpointLoad() {return false;}
+void taskMonitorCountSwitch() {}
+
+// Motor calls take 1-based ports
+static SimMotor * motorAt(uint8_t port)
+{
+	SimMotor * motor = port >= 1 && port <= 32 ? motors[port - 1] : NULL;
+	return motor != NULL && motor->connected() ? motor : NULL;
+}
+
+namespace pros::c
+{
+	v5_device_e_t registry_get_plugged_type(uint8_t port) {return motorAt(port + 1) != NULL ? E_DEVICE_MOTOR : E_DEVICE_NONE;}
+
+	int32_t motor_move(uint8_t port, int32_t voltage) {return motor_move_voltage(port, voltage * 12000 / 127);}
+
+	int32_t motor_move_voltage(uint8_t port, const int32_t voltage)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->command(voltage < -12000 ? -12000 : voltage > 12000 ? 12000 : voltage);
+		return 1;
+	}
+
+	int32_t motor_move_velocity(uint8_t port, const int32_t velocity)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->commandVelocity(velocity < -200 ? -200 : velocity > 200 ? 200 : velocity);
+		return 1;
+	}
+
+	int32_t motor_move_absolute(uint8_t port, const double position, const int32_t velocity)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->commandPosition(position, velocity);
+		return 1;
+	}
+
+	int32_t motor_move_relative(uint8_t port, const double position, const int32_t velocity)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->commandPosition(motor->position() + position, velocity);
+		return 1;
+	}
+
+	int32_t motor_tare_position(uint8_t port)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->tarePosition();
+		return 1;
+	}
+
+	// Positions are always in degrees
+	int32_t motor_set_encoder_units(uint8_t port, const pros::motor_encoder_units_e_t units) {return motorAt(port) == NULL ? PROS_ERR : 1;}
+
+	int32_t motor_set_brake_mode(uint8_t port, const pros::motor_brake_mode_e_t mode)
+	{
+		SimMotor * motor = motorAt(port);
+		if(motor == NULL) return PROS_ERR;
+		motor->brakeMode(mode);
+		return 1;
+	}
+
+	double motor_get_actual_velocity(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR_F : motorAt(port)->velocity();}
+	double motor_get_position(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR_F : motorAt(port)->position();}
+	// Every simulated motor has the 200 rpm cartridge
+	motor_gearset_e_t motor_get_gearing(uint8_t port) {return motorAt(port) == NULL ? E_MOTOR_GEARSET_INVALID : E_MOTOR_GEARSET_18;}
+
+	int32_t motor_get_raw_position(uint8_t port, uint32_t * const timestamp)
+	{
+		SimMotor * motor = motorAt(port);
+		int32_t count;
+		if(motor == NULL || !motor->rawPosition(count, *timestamp)) return PROS_ERR;
+		return count;
+	}
+
+	uint32_t motor_get_faults(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR : motorAt(port)->faults();}
+	uint32_t motor_get_flags(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR : motorAt(port)->flags();}
+	int32_t motor_get_current_draw(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR : motorAt(port)->current();}
+	int32_t motor_get_voltage(uint8_t port) {return motorAt(port) == NULL ? PROS_ERR : motorAt(port)->voltage();}
+
+	uint32_t millis(void) {return now;}
+	void delay(const uint32_t milliseconds) {now += milliseconds;}
+
+	void task_delay_until(uint32_t * const previous, const uint32_t delta)
+	{
+		*previous += delta;
+		if(*previous > now) now = *previous;
+	}
+
+	task_t task_create(task_fn_t function, void * const parameters, uint32_t prio, const uint16_t stack_depth, const char * const name) {return NULL;}
+
+	mutex_t mutex_create(void) {return (mutex_t)1;}
+	bool mutex_take(mutex_t mutex, uint32_t timeout) {return true;}
+	bool mutex_give(mutex_t mutex) {return true;}
+}
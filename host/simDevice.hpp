@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include "pros/motors.h"
+
+/**
+ * Simulated V5 devices for running the test engine on the host.
+ *
+ * simDevice.cpp defines the PROS calls the engine makes (motors, the device
+ * registry, millis/delay, mutexes) against a virtual clock and one SimMotor
+ * per port. Nothing runs by itself: the caller advances the clock and calls
+ * engineTick(), so a run is deterministic and goes as fast as the host can
+ * step it. Mutexes are no-ops since there is only one thread.
+ */
+class SimMotor
+{
+public:
+	virtual ~SimMotor() {}
+
+	// Every motor_move and motor_move_voltage, in mV
+	virtual void command(int32_t voltage) = 0;
+	// Every motor_move_velocity, in rpm
+	virtual void commandVelocity(int32_t velocity) = 0;
+	// Every motor_move_absolute, and motor_move_relative from position(), in degrees
+	virtual void commandPosition(double position, int32_t velocity) = 0;
+	virtual void tarePosition() {}
+	virtual void brakeMode(pros::motor_brake_mode_e_t mode) {}
+
+	virtual double velocity() = 0;
+	virtual double position() {return 0;}
+	// Raw encoder counts and the time they were read, for motor_get_raw_position; false without an encoder
+	virtual bool rawPosition(int32_t & count, uint32_t & timestamp) {return false;}
+	virtual int32_t current() = 0;
+	virtual int32_t voltage() = 0;
+	// motor_get_faults and motor_get_flags bits
+	virtual uint32_t faults() {return 0;}
+	virtual uint32_t flags() {return 0;}
+
+	// A disconnected motor reads as an empty port
+	virtual bool connected() {return true;}
+};
+
+// port is 0-based, as in portData. A NULL motor unplugs the port.
+void simAttach(int port, SimMotor * motor);
+SimMotor * simMotor(int port);
+
+uint32_t simNow();
+void simSetTime(uint32_t now);
@@ -0,0 +1,157 @@
+#include <cmath>
+#include "simMotor.hpp"
+
+const char * const simFaultName[FAULT_COUNT] = {"friction", "broken-tooth", "current-sensor", "encoder", "brake", "disconnect", "thermal", "encoder-glitch"};
+
+void V5Motor::inject(SimFault fault, uint32_t onset, double severity)
+{
+	faultOn[fault] = true;
+	faultOnset[fault] = onset;
+	faultSeverity[fault] = severity;
+}
+
+bool V5Motor::disconnectedAt(uint32_t time) const
+{
+	if(!faultOn[FAULT_DISCONNECT] || time < faultOnset[FAULT_DISCONNECT]) return false;
+	uint32_t period = 2000 / fmax(faultSeverity[FAULT_DISCONNECT], 0.01);
+	return (time - faultOnset[FAULT_DISCONNECT]) % period < 50;
+}
+
+double V5Motor::outputVoltage() const
+{
+	double voltage = commanded;
+	if(active(FAULT_THERMAL)) voltage *= fmax(0, 1 - faultSeverity[FAULT_THERMAL] / 2);
+	return voltage;
+}
+
+void V5Motor::advance()
+{
+	for(; last < now(); last++)
+	{
+		// A motor that drops off the bus stops driving until it is commanded again
+		if(disconnectedAt(last))
+		{
+			commanded = 0;
+			velocityMode = positionMode = false;
+			braking = false;
+		}
+
+		double direction = speed > 0 ? 1 : speed < 0 ? -1 : 0;
+		if(commanded != 0 || velocityMode) drive = (outputVoltage() - model.backEmf * speed) / model.resistance;
+		else if(braking && !(faultOn[FAULT_BRAKE] && last >= faultOnset[FAULT_BRAKE])) drive = -model.backEmf * speed / model.brakeResistance;
+		else drive = 0;
+
+		double load = model.frictionCurrent + model.viscousCurrent * fabs(speed) + model.dragCurrent * speed * speed;
+		if(faultOn[FAULT_FRICTION] && last >= faultOnset[FAULT_FRICTION]) load += 40 * faultSeverity[FAULT_FRICTION];
+		if(faultOn[FAULT_BROKEN_TOOTH] && last >= faultOnset[FAULT_BROKEN_TOOTH] && fmod(fabs(angle), 360) < 20) load += 300 * faultSeverity[FAULT_BROKEN_TOOTH];
+
+		// Friction holds a stopped rotor until the drive overcomes it, and never reverses one
+		if(direction == 0 && fabs(drive) > load) direction = drive > 0 ? 1 : -1;
+		if(direction != 0)
+		{
+			double next = speed + (drive - direction * load) / model.inertia;
+			speed = next * direction < 0 ? 0 : next;
+			angle += speed * 360 / 60000;
+		}
+
+		if(last % 10 == 0)
+		{
+			reportedVelocity = speed + noise(random) * model.velocityNoise;
+			reportedCurrent = fabs(drive) + noise(random) * model.currentNoise;
+			if(!active(FAULT_ENCODER)) reportedPosition = angle - positionOffset;
+			if(faultOn[FAULT_ENCODER_GLITCH] && last >= faultOnset[FAULT_ENCODER_GLITCH] && (last - faultOnset[FAULT_ENCODER_GLITCH]) % 100 < 10)
+				glitchCount -= lround(20 * faultSeverity[FAULT_ENCODER_GLITCH]);
+			if(!active(FAULT_ENCODER)) reportedCount = lround(angle * 900 / 360) + glitchCount;
+			reportedAt = last;
+
+			if(positionMode) targetVelocity = fmax(-moveVelocity, fmin(moveVelocity, model.positionGain * (targetPosition - reportedPosition)));
+			if(velocityMode)
+			{
+				double measured = active(FAULT_ENCODER) ? 0 : reportedVelocity;
+				double error = targetVelocity - measured;
+				velocityErrorSum += error;
+				double output = model.backEmf * targetVelocity + model.velocityGain * error + model.velocityIntegral * velocityErrorSum;
+				commanded = fmax(-12000, fmin(12000, output));
+			}
+		}
+	}
+}
+
+void V5Motor::command(int32_t voltage)
+{
+	advance();
+	commanded = voltage;
+	velocityMode = positionMode = false;
+}
+
+void V5Motor::commandVelocity(int32_t velocity)
+{
+	advance();
+	if(!velocityMode) velocityErrorSum = 0;
+	velocityMode = true;
+	positionMode = false;
+	targetVelocity = velocity;
+}
+
+void V5Motor::commandPosition(double position, int32_t velocity)
+{
+	advance();
+	if(!velocityMode) velocityErrorSum = 0;
+	velocityMode = positionMode = true;
+	targetPosition = position;
+	moveVelocity = abs(velocity);
+}
+
+void V5Motor::tarePosition()
+{
+	advance();
+	positionOffset += reportedPosition;
+	targetPosition -= reportedPosition;
+	reportedPosition = 0;
+}
+
+void V5Motor::brakeMode(pros::motor_brake_mode_e_t mode)
+{
+	advance();
+	braking = mode != pros::E_MOTOR_BRAKE_COAST;
+}
+
+double V5Motor::velocity()
+{
+	advance();
+	return active(FAULT_ENCODER) ? 0 : reportedVelocity;
+}
+
+double V5Motor::position()
+{
+	advance();
+	return reportedPosition;
+}
+
+bool V5Motor::rawPosition(int32_t & count, uint32_t & timestamp)
+{
+	advance();
+	count = reportedCount;
+	timestamp = reportedAt;
+	return true;
+}
+
+int32_t V5Motor::current()
+{
+	advance();
+	return active(FAULT_CURRENT_SENSOR) ? 0 : (int32_t)fmax(0, reportedCurrent);
+}
+
+int32_t V5Motor::voltage()
+{
+	advance();
+	return outputVoltage();
+}
+
+uint32_t V5Motor::faults()
+{
+	advance();
+	return active(FAULT_THERMAL) ? pros::E_MOTOR_FAULT_MOTOR_OVER_TEMP : 0;
+}
+
+bool V5Motor::connected() {return !disconnectedAt(now());}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include "simDevice.hpp"
+
+/**
+ * A simulated V5 motor (200 rpm cartridge, no load) with faults that can be
+ * switched on at a set virtual time.
+ *
+ * The model is a DC motor: the driver's current is (voltage - back EMF) /
+ * winding resistance and the rotor speeds up with that current less
+ * friction (a constant, a viscous and a drag term) and any fault load.
+ * Coasting opens the driver; braking shorts the windings through
+ * brakeResistance. The defaults put a healthy motor on the engine's
+ * reference test points (117/237 rpm at 6/12 V drawing 70/160 mA) and stop
+ * it from full speed in about 860 ms coasting and 200 ms braking. Like the
+ * real motor it reports velocity and current every 10 ms, with noise.
+ * motor_move_velocity runs a PI loop on the reported velocity at the same
+ * rate, feeding forward the back EMF of the setpoint, so a bad encoder
+ * throws it off as it would the real one. Position moves set that loop's
+ * setpoint in proportion to the reported position error, up to the move's
+ * velocity. Raw counts are 900 a turn, reported with the velocity. A
+ * thermal fault sets the over-temperature fault bit while it throttles.
+ */
+struct MotorModel
+{
+	double backEmf = 48;            // mV per rpm
+	double resistance = 3.9;        // mV per mA
+	double brakeResistance = 15;    // mV per mA
+	double frictionCurrent = 40;    // mA
+	double viscousCurrent = 0.0127; // mA per rpm
+	double dragCurrent = 0.00208;   // mA per rpm squared
+	double inertia = 250;           // mA ms per rpm
+	double velocityNoise = 0.5;     // rpm, standard deviation
+	double currentNoise = 2;        // mA, standard deviation
+	double velocityGain = 40;       // mV per rpm of error
+	double velocityIntegral = 20;   // mV per rpm of error, per update
+	double positionGain = 5;        // rpm per degree of error
+};
+
+/**
+ * Severity 1 is a clear fault; the benchmark scales it to find where each
+ * check stops seeing it.
+ */
+enum SimFault
+{
+	FAULT_FRICTION,       // Extra friction, 40 mA of load
+	FAULT_BROKEN_TOOTH,   // 300 mA of load for 20 degrees of every turn
+	FAULT_CURRENT_SENSOR, // Current reads 0
+	FAULT_ENCODER,        // Velocity stops counting and reads 0
+	FAULT_BRAKE,          // Brake mode coasts
+	FAULT_DISCONNECT,     // Drops off the bus for 50 ms every 2 s, stopping the motor
+	FAULT_THERMAL,        // Output throttled to half
+	FAULT_ENCODER_GLITCH, // Raw counts jump back 20 every 100 ms; the velocity still reads right
+	FAULT_COUNT
+};
+
+extern const char * const simFaultName[FAULT_COUNT];
+
+class V5Motor : public SimMotor
+{
+public:
+	V5Motor(const MotorModel & model, uint32_t seed) : model(model), random(seed), last(simNow()) {}
+
+	// From onset (virtual ms) on; injecting a fault again replaces it
+	void inject(SimFault fault, uint32_t onset, double severity = 1);
+
+	void command(int32_t voltage) override;
+	void commandVelocity(int32_t velocity) override;
+	void commandPosition(double position, int32_t velocity) override;
+	void tarePosition() override;
+	void brakeMode(pros::motor_brake_mode_e_t mode) override;
+
+	double velocity() override;
+	double position() override;
+	bool rawPosition(int32_t & count, uint32_t & timestamp) override;
+	int32_t current() override;
+	int32_t voltage() override;
+	uint32_t faults() override;
+	bool connected() override;
+
+private:
+	bool active(SimFault fault) const {return faultOn[fault] && now() >= faultOnset[fault];}
+	uint32_t now() const {return simNow();}
+	bool disconnectedAt(uint32_t time) const;
+	double outputVoltage() const;
+	void advance();
+
+	MotorModel model;
+	std::mt19937 random;
+	std::normal_distribution<double> noise;
+
+	bool faultOn[FAULT_COUNT] = {};
+	uint32_t faultOnset[FAULT_COUNT] = {};
+	double faultSeverity[FAULT_COUNT] = {};
+
+	int32_t commanded = 0;
+	bool velocityMode = false;
+	double targetVelocity = 0;
+	double velocityErrorSum = 0;
+	bool positionMode = false;
+	double targetPosition = 0;
+	double moveVelocity = 0;
+	double positionOffset = 0;
+	bool braking = false;
+	double speed = 0;   // rpm
+	double angle = 0;   // degrees
+	double drive = 0;   // mA
+	uint32_t last;
+	double reportedVelocity = 0;
+	double reportedCurrent = 0;
+	double reportedPosition = 0;
+	int32_t reportedCount = 0;
+	int32_t glitchCount = 0;
+	uint32_t reportedAt = 0;
+};
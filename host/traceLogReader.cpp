@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "lzBlock.hpp"
+#include "traceLogReader.hpp"
+
+static void appendPayload(void * context, const uint8_t * data, size_t length)
+{
+	std::vector<uint8_t> & payload = *(std::vector<uint8_t> *)context;
+	payload.insert(payload.end(), data, data + length);
+}
+
+bool TraceLogReader::next()
+{
+	if(fread(&header, sizeof(header), 1, file) != 1) return false;
+	if(header.magic != TRACE_LOG_MAGIC || header.keyframeInterval != TRACE_KEYFRAME_INTERVAL)
+	{
+		failure = "bad record header";
+		return false;
+	}
+
+	keyframes.resize(traceKeyframeCount(header.samples));
+	size_t keyframeBytes = keyframes.size() * sizeof(uint32_t);
+	payload.clear();
+
+	// Read the payload in chunks; compressed payloads go through the streaming decoder
+	auto start = std::chrono::steady_clock::now();
+	LzStreamDecoder lz(appendPayload, &payload);
+	bool compressed = header.flags & TRACE_LOG_LZ;
+	bool ok = true;
+	uint8_t chunk[4096];
+	for(size_t left = header.storedBytes; left > 0 && ok;)
+	{
+		size_t length = fread(chunk, 1, std::min(left, sizeof(chunk)), file);
+		if(length == 0) break;
+		left -= length;
+		if(compressed) ok = lz.feed(chunk, length);
+		else appendPayload(&payload, chunk, length);
+	}
+	if(compressed) decompressNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	if(!ok || (compressed && !lz.idle()) || payload.size() != keyframeBytes + header.bytes)
+	{
+		failure = "record is cut short or corrupt";
+		return false;
+	}
+	memcpy(keyframes.data(), payload.data(), keyframeBytes);
+	data.assign(payload.begin() + keyframeBytes, payload.end());
+
+	records++;
+	storedBytes += sizeof(header) + header.storedBytes;
+	payloadBytes += payload.size();
+	if(compressed) compressedPayload += payload.size();
+	return true;
+}
+
+bool TraceLogReader::decode(std::vector<TraceSample> & samples) const
+{
+	samples.resize(header.samples);
+	TraceDecoder decoder(data.data(), data.size());
+	size_t count = 0;
+	while(count < samples.size() && decoder.next(samples[count])) count++;
+	samples.resize(count);
+	return count == header.samples;
+}
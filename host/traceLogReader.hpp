@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "traceCodec.hpp"
+
+/**
+ * Reads the records of a traces.bin copied off the brain's SD card, one at a
+ * time. Compressed payloads are decompressed as they are read, one block at
+ * a time.
+ */
+class TraceLogReader
+{
+public:
+	TraceLogReader(FILE * file) : file(file) {}
+
+	/**
+	 * Reads the next record into header, keyframes and data. Returns false at
+	 * the end of the file or on a bad record, which error() then describes.
+	 */
+	bool next();
+
+	// Decodes the current record's samples; false if it held fewer than header.samples
+	bool decode(std::vector<TraceSample> & samples) const;
+
+	const char * error() const {return failure;}
+
+	TraceLogHeader header;
+	std::vector<uint32_t> keyframes;
+	std::vector<uint8_t> data;
+
+	// Totals over every record read
+	uint64_t records = 0;
+	uint64_t storedBytes = 0;
+	uint64_t payloadBytes = 0;
+	uint64_t compressedPayload = 0;
+	double decompressNs = 0;
+
+private:
+	FILE * file;
+	const char * failure = NULL;
+	std::vector<uint8_t> payload;
+};
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "traceLogReader.hpp"
+
+/**
+ * Reads a traces.bin copied off the brain's SD card.
+ *
+ *   tracedump [-c] [-p PORT] FILE
+ *
+ * Without -c it lists each record and its size against the raw 20-byte row,
+ * then the host decode and encode cost per sample and the LZ ratio and
+ * decompress rate. -c prints the samples as CSV instead. Compressed records
+ * are decompressed as they are read, one block at a time.
+ */
+static double elapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char ** argv)
+{
+	bool csv = false;
+	int onlyPort = 0;
+
+	int option;
+	while((option = getopt(argc, argv, "cp:")) != -1)
+	{
+		switch(option)
+		{
+		case 'c': csv = true; break;
+		case 'p': onlyPort = atoi(optarg); break;
+		default:
+			fprintf(stderr, "usage: tracedump [-c] [-p PORT] FILE\n");
+			return 2;
+		}
+	}
+	if(optind >= argc)
+	{
+		fprintf(stderr, "usage: tracedump [-c] [-p PORT] FILE\n");
+		return 2;
+	}
+
+	FILE * file = fopen(argv[optind], "rb");
+	if(file == NULL)
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	if(csv) printf("record,port,state,time,appliedVoltage,requestedVoltage,current,velocity\n");
+
+	uint64_t samples = 0, encodedBytes = 0;
+	double decodeNs = 0, encodeNs = 0;
+	TraceLogReader reader(file);
+	std::vector<TraceSample> decoded;
+
+	while(reader.next())
+	{
+		const TraceLogHeader & header = reader.header;
+		unsigned long long record = reader.records - 1;
+		if(onlyPort != 0 && header.port != onlyPort) continue;
+
+		auto start = std::chrono::steady_clock::now();
+		if(!reader.decode(decoded)) fprintf(stderr, "tracedump: record %llu decoded %zu of %lu samples\n", record, decoded.size(), (unsigned long)header.samples);
+		decodeNs += elapsedNs(start);
+		size_t count = decoded.size();
+
+		start = std::chrono::steady_clock::now();
+		TraceEncoder encoder;
+		uint8_t scratch[TRACE_MAX_SAMPLE_BYTES];
+		size_t reencoded = 0;
+		for(size_t i = 0; i < count; i++) reencoded += encoder.encode(decoded[i], scratch);
+		encodeNs += elapsedNs(start);
+		if(reencoded != header.bytes) fprintf(stderr, "tracedump: record %llu re-encodes to %zu bytes, not %lu\n", record, reencoded, (unsigned long)header.bytes);
+
+		samples += count;
+		encodedBytes += header.bytes + reader.keyframes.size() * sizeof(uint32_t);
+
+		if(csv)
+		{
+			for(size_t i = 0; i < count; i++)
+			{
+				const int32_t * value = decoded[i].value;
+				printf("%llu,%d,%d,%ld,%ld,%ld,%ld,%ld\n", record, header.port, header.state, (long)value[TRACE_TIME],
+					(long)value[TRACE_APPLIED_VOLTAGE], (long)value[TRACE_REQUESTED_VOLTAGE], (long)value[TRACE_CURRENT], (long)value[TRACE_VELOCITY]);
+			}
+		}
+		else printf("%6llu  %10lu ms  port %-2d state %-3d %6lu samples %7lu B  %.1fx\n", record, (unsigned long)header.time, header.port,
+			header.state, (unsigned long)header.samples, (unsigned long)header.bytes, header.bytes ? header.samples * 20.0 / header.bytes : 0);
+	}
+	if(reader.error() != NULL)
+	{
+		fprintf(stderr, "tracedump: record %llu: %s\n", (unsigned long long)reader.records, reader.error());
+		return 1;
+	}
+	fclose(file);
+
+	if(!csv && samples > 0)
+	{
+		printf("%llu records, %llu samples, %.2f B/sample, %.1fx smaller than 20 B rows; host decode %.1f ns/sample, encode %.1f ns/sample\n",
+			(unsigned long long)reader.records, (unsigned long long)samples, encodedBytes / (double)samples, samples * 20.0 / encodedBytes, decodeNs / samples, encodeNs / samples);
+		printf("on card %llu B: LZ %.2fx over the encoded payload, %.1fx over 20 B rows; host decompress %.0f MB/s\n", (unsigned long long)reader.storedBytes,
+			reader.payloadBytes / (double)(reader.storedBytes - reader.records * sizeof(TraceLogHeader)), samples * 20.0 / reader.storedBytes,
+			reader.decompressNs == 0 ? 0 : reader.compressedPayload * 1000.0 / reader.decompressNs);
+	}
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define ADI_PORT_COUNT 8
+
+/**
+ * Works out what is plugged into each 3-wire port and then tests it with
+ * the matching pros/adi.h API.
+ *
+ * A scan reads all eight ports as analog inputs every millisecond for
+ * adiProbeWindow ms, so encoders have to be turned and switches pressed
+ * while it runs. Ports are then classified from what the scan saw:
+ * - A pair of ports (A/B, C/D, E/F or G/H) whose edges alternate between
+ *   the two ports is a quadrature encoder.
+ * - A single port that only sits at the rails and toggles is a switch.
+ * - An odd port held low is tried as an ultrasonic echo line. It is kept as
+ *   one only if the sensor answers within adiProbeConfirmTime.
+ * - Anything that settles between the rails is analog.
+ * - A port that sits high and never moves is shown as empty. An untouched
+ *   switch looks the same.
+ *
+ * Each port then runs its own test until the next scan:
+ * - Encoders report their count, count rate and jitter. Jitter is a
+ *   reversal undone within adiProbeJitterTime, the sign of a channel that
+ *   drops out. The scan's illegal transitions are also kept: both channels
+ *   changed between two reads, so an edge was missed.
+ * - Switches report edges and bounces.
+ * - Ultrasonics report their echo time, update interval and missed echoes.
+ * - Analog ports report their range and noise.
+ *
+ * The probe runs in its own task while started. Stopping it shuts down the
+ * encoders and ultrasonics and puts every port back to analog input.
+ */
+extern uint32_t adiProbeWindow;
+extern uint32_t adiProbeConfirmTime;
+extern uint32_t adiProbeJitterTime;
+
+enum AdiDeviceType
+{
+	ADI_DEVICE_EMPTY,
+	ADI_DEVICE_ANALOG,
+	ADI_DEVICE_SWITCH,
+	ADI_DEVICE_ENCODER,   // Top port of the pair; the bottom port is ADI_DEVICE_PAIRED
+	ADI_DEVICE_ULTRASONIC, // Echo port of the pair; the ping port is ADI_DEVICE_PAIRED
+	ADI_DEVICE_PAIRED
+};
+
+enum AdiProbePhase
+{
+	ADI_PROBE_STOPPED,
+	ADI_PROBE_SCANNING,
+	ADI_PROBE_CONFIRMING,
+	ADI_PROBE_TESTING
+};
+
+struct AdiPortTest
+{
+	AdiDeviceType type;
+
+	// Analog: the range and standard deviation since the scan
+	int32_t low, high;
+	double mean, noise;
+
+	// Switch: level changes, and changes within 10 ms of the last one
+	uint32_t edges, bounces;
+
+	// Encoder
+	int32_t count;
+	double rate, peakRate; // Ticks per second
+	uint32_t jitter, illegalTransitions;
+
+	// Ultrasonic; distance in mm, echoUs follows from it at 5.8 us per mm
+	int32_t distance;
+	uint32_t echoUs, updateMs, maxUpdateMs, missedEchoes;
+};
+
+struct AdiProbeStatus
+{
+	AdiProbePhase phase;
+	uint32_t phaseStart;
+	uint32_t samples;
+	AdiPortTest port[ADI_PORT_COUNT];
+};
+
+// Starts a scan, creating the task on first use; a running probe rescans
+void adiProbeStart();
+void adiProbeStop();
+
+AdiProbeStatus adiProbeStatus();
+std::string adiProbeReport();
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define ADI_SCOPE_CHANNELS 8
+#define ADI_SCOPE_DEPTH 2000
+
+/**
+ * A sampler for the eight 3-wire ports that runs as its own task, separate
+ * from the UI loop's once-per-frame reads.
+ *
+ * It reads the selected channels every adiScopePeriod ms, on a fixed
+ * task_delay_until() period. The samples go into static rings of
+ * ADI_SCOPE_DEPTH samples per channel, so sampling never allocates. A
+ * trigger watches one channel. Once armed, it needs preTrigger samples of
+ * history first, then fires on the first sample that meets its condition.
+ * After that it keeps sampling until the ring holds the history and the rest
+ * of the window, and freezes the capture for display.
+ */
+extern uint32_t adiScopePeriod;
+
+enum AdiTriggerMode
+{
+	ADI_TRIGGER_FREE,    // Never triggers; the ring always shows the latest window
+	ADI_TRIGGER_RISING,  // Crosses level going up
+	ADI_TRIGGER_FALLING, // Crosses level going down
+	ADI_TRIGGER_ABOVE,   // Any sample above level
+	ADI_TRIGGER_BELOW,   // Any sample below level
+	ADI_TRIGGER_MODE_COUNT
+};
+
+enum AdiScopeState
+{
+	ADI_SCOPE_STOPPED,
+	ADI_SCOPE_RUNNING,
+	ADI_SCOPE_ARMED,
+	ADI_SCOPE_TRIGGERED,
+	ADI_SCOPE_CAPTURED
+};
+
+struct AdiTrigger
+{
+	AdiTriggerMode mode;
+	int channel;
+	int level;
+	int preTrigger;
+};
+
+struct AdiScopeStatus
+{
+	AdiScopeState state;
+	uint8_t channels;
+	uint32_t samples;
+	// Ring position of the trigger sample, counted from the oldest sample shown
+	int triggerIndex;
+	uint32_t triggerTime;
+	uint32_t maxGapUs;
+	double rate;
+};
+
+/**
+ * Starts sampling the channels in mask (bit 0 is port A), creating the task
+ * on first use. Changing the mask clears the rings. Stopping leaves the last
+ * capture readable.
+ */
+void adiScopeStart(uint8_t mask);
+void adiScopeStop();
+
+/**
+ * Arms trigger, or returns to free running with ADI_TRIGGER_FREE. Either
+ * way the rings start filling again.
+ */
+void adiScopeArm(const AdiTrigger & trigger);
+
+AdiScopeStatus adiScopeStatus();
+
+/**
+ * Min/max decimation of one channel's ring into columns bins, oldest first,
+ * for drawing one bin per pixel column. A bin with no samples yet gets -1 in
+ * both. The lock is held for one pass over the ring.
+ */
+void adiScopeDecimate(int channel, int columns, int16_t * low, int16_t * high);
+
+std::string adiScopeReport();
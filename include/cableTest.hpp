@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define CABLE_MAX_PAIRS 10
+#define CABLE_BAUD_STEPS 4
+#define CABLE_STREAM_BYTES 8192
+#define CABLE_PINGS 16
+
+/**
+ * Certifies smart cables wired as loopbacks between two empty ports.
+ *
+ * The ports run in generic serial mode through the SDK's
+ * vexDeviceGenericSerial* calls. Those are what pros/serial.h's serial_*
+ * functions wrap, and the wrappers are not in this libpros.
+ *
+ * Discovery enables every empty port at the lowest rate. Each port in turn
+ * sends its own number, and the port that hears it is its partner. Only the
+ * pairs stay in serial mode for the run, and every port goes back to the
+ * device registry when it finishes or is stopped. Every pair found then runs
+ * the same steps, all pairs at once. At each rate in cableBaudRates, one end
+ * streams CABLE_STREAM_BYTES of xorshift data. The other end compares it bit
+ * for bit as it arrives, which gives the throughput, the bit errors and any
+ * bytes that never arrive. After the stream, CABLE_PINGS single bytes go out
+ * and are echoed back one pair at a time for the round-trip time. The task
+ * sleeps between polls while it waits, so the times are to about a
+ * millisecond. The smart port is half duplex, so only one end of a cable
+ * ever sends at a time.
+ *
+ * A pair passes a rate with no bit errors and nothing lost. A cable is
+ * rated at the highest rate where it and every lower rate pass.
+ */
+extern const int32_t cableBaudRates[CABLE_BAUD_STEPS];
+
+enum CableTestPhase
+{
+	CABLE_IDLE,
+	CABLE_DISCOVERING,
+	CABLE_STREAMING,
+	CABLE_PINGING,
+	CABLE_DONE
+};
+
+struct CableStep
+{
+	int32_t baud;
+	uint32_t sent;
+	uint32_t received;
+	uint32_t bitErrors;
+	uint32_t elapsedUs;
+	double bytesPerSecond;
+	uint32_t pings;
+	uint32_t rttUs;    // Median
+	uint32_t maxRttUs;
+};
+
+struct CablePair
+{
+	uint8_t from, to; // 0-based ports
+	int steps;
+	CableStep step[CABLE_BAUD_STEPS];
+};
+
+struct CableTestStatus
+{
+	CableTestPhase phase;
+	int step;
+	uint32_t phaseStart;
+	int pairCount;
+	CablePair pair[CABLE_MAX_PAIRS];
+};
+
+// Starts a run, creating the task on first use; ignored while one is running
+void cableTestStart();
+// Ends a run early, keeping what it measured
+void cableTestStop();
+CableTestStatus cableTestStatus();
+
+// Highest rate a pair passed at, or 0 if it failed the first
+int32_t cableRating(const CablePair & pair);
+
+std::string cableTestReport();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Checkpoints finished test results to the SD card so a session survives a
+ * brownout or program restart.
+ *
+ * The newlib port in PROS has no rename(), so atomic replacement is done with
+ * two slot files written alternately. Each carries a sequence number and a
+ * CRC-32; loading picks the newest slot that validates, so a write cut off
+ * half way leaves the previous checkpoint in place.
+ *
+ * Only finished ports (state 100-102) and the result sums are stored. A port
+ * that was mid-test restarts from scratch; a restored port is reset by the
+ * engine as usual if no motor is found on it.
+ */
+#define CHECKPOINT_MAX_RESULTS 8
+
+struct CheckpointStats
+{
+	uint32_t sequence;
+	uint32_t bytes;
+	uint32_t saves;
+	uint32_t lastUs;
+	uint32_t maxUs;
+	uint32_t restoredPorts;
+};
+
+/**
+ * Restores portData and the result sums from the newest valid slot. Must run
+ * before the engine task starts. Returns false if there was nothing to load.
+ */
+bool checkpointLoad();
+
+/**
+ * Snapshots the finished results under EngineLock and, if they changed since
+ * the last save, writes them to the next slot outside the lock. Runs at most
+ * once per interval. Returns true when a slot was written.
+ */
+bool checkpointSave(uint32_t now, uint32_t interval = 10000);
+
+const CheckpointStats & checkpointStats();
+std::string checkpointReport();
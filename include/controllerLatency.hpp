@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define CONTROLLER_COUNT 2
+#define CONTROLLER_INTERVAL_BINS 100 // 1 ms each; the last bin holds everything longer
+#define CONTROLLER_RTT_BINS 50       // 20 ms each; the last bin holds everything longer
+#define CONTROLLER_RTT_BIN_MS 20
+
+/**
+ * Measures how fast controller input reaches the brain.
+ *
+ * A task reads every button and stick of both controllers each millisecond
+ * and timestamps each change. Input only changes when a packet arrives, so
+ * moving the sticks continuously makes the gaps between changes show the
+ * packet period. The most common gap is taken as the period, and the spread
+ * of gaps within half a period of it is the jitter. Gaps near a multiple of
+ * the period are packets that carried no change. Polling once a millisecond
+ * limits the resolution to 1 ms.
+ *
+ * The feedback path is timed with the operator in the loop. Every few
+ * seconds the controller shows "Press A" and rumbles, and the time until A
+ * arrives back is the round trip. It includes the operator's reaction time,
+ * so it is an upper bound to compare controllers and radios by, not a link
+ * latency. The time controller_print() and controller_rumble() block, and
+ * how often the controller refuses them, are kept alongside.
+ */
+struct ControllerLatency
+{
+	bool connected;
+	uint32_t changes;
+	uint32_t interval[CONTROLLER_INTERVAL_BINS];
+	uint32_t intervalCount;
+	double periodMs;
+	double rate;
+	double jitterMs;
+	uint32_t rtt[CONTROLLER_RTT_BINS];
+	uint32_t rttCount;
+	uint32_t lastRttMs;
+	uint32_t callUs;
+	uint32_t maxCallUs;
+	uint32_t rejected;
+};
+
+// Measures while started; the task is created on first use
+void controllerLatencyStart();
+void controllerLatencyStop();
+void controllerLatencyReset();
+
+ControllerLatency controllerLatencyGet(int controller);
+
+/**
+ * The value below which fraction of a histogram's samples fall, in units of
+ * binWidth.
+ */
+double controllerHistogramPercentile(const uint32_t * bins, int count, double binWidth, double fraction);
+
+/**
+ * The most common gap in a histogram of 1 ms bins whose last bin holds the
+ * overflow, refined to the mean of the gaps within half a period of it, and
+ * their spread. Leaves periodMs and jitterMs alone when the histogram is empty.
+ */
+void controllerHistogramPeriod(const uint32_t * bins, int count, double & periodMs, double & jitterMs);
+
+std::string controllerLatencyReport();
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * LZ4-style block compression for SD log segments, shared by the brain and
+ * the host tools (no PROS dependencies, no allocation).
+ *
+ * A segment is cut into blocks of at most LZ_BLOCK_SIZE bytes, each written
+ * as an LzBlockHeader followed by its stored bytes. storedLength equal to
+ * rawLength means the block did not shrink and is stored as is.
+ *
+ * Inside a compressed block every sequence is a token byte (literal count in
+ * the high nibble, match length - 4 in the low nibble), extra literal count
+ * bytes if the nibble is 15, the literals, then a little-endian 16-bit
+ * offset and extra match length bytes. The last sequence has literals only.
+ */
+#define LZ_BLOCK_SIZE 16384
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+
+struct __attribute__((packed)) LzBlockHeader
+{
+	uint16_t rawLength;
+	uint16_t storedLength;
+};
+
+// The compressor's only state; keep one per caller, it needs no initialising
+struct LzWork
+{
+	uint16_t table[1 << LZ_HASH_BITS];
+};
+
+#define LZ_COMPRESS_BOUND(length) ((length) + (length) / 255 + 16)
+
+/**
+ * Compresses length (at most LZ_BLOCK_SIZE) bytes of src into dst. Returns
+ * the compressed length, or -1 if it would not fit in capacity.
+ */
+int lzCompress(LzWork & work, const uint8_t * src, size_t length, uint8_t * dst, size_t capacity);
+
+/**
+ * Decompresses one block. Returns the decompressed length, or -1 if the
+ * block is malformed or does not fit in capacity.
+ */
+int lzDecompress(const uint8_t * src, size_t length, uint8_t * dst, size_t capacity);
+
+/**
+ * Decodes a stream of LzBlockHeader-framed blocks fed in pieces of any size,
+ * holding only one block's window. Each block is handed to the sink as soon
+ * as it is complete.
+ */
+class LzStreamDecoder
+{
+public:
+	typedef void (*Sink)(void * context, const uint8_t * data, size_t length);
+
+	LzStreamDecoder(Sink sink, void * context) : sink(sink), context(context) {}
+
+	// Returns false once the stream is found to be malformed
+	bool feed(const uint8_t * data, size_t length);
+
+	// True between blocks, i.e. when the stream may legally end here
+	bool idle() const {return state == STATE_HEADER && headerFill == 0;}
+
+	uint64_t rawBytes() const {return raw;}
+
+private:
+	enum State
+	{
+		STATE_HEADER,
+		STATE_STORED,
+		STATE_TOKEN,
+		STATE_LITERAL_LENGTH,
+		STATE_LITERALS,
+		STATE_OFFSET,
+		STATE_MATCH_LENGTH,
+		STATE_ERROR
+	};
+
+	bool endBlock();
+	bool copyMatch();
+
+	Sink sink;
+	void * context;
+	State state = STATE_HEADER;
+	uint8_t headerBytes[sizeof(LzBlockHeader)];
+	size_t headerFill = 0;
+	LzBlockHeader header;
+	size_t stored = 0;
+	size_t literals = 0;
+	size_t match = 0;
+	uint16_t offset = 0;
+	size_t offsetFill = 0;
+	size_t fill = 0;
+	uint64_t raw = 0;
+	uint8_t window[LZ_BLOCK_SIZE];
+};
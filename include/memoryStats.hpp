@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Allocation accounting.
+ *
+ * Heap counters cover every newlib malloc() and lv_mem_alloc() (both wrapped
+ * at link time, see Makefile) and every C++ new (global operator new is
+ * replaced). Subsystem counters cover the allocations this program tags
+ * itself through memAlloc()/memFree(), TrackedAllocator and TrackedObject.
+ */
+enum MemSubsystem
+{
+	MEM_STYLE,
+	MEM_GRAPH,
+	MEM_WIDGET,
+	MEM_PORT_DATA,
+	MEM_SUBSYSTEM_COUNT
+};
+
+enum MemHeap
+{
+	HEAP_MALLOC,
+	HEAP_NEW,
+	HEAP_LVGL,
+	HEAP_COUNT
+};
+
+struct MemCounter
+{
+	int32_t bytes;
+	int32_t peak;
+	uint32_t allocs;
+	uint32_t frees;
+};
+
+struct MemSnapshot
+{
+	uint32_t time;
+	uint32_t arena;
+	uint32_t used;
+	uint32_t free;
+	uint32_t largestFree;
+	uint32_t fragmentation;
+	uint32_t kernelFree;
+};
+
+void memCount(MemCounter & counter, int32_t delta);
+MemCounter & memSubsystemCounter(MemSubsystem subsystem);
+const MemCounter & memHeapCounter(MemHeap heap);
+size_t memBlockSize(void * pointer);
+
+void * memAlloc(MemSubsystem subsystem, size_t size);
+void * memRealloc(MemSubsystem subsystem, void * pointer, size_t size);
+void memFree(MemSubsystem subsystem, void * pointer);
+
+template <class T, MemSubsystem subsystem>
+struct TrackedAllocator
+{
+	typedef T value_type;
+
+	TrackedAllocator() = default;
+	template <class U> TrackedAllocator(const TrackedAllocator<U, subsystem> &) {}
+	template <class U> struct rebind {typedef TrackedAllocator<U, subsystem> other;};
+
+	T * allocate(size_t n)
+	{
+		T * pointer = static_cast<T *>(::operator new(n * sizeof(T)));
+		memCount(memSubsystemCounter(subsystem), memBlockSize(pointer));
+		return pointer;
+	}
+
+	void deallocate(T * pointer, size_t)
+	{
+		memCount(memSubsystemCounter(subsystem), -(int32_t)memBlockSize(pointer));
+		::operator delete(pointer);
+	}
+
+	bool operator==(const TrackedAllocator &) const {return true;}
+	bool operator!=(const TrackedAllocator &) const {return false;}
+};
+
+template <MemSubsystem subsystem>
+struct TrackedObject
+{
+	static void * operator new(size_t size)
+	{
+		void * pointer = ::operator new(size);
+		memCount(memSubsystemCounter(subsystem), memBlockSize(pointer));
+		return pointer;
+	}
+
+	static void operator delete(void * pointer)
+	{
+		memCount(memSubsystemCounter(subsystem), -(int32_t)memBlockSize(pointer));
+		::operator delete(pointer);
+	}
+};
+
+/**
+ * Records a heap snapshot into a fixed ring at most once per interval.
+ * largestFree is the contiguous space at the top of the newlib heap (top
+ * chunk plus unclaimed sbrk space); fragmentation is the share of free newlib
+ * memory stranded below it, in percent.
+ */
+bool memSample(uint32_t now, uint32_t interval = 10000);
+MemSnapshot memCurrent();
+
+std::string memReport();
+bool memStream(uint32_t now, uint32_t interval = 10000);
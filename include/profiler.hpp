@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Scoped profiling zones for the engine and UI loops.
+ *
+ * Every zone keeps a fixed log-bucket histogram (8 buckets per power of two,
+ * 64 ns up to ~4 s) plus count/total/min/max, so recording never allocates.
+ * Time comes from the Cortex-A9 cycle counter on the brain and from
+ * clock_gettime() on host builds. Zones may nest, in which case the outer
+ * zone's time includes the inner one. The engine, UI and RPC tasks all
+ * record, so the tables are guarded by a mutex created in profilerInit().
+ *
+ * Build with EXTRA_CXXFLAGS=-DPROFILER_ENABLED=0 to compile every zone out.
+ */
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+enum ProfileZoneId
+{
+	ZONE_LOOP,
+	ZONE_UI_LOOP,
+	ZONE_DEVICE_POLL,
+	ZONE_STATE_MACHINE,
+	ZONE_SAMPLING,
+	ZONE_OVERVIEW_PAGE,
+	ZONE_MOTOR_INFO,
+	ZONE_CONTROLLER_PAGE,
+	ZONE_ADI_PAGE,
+	ZONE_CHECKPOINT,
+	ZONE_RPC,
+	ZONE_LVGL_REFRESH,
+	ZONE_ADI_SCOPE,
+	ZONE_VISION_PAGE,
+	ZONE_COUNT
+};
+
+struct ProfileSummary
+{
+	uint32_t count;
+	uint32_t minNs;
+	uint32_t p50Ns;
+	uint32_t p99Ns;
+	uint32_t maxNs;
+	uint64_t totalNs;
+};
+
+#if PROFILER_ENABLED
+
+uint32_t profilerTicks();
+uint64_t profilerTicksToNs(uint32_t ticks);
+
+void profilerInit();
+void profilerRecord(ProfileZoneId zone, uint64_t ns);
+void profilerReset();
+ProfileSummary profilerSummary(ProfileZoneId zone);
+
+class ProfileScope
+{
+private:
+	ProfileZoneId zone;
+	uint32_t start;
+
+public:
+	ProfileScope(ProfileZoneId zone) : zone(zone), start(profilerTicks()) {}
+	~ProfileScope() {profilerRecord(zone, profilerTicksToNs(profilerTicks() - start));}
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+
+#else
+
+inline uint32_t profilerTicks() {return 0;}
+inline uint64_t profilerTicksToNs(uint32_t) {return 0;}
+
+inline void profilerInit() {}
+inline void profilerRecord(ProfileZoneId, uint64_t) {}
+inline void profilerReset() {}
+inline ProfileSummary profilerSummary(ProfileZoneId) {return {0, 0, 0, 0, 0, 0};}
+
+#define PROFILE_ZONE(zone)
+
+#endif
+
+/**
+ * One line per zone (count, min/p50/p99/max in microseconds), for the Extra
+ * Info page.
+ */
+std::string profilerReport();
+
+/**
+ * Prints the same table to stdout, at most once per interval. Returns true
+ * when something was printed.
+ */
+bool profilerStream(uint32_t now, uint32_t interval = 2000);
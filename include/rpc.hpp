@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Binary request/response protocol on the USB serial link, so a host script
+ * can drive the bench without the touchscreen.
+ *
+ * Frames are COBS encoded and delimited by 0x00 in both directions. Starting
+ * the RPC task switches off the kernel's own stream multiplexing, so printf
+ * text goes out raw between frames. Every outgoing frame is written with one
+ * write() call and starts and ends with a delimiter, so the host can split on
+ * 0x00 and treat anything that does not decode to a known prefix as text.
+ *
+ * Outgoing frames carry a 4-byte stream prefix inside the COBS payload, the
+ * same way the kernel's sout/serr streams do. Requests carry no prefix.
+ *
+ *   request:  command, sequence, arguments
+ *   response: command | 0x80, sequence, status, data
+ *
+ * All multi-byte fields are little endian. This header has no PROS
+ * dependencies so host tools can include it.
+ */
+#define RPC_STREAM_RESPONSE 0x72637072 // "rpcr"
+#define RPC_STREAM_SAMPLES 0x73637072 // "rpcs"
+#define RPC_MAX_FRAME 256
+#define RPC_RESPONSE_FLAG 0x80
+
+enum RpcCommand
+{
+	RPC_PING = 1,
+	RPC_RETEST,       // uint8 port (1-21)
+	RPC_ABORT,
+	RPC_RESUME,
+	RPC_SET_PROFILE,  // RpcProfile, optionally followed by RpcTestOptions; any other length is refused
+	RPC_GET_PROFILE,  // responds RpcProfile, RpcTestOptions
+	RPC_DUMP_RESULTS, // one RPC_MORE frame per finished port, then RpcSummary
+	RPC_STREAM_PORT,  // uint8 port (1-21), 0 stops streaming
+	RPC_SHOW_PAGE     // uint8 page, uint8 port
+};
+
+enum RpcStatus
+{
+	RPC_OK,
+	RPC_MORE,
+	RPC_BAD_REQUEST,
+	RPC_BUSY,
+	RPC_UNKNOWN_COMMAND
+};
+
+enum RpcResultFlag
+{
+	RPC_TIMED_OUT = 1,
+	RPC_MOTOR_WORKING = 2,
+	RPC_CURRENT_WORKING = 4,
+	RPC_BREAK_MODE_WORKING = 8,
+	RPC_ENCODER_ERROR = 16 // Set on error, unlike the others, so older results read as working
+};
+
+struct __attribute__((packed)) RpcTestPoint
+{
+	int16_t voltage;
+	float settleSpeed;
+	int16_t settleCurrent;
+};
+
+struct __attribute__((packed)) RpcProfile
+{
+	uint16_t testingTimeout;
+	uint8_t readingInterval;
+	uint8_t headlessReadingInterval;
+	uint8_t maxMotorsRunning;
+	RpcTestPoint testPoint[4];
+};
+
+// Optional test phases, sent after RpcProfile; left unchanged when omitted
+struct __attribute__((packed)) RpcTestOptions
+{
+	uint8_t velocityStepTest;
+	uint16_t velocityStepTimeout;
+	int16_t velocityStepList[4];
+	uint8_t positionTest;
+	uint16_t positionTestBudget;
+	uint16_t positionMoveTimeout;
+	int16_t positionMoveVelocity;
+	float positionTolerance;
+	float positionErrorAllowance;
+	uint8_t rampSweepTest;
+	uint16_t rampSweepTime;
+	float rampMovingSpeed;
+	uint8_t encoderTest;
+	uint16_t encoderWindow;
+	float encoderMinSpeed;
+	float encoderMaxAcceleration;
+	uint16_t encoderReversalLimit;
+	float encoderSkipTolerance;
+	float encoderSkipLimit;
+	float encoderJitterLimit;
+};
+
+struct __attribute__((packed)) RpcResult
+{
+	float settleSpeed;
+	int16_t settleCurrent;
+};
+
+// Sent with only resultCount entries of result
+struct __attribute__((packed)) RpcPortResult
+{
+	uint8_t port;
+	uint8_t state;
+	uint8_t flags;
+	uint8_t resultCount;
+	float averageScore;
+	int16_t coastTime;
+	int16_t breakTime;
+	RpcResult result[8];
+};
+
+struct __attribute__((packed)) RpcSummary
+{
+	int32_t totalResultCount;
+	int32_t coastTimeResultSum;
+	int32_t breakTimeResultSum;
+	RpcResult resultSum[4];
+	int32_t resultCount[4]; // Results in each resultSum; faulted test points aren't summed
+};
+
+// A RPC_STREAM_SAMPLES frame is an RpcSampleHeader followed by count RpcSamples
+struct __attribute__((packed)) RpcSampleHeader
+{
+	uint8_t port;
+	uint8_t state;
+	uint16_t count;
+	uint32_t firstIndex;
+};
+
+struct __attribute__((packed)) RpcSample
+{
+	uint32_t time;
+	int16_t appliedVoltage;
+	int16_t requestedVoltage;
+	int16_t current;
+	int16_t velocity;
+};
+
+/**
+ * Decodes one COBS frame (without its 0x00 delimiter). dest must hold length
+ * bytes. Returns the decoded length, or -1 if the frame is malformed.
+ */
+int cobsDecode(uint8_t * dest, const uint8_t * src, size_t length);
+
+/**
+ * Starts the request and sample-stream tasks. Safe to call more than once.
+ */
+void rpcStart();
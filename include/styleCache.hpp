@@ -0,0 +1,31 @@
+#pragma once
+
+#include "display/lvgl.h"
+
+/**
+ * Interned, immutable LVGL styles. Every distinct key is built once from
+ * lv_style_plain and shared by all widgets that use it, so recolouring a
+ * widget is a pointer swap. Never modify a returned style. The UI and LVGL
+ * tasks both intern, so lookups are guarded by a mutex created in
+ * styleInit(); draw code should look its styles up beforehand, not in a
+ * design function.
+ */
+struct StyleKey
+{
+	lv_color_t body;
+	lv_color_t text;
+	lv_color_t border = LV_COLOR_BLACK;
+	lv_coord_t borderWidth = 0;
+	lv_coord_t radius = 0;
+	lv_coord_t lineSpace = 2;
+
+	StyleKey(lv_color_t body, lv_color_t text) : body(body), text(text) {}
+
+	StyleKey & withBorder(lv_color_t color, lv_coord_t width) {border = color; borderWidth = width; return *this;}
+	StyleKey & withRadius(lv_coord_t value) {radius = value; return *this;}
+	StyleKey & withLineSpace(lv_coord_t value) {lineSpace = value; return *this;}
+};
+
+void styleInit();
+lv_style_t * styleGet(const StyleKey & key);
+int styleCount();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define MAX_MONITORED_TASKS 32
+
+/**
+ * Per-task CPU and stack usage built on uxTaskGetSystemState() and the
+ * FreeRTOS runtime-stats counter.
+ *
+ * libpros is built without a task-switch trace hook, so switch rates are only
+ * known for tasks that report their own yields through
+ * taskMonitorCountSwitch(). Other tasks show "-".
+ */
+struct TaskUsage
+{
+	char name[32];
+	uint32_t taskNumber;
+	uint32_t priority;
+	int state;
+	double cpuPercent;
+	uint32_t stackFreeBytes;
+	double switchRate;
+	bool ownSwitchCount;
+};
+
+/**
+ * Takes a snapshot at most once per interval; the scheduler is suspended only
+ * for the duration of uxTaskGetSystemState(). Returns true when a new snapshot
+ * was taken.
+ */
+bool taskMonitorSample(uint32_t now, uint32_t interval = 1000);
+
+/**
+ * Call from a monitored task each time it blocks or yields (e.g. right before
+ * pros::delay()).
+ */
+void taskMonitorCountSwitch();
+
+int taskMonitorCount();
+const TaskUsage & taskMonitorGet(int index);
+
+std::string taskMonitorReport();
+bool taskMonitorStream(uint32_t now, uint32_t interval = 5000);
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "main.h"
+#include "pros/apix.h"
+#include "memoryStats.hpp"
+#include "traceCodec.hpp"
+
+/**
+ * The motor test engine.
+ *
+ * Scanning, sampling and scoring run in their own task, started from
+ * initialize(), so competition mode changes never interrupt a test. The UI
+ * only reads PortData and asks for retests; anything that touches portData
+ * or the result sums from another task must hold an EngineLock.
+ */
+#define PORT_COUNT 21
+
+struct TestPoint
+{
+	int voltage;
+	double settleSpeed;
+	int settleCurrent;
+};
+
+struct TestPointResult
+{
+	double settleSpeed;
+	int settleCurrent;
+	uint32_t faults = 0; // motor_get_faults bits seen while the point ran; such a point isn't scored
+};
+
+/**
+ * How a motor's own velocity controller answered one motor_move_velocity
+ * step, from the recorded (filtered) velocity samples. Rise time runs from
+ * 10% to 90% of the step and is -1 if it never got there; overshoot is past
+ * the setpoint as a percent of the step; settling is from the command until
+ * the velocity stays within errorPercent of the setpoint, -1 if it never
+ * did; the steady-state error is the mean over the step's last 100 ms.
+ */
+struct VelocityStepResult
+{
+	int setpoint;
+	int riseTime;
+	double overshoot;
+	int settleTime;
+	double steadyStateError;
+};
+
+struct PositionMove
+{
+	bool relative;
+	int target; // Degrees
+};
+
+/**
+ * One motor_move_absolute/relative move: the final position error once the
+ * motor has stopped, and the time until it first came within
+ * positionTolerance of the target (-1 if it never did).
+ */
+struct PositionMoveResult
+{
+	int target;
+	double error;
+	int time;
+	bool relative;
+};
+
+/**
+ * A port's position moves: mean absolute final error and time to target,
+ * and the repeatability, the widest spread of final positions over repeats
+ * of an absolute target.
+ */
+struct PositionSummary
+{
+	int moves;
+	double meanError;
+	double spread;
+	double meanTime;
+};
+
+/**
+ * Velocity and current against applied voltage from a ramp sweep, as
+ * quadratics c[0] + c[1] V + c[2] V^2 in volts, per direction (0 forward,
+ * 1 reverse), fitted to the samples where the motor was moving. The dead
+ * band is where it starts moving on the way up and stops on the way down,
+ * averaged so the lag of the ramp cancels. Non-linearity is the quadratic
+ * term's share of the speed at 12 V, and asymmetry the forward speed at
+ * 12 V over the reverse one, both in percent.
+ */
+struct RampFit
+{
+	bool valid = false;
+	double velocity[2][3];
+	double current[2][3];
+	double deadBand[2]; // mV
+	double nonLinearity[2];
+	double asymmetry;
+};
+
+#define MOTOR_EVENT_LIMIT 32
+// The flags worth an event; zero velocity and zero position change all the time
+#define MOTOR_EVENT_FLAGS pros::E_MOTOR_FLAGS_BUSY
+
+/**
+ * A change in a motor's fault bits (motor_get_faults) or MOTOR_EVENT_FLAGS
+ * (motor_get_flags), read every tick while it is tested. Only the changes
+ * are kept, up to MOTOR_EVENT_LIMIT a test.
+ */
+struct MotorEvent
+{
+	uint32_t time;
+	uint32_t faults;
+	uint32_t flags;
+};
+
+/**
+ * Raw encoder counts against the reported velocity, taken in the sampling
+ * path while a voltage is held (see encoderTest). Each new reading checks
+ * that the count moved the way the motor was driven; each encoderWindow ms
+ * compares the counts with those the reported velocity accounts for.
+ */
+struct EncoderCheck
+{
+	int32_t lastCount = 0;
+	uint32_t lastStamp = 0;    // 0 before the first reading
+	int32_t windowCount = 0;
+	uint32_t windowStamp = 0;  // 0 while no window is open
+	double windowExpected = 0; // Counts the reported velocity accounts for since windowStamp
+	uint32_t windows = 0;
+	uint32_t skips = 0;        // Windows short of counts
+	uint32_t reversals = 0;    // Readings that went back against the drive
+	double sumSquares = 0;     // Of each window's rate error, rpm
+};
+
+template <class T> using PortVector = std::vector<T, TrackedAllocator<T, MEM_PORT_DATA>>;
+
+struct PortData
+{
+	int state = 0;
+	long lastPlug = -1;
+	pros::c::v5_device_e_t device = pros::c::E_DEVICE_NONE;
+	int requestedVoltageValue = 0;
+	double acceleration = 0;
+	long testingStart = 0;
+	int testPoint = 0;
+	int testPointStep = 0;
+	long testStart = 0;
+	long lastReading = 0;
+	PortVector<long> time;
+	PortVector<int> appliedVoltage;
+	PortVector<int> requestedVoltage;
+	PortVector<int> current;
+	PortVector<int> velocity;
+	PortVector<TestPointResult> results;
+	int velocityStep = -1; // Index into velocityStepList while a step runs
+	long velocityStepStart = 0;
+	size_t velocityStepSample = 0;
+	PortVector<VelocityStepResult> velocityResults;
+	bool rampDone = false;
+	long rampStart = -1;
+	size_t rampSample = 0;
+	RampFit rampFit;
+	int positionMove = -1; // Index into positionMoveList while the position test runs
+	long positionTestStart = 0;
+	long positionMoveStart = 0;
+	long positionStillSince = 0;
+	double positionTarget = 0;
+	int positionReached = -1;
+	PortVector<PositionMoveResult> positionResults;
+	long start = 0;
+	int coastTime;
+	int breakTime;
+	bool motorWorking = false;
+	bool currentWorking = false;
+	double averageScore = 0;
+	bool timedOut = false;
+	bool breakModeWorking = true;
+	EncoderCheck encoder;
+	bool encoderWorking = true;
+	uint32_t motorFaults = 0; // As last read
+	uint32_t motorFlags = 0;
+	uint32_t pointFaults = 0; // Seen since the current test point started
+	PortVector<MotorEvent> events;
+	uint32_t eventsDropped = 0;
+	// A finished test's samples, encoded (see traceCodec.hpp); the vectors above are released
+	PortVector<uint8_t> trace;
+	PortVector<uint32_t> traceKeyframes;
+	uint32_t traceSamples = 0;
+	// Bumped whenever the engine changes anything worth redrawing
+	uint32_t revision = 0;
+};
+
+extern PortData portData[PORT_COUNT];
+
+extern int testingTimeout;
+extern int readingInterval;
+extern int headlessReadingInterval;
+extern double errorPercent;
+
+/**
+ * A test point settles once the filtered acceleration has gone above
+ * settleStartAcceleration, dropped below settledAcceleration and stayed there
+ * (not back above unsettledAcceleration) for 100 ms. An average score below
+ * failScore fails the motor (102), below warnScore marks it marginal (101).
+ */
+extern double settleStartAcceleration;
+extern double settledAcceleration;
+extern double unsettledAcceleration;
+extern double failScore;
+extern double warnScore;
+
+extern TestPoint testPointList[4];
+const int testPointCount = sizeof(testPointList) / sizeof(TestPoint);
+
+/**
+ * With velocityStepTest on, each voltage test point that settles is followed
+ * by a motor_move_velocity step to the matching setpoint (rpm) before the
+ * next one, so the steps start from a known speed and cost only their own
+ * settling time. A step ends once settled for 100 ms or after
+ * velocityStepTimeout ms. testingTimeout is extended by testPointCount
+ * times velocityStepTimeout while the steps are on, so a slow motor isn't
+ * timed out by them.
+ */
+extern int velocityStepTest;
+extern int velocityStepTimeout;
+extern int velocityStepList[testPointCount];
+
+/**
+ * With rampSweepTest on, the four voltage test points are replaced by one
+ * sweep from 0 to 12 V, back to 0, to -12 V and back, over rampSweepTime
+ * ms. The results at the test point voltages come from the fitted curves
+ * (RampFit), so scoring is unchanged, and the velocity steps run one after
+ * another after it. Samples below rampMovingSpeed rpm are left out of the
+ * fits. testingTimeout is extended by rampSweepTime while the sweep is on.
+ */
+extern int rampSweepTest;
+extern int rampSweepTime;
+extern double rampMovingSpeed;
+
+/**
+ * With positionTest on, the brake test is followed by positionMoveList at
+ * positionMoveVelocity from a tared position. A move ends once the motor has
+ * stood still for 50 ms after reaching the target, or after
+ * positionMoveTimeout ms. The whole sequence is cut off at
+ * positionTestBudget ms, and moves it didn't finish are left out. The final
+ * error plus the spread, beyond positionErrorAllowance degrees, costs score
+ * like a slow brake. testingTimeout is extended by positionTestBudget while
+ * the test is on, so the moves don't time the test out.
+ */
+extern int positionTest;
+extern int positionTestBudget;
+extern int positionMoveTimeout;
+extern int positionMoveVelocity;
+extern double positionTolerance;
+extern double positionErrorAllowance;
+extern PositionMove positionMoveList[6];
+const int positionMoveCount = sizeof(positionMoveList) / sizeof(PositionMove);
+
+/**
+ * With encoderTest on, motor_get_raw_position is checked whenever a test
+ * holds a voltage and the motor turns that way at encoderMinSpeed rpm or
+ * more without accelerating faster than encoderMaxAcceleration rpm/s, at
+ * no cost in test time. The encoder fails (encoderWorking) on more than
+ * encoderReversalLimit readings going back, more than encoderSkipLimit
+ * percent of windows short of counts by encoderSkipTolerance percent, or a
+ * window rate error over encoderJitterLimit rpm RMS.
+ */
+extern int encoderTest;
+extern int encoderWindow;
+extern double encoderMinSpeed;
+extern double encoderMaxAcceleration;
+extern int encoderReversalLimit;
+extern double encoderSkipTolerance;
+extern double encoderSkipLimit;
+extern double encoderJitterLimit;
+
+// Short names for motor_get_faults and motor_get_flags bits, "OT OC" and so on
+std::string engineFaultNames(uint32_t faults, uint32_t flags);
+
+// RMS window rate error, rpm
+double engineEncoderJitter(const EncoderCheck & check);
+
+extern int averageCoastTime;
+extern int averageBreakTime;
+
+// Faulted test points are left out of the sums, so each has its own count
+extern TestPointResult testResultSum[testPointCount];
+extern int testResultCount[testPointCount];
+extern int coastTimeResultSum;
+extern int breakTimeResultSum;
+extern int totalResultCount;
+
+// Milliseconds since boot when the first motor started testing, -1 until then
+extern long firstMotorAdmitted;
+
+/**
+ * In headless mode the UI is detached, the engine loop runs on a 1 ms period
+ * and samples at headlessReadingInterval. Sample spacing is timed per mode
+ * so the two can be compared.
+ */
+enum EngineMode
+{
+	ENGINE_MODE_UI,
+	ENGINE_MODE_HEADLESS,
+	ENGINE_MODE_COUNT
+};
+
+struct TraceStats
+{
+	uint32_t traces;
+	uint32_t samples;
+	uint32_t rawBytes;
+	uint32_t encodedBytes;
+	uint64_t encodeUs;
+};
+
+struct SampleTiming
+{
+	uint32_t count;
+	uint64_t sumUs;
+	uint64_t sumSquaresUs;
+	uint32_t maxUs;
+};
+
+// The tunable parts of a test run, settable remotely between runs
+struct TestProfile
+{
+	int testingTimeout;
+	int readingInterval;
+	int headlessReadingInterval;
+	int maxMotorsRunning;
+	TestPoint testPoint[testPointCount];
+	int velocityStepTest;
+	int velocityStepTimeout;
+	int velocityStepList[testPointCount];
+	int positionTest;
+	int positionTestBudget;
+	int positionMoveTimeout;
+	int positionMoveVelocity;
+	double positionTolerance;
+	double positionErrorAllowance;
+	int rampSweepTest;
+	int rampSweepTime;
+	double rampMovingSpeed;
+	int encoderTest;
+	int encoderWindow;
+	double encoderMinSpeed;
+	double encoderMaxAcceleration;
+	int encoderReversalLimit;
+	double encoderSkipTolerance;
+	double encoderSkipLimit;
+	double encoderJitterLimit;
+};
+
+// A finished test, queued for serial and SD output
+struct TestRecord
+{
+	uint32_t time;
+	int port;
+	int state;
+	double averageScore;
+	int coastTime;
+	int breakTime;
+	bool timedOut;
+	bool motorWorking;
+	bool currentWorking;
+	bool breakModeWorking;
+	bool encoderWorking;
+	int resultCount;
+	TestPointResult results[8];
+};
+
+class EngineLock
+{
+public:
+	EngineLock();
+	~EngineLock();
+};
+
+/**
+ * One pass over every port: detect plugs, step each test's state machine and
+ * take samples. The engine task calls it every loop; the host replay
+ * (host/replay.cpp) calls it in virtual time.
+ */
+void engineTick();
+
+/**
+ * Restores the last checkpoint and creates the engine task. Safe to call
+ * more than once.
+ */
+void engineStart();
+
+/**
+ * Stops the motor on the port and queues it to be tested again.
+ */
+void engineRetest(int port);
+
+void engineSetMode(EngineMode mode);
+EngineMode engineGetMode();
+SampleTiming engineSampleTiming(EngineMode mode);
+
+/**
+ * Sample rate and jitter (standard deviation of sample spacing) per mode,
+ * with the headless gain once both have data.
+ */
+std::string engineTimingReport();
+
+/**
+ * Number of samples on a port and a copy of count of them from first on,
+ * whether the test is still running or its trace is encoded. The caller
+ * holds EngineLock or passes its own copy of the PortData.
+ */
+size_t engineTraceLength(const PortData & port);
+size_t engineTraceRead(const PortData & port, size_t first, TraceSample * out, size_t count);
+
+/**
+ * Accuracy, repeatability and settle time over the position moves a port
+ * finished. Same locking as engineTraceRead.
+ */
+PositionSummary enginePositionSummary(const PortData & port);
+
+// A fitted curve at voltage (mV), in the direction of its sign
+double engineRampValue(const double (&curve)[2][3], double voltage);
+
+TraceStats engineTraceStats();
+
+/**
+ * Compression ratio and encode cost per sample of the finished traces.
+ */
+std::string engineTraceReport();
+
+/**
+ * Takes the oldest finished test off the queue. The queue holds the last 32
+ * results; older ones are dropped if nobody drains it.
+ */
+bool enginePopRecord(TestRecord & record);
+
+/**
+ * Abort stops every motor, drops every test in progress and holds new tests
+ * back until engineResume(). Finished results are kept.
+ */
+void engineAbort();
+void engineResume();
+bool engineIsPaused();
+
+TestProfile engineGetProfile();
+
+/**
+ * Whether every setting in profile is in a range a test can finish with,
+ * e.g. a ramp long enough to fit and phase timeouts that aren't zero.
+ */
+bool engineProfileValid(const TestProfile & profile);
+
+/**
+ * Fails (returns false) while any port is mid-test.
+ */
+bool engineSetProfile(const TestProfile & profile);
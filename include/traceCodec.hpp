@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Compact encoding for motor test traces, shared by the brain and the host
+ * tools (no PROS dependencies).
+ *
+ * Each sample starts with a header byte: bit 7 marks a keyframe, bits 0-4
+ * say which channels follow. A keyframe carries every channel as an absolute
+ * value. Other samples carry, for each flagged channel, the zig-zag varint
+ * difference from a prediction: the previous value, or for time the previous
+ * value plus the previous step. Channels that match their prediction cost
+ * nothing, so a steady sample is usually the header plus current and
+ * velocity, 3 bytes against 20 raw.
+ *
+ * Every TRACE_KEYFRAME_INTERVAL-th sample (starting with the first) is a
+ * keyframe, so with the byte offset of each keyframe a reader can start
+ * decoding anywhere without walking the whole trace.
+ */
+#define TRACE_KEYFRAME_INTERVAL 64
+#define TRACE_KEYFRAME_FLAG 0x80
+#define TRACE_LOG_MAGIC 0x32435254 // "TRC2"
+#define TRACE_LOG_LZ 1
+
+enum TraceChannel
+{
+	TRACE_TIME,
+	TRACE_APPLIED_VOLTAGE,
+	TRACE_REQUESTED_VOLTAGE,
+	TRACE_CURRENT,
+	TRACE_VELOCITY,
+	TRACE_CHANNELS
+};
+
+#define TRACE_MAX_SAMPLE_BYTES (1 + TRACE_CHANNELS * 5)
+
+struct TraceSample
+{
+	int32_t value[TRACE_CHANNELS];
+};
+
+class TraceEncoder
+{
+public:
+	void reset() {count = 0;}
+
+	/**
+	 * Writes sample to out (at most TRACE_MAX_SAMPLE_BYTES) and returns the
+	 * number of bytes written.
+	 */
+	size_t encode(const TraceSample & sample, uint8_t * out);
+
+	bool nextIsKeyframe() const {return count % TRACE_KEYFRAME_INTERVAL == 0;}
+	uint32_t samples() const {return count;}
+
+private:
+	uint32_t count = 0;
+	int32_t previous[TRACE_CHANNELS];
+	int32_t step;
+};
+
+class TraceDecoder
+{
+public:
+	/**
+	 * data must start at a keyframe: the start of a trace or one of its
+	 * keyframe offsets.
+	 */
+	TraceDecoder(const uint8_t * data, size_t length) : cursor(data), end(data + length) {}
+
+	// Returns false at the end of the data or if it is malformed
+	bool next(TraceSample & sample);
+
+	size_t remaining() const {return end - cursor;}
+
+private:
+	const uint8_t * cursor;
+	const uint8_t * end;
+	bool started = false;
+	int32_t previous[TRACE_CHANNELS];
+	int32_t step;
+};
+
+/**
+ * Trace log record on the SD card: this header, then storedBytes of payload.
+ * The payload is one uint32 byte offset per keyframe followed by the encoded
+ * samples; with TRACE_LOG_LZ set it is compressed as LzBlockHeader blocks
+ * (see lzBlock.hpp).
+ */
+struct __attribute__((packed)) TraceLogHeader
+{
+	uint32_t magic;
+	uint32_t time;
+	uint8_t port;
+	uint8_t state;
+	uint16_t keyframeInterval;
+	uint32_t samples;
+	uint32_t bytes;
+	uint32_t storedBytes;
+	uint16_t flags;
+	uint16_t reserved;
+};
+
+inline uint32_t traceKeyframeCount(uint32_t samples) {return (samples + TRACE_KEYFRAME_INTERVAL - 1) / TRACE_KEYFRAME_INTERVAL;}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "testEngine.hpp"
+
+/**
+ * Appends finished test traces to the SD card, one TraceLogHeader record
+ * (traceCodec.hpp) per test.
+ *
+ * With traceLogCompress set each record's payload is LZ block compressed
+ * (lzBlock.hpp) before it is written, which cuts card wear and write time on
+ * long burn-ins. The compressor works in fixed static buffers; compression
+ * time, throughput and ratio are kept for the info page.
+ */
+extern bool traceLogCompress;
+
+struct TraceLogStats
+{
+	uint32_t segments;
+	uint32_t rawBytes;
+	uint32_t storedBytes;
+	uint64_t compressUs;
+	uint64_t writeUs;
+};
+
+/**
+ * Writes the trace of the test in record, if its port still holds that test.
+ * Runs outside EngineLock except for the copy of the trace.
+ */
+bool traceLogWrite(FILE * file, const TestRecord & record);
+
+const TraceLogStats & traceLogStats();
+std::string traceLogReport();
@@ -0,0 +1,21 @@
+#pragma once
+
+/**
+ * The LVGL pages run in their own task. Attaching starts it on first use;
+ * detaching switches to headless mode: every page update stops apart from a
+ * once-a-second status screen (tap it to attach again), the engine moves to
+ * ENGINE_MODE_HEADLESS, and results keep going to serial and the SD card.
+ * Re-attaching prints the UI/headless sampling comparison over serial.
+ */
+void uiAttach();
+void uiDetach();
+
+/**
+ * Switches to a page (0 overview, 1 motor info, 2 controllers, 3 3-wire, 4
+ * extra info, 5 tasks, 7 3-wire scope, 8 3-wire probe, 9 controller
+ * latency, 10 cable test, 11 vision); port selects the motor for the motor
+ * info and vision pages.
+ * The UI task makes the switch on its next pass, so this is safe from any
+ * task. Returns false for an unknown page or port, or while detached.
+ */
+bool uiShowPage(int page, int port);
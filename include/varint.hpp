@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Zig-zag and LEB128 varint helpers shared by the brain-side encoders and
+ * the host tools. Header only and free of PROS dependencies.
+ */
+inline uint64_t zigzagEncode(int64_t value) {return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);}
+
+inline int64_t zigzagDecode(uint64_t value) {return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);}
+
+/**
+ * Writes value to out (at most 10 bytes) and returns the number of bytes
+ * written.
+ */
+inline size_t varintPut(uint8_t * out, uint64_t value)
+{
+	size_t length = 0;
+	while(value >= 0x80)
+	{
+		out[length++] = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	out[length++] = (uint8_t)value;
+	return length;
+}
+
+/**
+ * Reads one varint from [in, end). Returns the number of bytes consumed, or
+ * 0 if the input ends early or the value is longer than 10 bytes.
+ */
+inline size_t varintGet(const uint8_t * in, const uint8_t * end, uint64_t & value)
+{
+	value = 0;
+	for(size_t length = 0; length < 10 && in + length < end; length++)
+	{
+		value |= (uint64_t)(in[length] & 0x7F) << (7 * length);
+		if((in[length] & 0x80) == 0) return length + 1;
+	}
+	return 0;
+}
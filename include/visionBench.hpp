@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define VISION_EXPOSURE_STEPS 4
+#define VISION_MAX_OBJECTS 8
+#define VISION_INTERVAL_BINS 100 // 1 ms each; the last bin holds everything longer
+#define VISION_LATENCY_BINS 40   // 5 ms each; the last bin holds everything longer
+#define VISION_LATENCY_BIN_MS 5
+#define VISION_CALL_BINS 50      // 100 us each; the last bin holds everything longer
+#define VISION_CALL_BIN_US 100
+
+/**
+ * Benchmarks a vision sensor's frame rate and reporting latency.
+ *
+ * A task polls the object count and up to VISION_MAX_OBJECTS objects each
+ * millisecond, either by size or by signature 1. The sensor does not report a
+ * frame number, so a frame counts as fresh when the objects it reports
+ * change. Something moving in view is needed for every frame to differ. The
+ * most common gap between fresh frames is the period, as for the
+ * controllers, and polling once a millisecond limits it to 1 ms.
+ *
+ * The exposure cycles through visionExposures, dwelling a few seconds on
+ * each. A new exposure changes the image, so the time from
+ * vision_set_exposure() to the first fresh frame is the latency from a
+ * change in front of the lens to the objects reporting it, one sample per
+ * switch. Each exposure keeps its own histograms. The sensor's own exposure
+ * is put back on stop.
+ */
+extern const uint8_t visionExposures[VISION_EXPOSURE_STEPS];
+
+enum VisionReadMode
+{
+	VISION_READ_SIZE,
+	VISION_READ_SIGNATURE
+};
+
+struct VisionStep
+{
+	uint32_t frames;
+	uint32_t objects; // Summed over frames
+	uint32_t interval[VISION_INTERVAL_BINS];
+	double periodMs;
+	double rate;
+	double jitterMs;
+	uint32_t latency[VISION_LATENCY_BINS];
+	uint32_t latencyCount;
+};
+
+struct VisionBench
+{
+	int port; // 0-based, -1 when never started
+	VisionReadMode mode;
+	bool connected;
+	int step;
+	int32_t originalExposure;
+	uint32_t polls;
+	uint32_t errors;
+	uint32_t call[VISION_CALL_BINS]; // Count plus read, per poll
+	uint32_t maxCallUs;
+	VisionStep steps[VISION_EXPOSURE_STEPS];
+};
+
+// Benchmarks port while started; the task is created on first use
+void visionBenchStart(int port, VisionReadMode mode);
+void visionBenchStop();
+void visionBenchReset();
+
+VisionBench visionBenchGet();
+std::string visionBenchReport();
@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "main.h"
+#include "adiProbe.hpp"
+#include "taskMonitor.hpp"
+
+#define RAIL_LOW 400
+#define RAIL_HIGH 3700
+#define LEVEL_LOW 1000
+#define LEVEL_HIGH 3000
+#define FLAT_SPREAD 100
+#define BOUNCE_MS 10
+#define RATE_WINDOW_MS 100
+
+uint32_t adiProbeWindow = 3000;
+uint32_t adiProbeConfirmTime = 500;
+uint32_t adiProbeJitterTime = 20;
+
+enum ProbeRequest {REQUEST_NONE, REQUEST_SCAN, REQUEST_STOP};
+
+struct PortProbe
+{
+	// Scan
+	int32_t low, high;
+	uint32_t railSamples;
+	int level;
+	uint32_t edges;
+
+	// Test
+	uint32_t samples;
+	double sum, sumSquares;
+	int32_t last;
+	uint32_t lastChange;
+	int direction;
+	uint32_t lastReversal;
+	int32_t rateCount;
+	uint32_t rateStart;
+	uint32_t updates;
+	uint64_t updateSum;
+	bool confirmed;
+	int32_t handle;
+};
+
+struct PairProbe
+{
+	int lastEdge;
+	uint32_t alternating, repeated, illegal;
+};
+
+static pros::task_t probeTask = NULL;
+static pros::mutex_t probeMutex = NULL;
+static volatile ProbeRequest request = REQUEST_NONE;
+static AdiProbeStatus status = {ADI_PROBE_STOPPED};
+static PortProbe probe[ADI_PORT_COUNT];
+static PairProbe pair[ADI_PORT_COUNT / 2];
+
+class ProbeLock
+{
+public:
+	ProbeLock() {pros::c::mutex_take(probeMutex, TIMEOUT_MAX);}
+	~ProbeLock() {pros::c::mutex_give(probeMutex);}
+};
+
+// Shuts down encoders and ultrasonics and leaves every port an analog input
+static void release()
+{
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		if(status.port[i].type == ADI_DEVICE_ENCODER) pros::c::adi_encoder_shutdown(probe[i].handle);
+		if(status.port[i].type == ADI_DEVICE_ULTRASONIC) pros::c::adi_ultrasonic_shutdown(probe[i].handle);
+	}
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		pros::c::adi_port_set_config(i + 1, pros::E_ADI_ANALOG_IN);
+		status.port[i] = {ADI_DEVICE_EMPTY};
+	}
+}
+
+static void beginScan(uint32_t now)
+{
+	for(int i = 0; i < ADI_PORT_COUNT; i++) probe[i] = {INT32_MAX, INT32_MIN, 0, -1, 0};
+	for(int i = 0; i < ADI_PORT_COUNT / 2; i++) pair[i] = {-1, 0, 0, 0};
+	status.phase = ADI_PROBE_SCANNING;
+	status.phaseStart = now;
+	status.samples = 0;
+}
+
+static void scanStep()
+{
+	bool changed[ADI_PORT_COUNT] = {};
+
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		PortProbe & p = probe[i];
+		int32_t value = pros::c::adi_analog_read(i + 1);
+		if(value == PROS_ERR) continue;
+
+		if(value < p.low) p.low = value;
+		if(value > p.high) p.high = value;
+		if(value < RAIL_LOW || value > RAIL_HIGH) p.railSamples++;
+
+		int level = value > LEVEL_HIGH ? 1 : value < LEVEL_LOW ? 0 : p.level;
+		changed[i] = p.level != -1 && level != p.level;
+		if(changed[i]) p.edges++;
+		p.level = level;
+	}
+
+	// Quadrature edges take turns between the two channels; both at once means one was missed
+	for(int i = 0; i < ADI_PORT_COUNT / 2; i++)
+	{
+		PairProbe & q = pair[i];
+		bool top = changed[2 * i], bottom = changed[2 * i + 1];
+		if(top && bottom)
+		{
+			q.illegal++;
+			q.lastEdge = -1;
+		}
+		else if(top || bottom)
+		{
+			int edge = top ? 0 : 1;
+			if(q.lastEdge != -1) (edge != q.lastEdge ? q.alternating : q.repeated)++;
+			q.lastEdge = edge;
+		}
+	}
+
+	status.samples++;
+}
+
+static bool onRails(int i) {return status.samples > 0 && probe[i].railSamples >= status.samples * 0.95;}
+
+static bool flat(int i) {return probe[i].high - probe[i].low < FLAT_SPREAD;}
+
+static AdiDeviceType classifySingle(int i)
+{
+	if(probe[i].edges >= 2 && onRails(i)) return ADI_DEVICE_SWITCH;
+	if(flat(i) && probe[i].low > RAIL_HIGH) return ADI_DEVICE_EMPTY;
+	return ADI_DEVICE_ANALOG;
+}
+
+static void resetTest(int i, uint32_t now)
+{
+	PortProbe & p = probe[i];
+	p.samples = 0;
+	p.sum = p.sumSquares = 0;
+	p.last = INT32_MIN;
+	p.lastChange = now;
+	p.direction = 0;
+	p.lastReversal = 0;
+	p.rateCount = 0;
+	p.rateStart = now;
+	p.updates = 0;
+	p.updateSum = 0;
+
+	AdiPortTest & test = status.port[i];
+	AdiDeviceType type = test.type;
+	uint32_t illegal = test.illegalTransitions;
+	test = {type};
+	test.low = INT32_MAX;
+	test.high = INT32_MIN;
+	test.illegalTransitions = illegal;
+}
+
+static void classify(uint32_t now)
+{
+	bool confirming = false;
+
+	for(int i = 0; i < ADI_PORT_COUNT; i += 2)
+	{
+		const PairProbe & q = pair[i / 2];
+		uint32_t turns = q.alternating + q.repeated;
+		if(probe[i].edges >= 4 && probe[i + 1].edges >= 4 && onRails(i) && onRails(i + 1) && q.alternating >= turns * 0.8)
+		{
+			probe[i].handle = pros::c::adi_encoder_init(i + 1, i + 2, false);
+			if(probe[i].handle != PROS_ERR)
+			{
+				status.port[i].type = ADI_DEVICE_ENCODER;
+				status.port[i].illegalTransitions = q.illegal;
+				status.port[i + 1].type = ADI_DEVICE_PAIRED;
+				continue;
+			}
+		}
+
+		// A quiet echo line sits low; the ping line is driven by the brain
+		if(flat(i) && probe[i].high < RAIL_LOW && probe[i + 1].edges == 0 && flat(i + 1))
+		{
+			probe[i].handle = pros::c::adi_ultrasonic_init(i + 2, i + 1);
+			if(probe[i].handle != PROS_ERR)
+			{
+				status.port[i].type = ADI_DEVICE_ULTRASONIC;
+				status.port[i + 1].type = ADI_DEVICE_PAIRED;
+				probe[i].confirmed = false;
+				confirming = true;
+				continue;
+			}
+		}
+
+		for(int a = i; a < i + 2; a++)
+		{
+			status.port[a].type = classifySingle(a);
+			if(status.port[a].type == ADI_DEVICE_SWITCH) pros::c::adi_port_set_config(a + 1, pros::E_ADI_DIGITAL_IN);
+		}
+	}
+
+	for(int i = 0; i < ADI_PORT_COUNT; i++) resetTest(i, now);
+	status.phase = confirming ? ADI_PROBE_CONFIRMING : ADI_PROBE_TESTING;
+	status.phaseStart = now;
+}
+
+static void confirmStep()
+{
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		if(status.port[i].type != ADI_DEVICE_ULTRASONIC) continue;
+		int32_t value = pros::c::adi_ultrasonic_get(probe[i].handle);
+		if(value != PROS_ERR && value > 0) probe[i].confirmed = true;
+	}
+}
+
+static void finishConfirm(uint32_t now)
+{
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		if(status.port[i].type != ADI_DEVICE_ULTRASONIC || probe[i].confirmed) continue;
+
+		pros::c::adi_ultrasonic_shutdown(probe[i].handle);
+		for(int a = i; a < i + 2; a++)
+		{
+			pros::c::adi_port_set_config(a + 1, pros::E_ADI_ANALOG_IN);
+			status.port[a].type = classifySingle(a);
+			if(status.port[a].type == ADI_DEVICE_SWITCH) pros::c::adi_port_set_config(a + 1, pros::E_ADI_DIGITAL_IN);
+		}
+	}
+
+	for(int i = 0; i < ADI_PORT_COUNT; i++) resetTest(i, now);
+	status.phase = ADI_PROBE_TESTING;
+	status.phaseStart = now;
+}
+
+static void testStep(uint32_t now)
+{
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		PortProbe & p = probe[i];
+		AdiPortTest & test = status.port[i];
+
+		switch(test.type)
+		{
+		case ADI_DEVICE_EMPTY:
+		case ADI_DEVICE_ANALOG:
+		{
+			int32_t value = pros::c::adi_analog_read(i + 1);
+			if(value == PROS_ERR) break;
+			if(value < test.low) test.low = value;
+			if(value > test.high) test.high = value;
+			p.samples++;
+			p.sum += value;
+			p.sumSquares += (double)value * value;
+			test.mean = p.sum / p.samples;
+			test.noise = sqrt(fmax(0, p.sumSquares / p.samples - test.mean * test.mean));
+			break;
+		}
+		case ADI_DEVICE_SWITCH:
+		{
+			int32_t value = pros::c::adi_digital_read(i + 1);
+			if(value == PROS_ERR) break;
+			if(p.last != INT32_MIN && value != p.last)
+			{
+				test.edges++;
+				if(now - p.lastChange < BOUNCE_MS) test.bounces++;
+				p.lastChange = now;
+			}
+			p.last = value;
+			break;
+		}
+		case ADI_DEVICE_ENCODER:
+		{
+			int32_t count = pros::c::adi_encoder_get(p.handle);
+			if(count == PROS_ERR) break;
+			if(p.last == INT32_MIN) p.last = p.rateCount = count;
+
+			if(count != p.last)
+			{
+				int direction = count > p.last ? 1 : -1;
+				if(p.direction != 0 && direction != p.direction)
+				{
+					if(p.lastReversal != 0 && now - p.lastReversal < adiProbeJitterTime) test.jitter++;
+					p.lastReversal = now;
+				}
+				p.direction = direction;
+			}
+			p.last = test.count = count;
+
+			if(now - p.rateStart >= RATE_WINDOW_MS)
+			{
+				test.rate = (count - p.rateCount) * 1000.0 / (now - p.rateStart);
+				if(fabs(test.rate) > test.peakRate) test.peakRate = fabs(test.rate);
+				p.rateCount = count;
+				p.rateStart = now;
+			}
+			break;
+		}
+		case ADI_DEVICE_ULTRASONIC:
+		{
+			int32_t value = pros::c::adi_ultrasonic_get(p.handle);
+			if(value == PROS_ERR || value == p.last) break;
+			if(p.last != INT32_MIN)
+			{
+				uint32_t interval = now - p.lastChange;
+				p.updates++;
+				p.updateSum += interval;
+				test.updateMs = p.updateSum / p.updates;
+				if(interval > test.maxUpdateMs) test.maxUpdateMs = interval;
+				if(value == 0) test.missedEchoes++;
+			}
+			p.last = value;
+			p.lastChange = now;
+			// adi_ultrasonic_get() counts in 0.1 mm (10000 is 1 m); sound takes 5.8 us per mm out and back
+			if(value > 0)
+			{
+				test.distance = value / 10;
+				test.echoUs = value * 58 / 100;
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+static void probeLoop(void * parameter)
+{
+	uint32_t wake = pros::millis();
+
+	while(true)
+	{
+		ProbeRequest next = request;
+		if(next != REQUEST_NONE)
+		{
+			request = REQUEST_NONE;
+			ProbeLock lock;
+			release();
+			if(next == REQUEST_SCAN) beginScan(pros::millis());
+			else status.phase = ADI_PROBE_STOPPED;
+		}
+
+		if(status.phase == ADI_PROBE_STOPPED)
+		{
+			taskMonitorCountSwitch();
+			pros::delay(20);
+			wake = pros::millis();
+			continue;
+		}
+
+		{
+			uint32_t now = pros::millis();
+			ProbeLock lock;
+			switch(status.phase)
+			{
+			case ADI_PROBE_SCANNING:
+				scanStep();
+				if(now - status.phaseStart >= adiProbeWindow) classify(now);
+				break;
+			case ADI_PROBE_CONFIRMING:
+				confirmStep();
+				if(now - status.phaseStart >= adiProbeConfirmTime) finishConfirm(now);
+				break;
+			default:
+				testStep(now);
+				break;
+			}
+		}
+
+		taskMonitorCountSwitch();
+		pros::c::task_delay_until(&wake, 1);
+	}
+}
+
+void adiProbeStart()
+{
+	if(probeMutex == NULL) probeMutex = pros::c::mutex_create();
+	request = REQUEST_SCAN;
+	if(probeTask == NULL) probeTask = pros::c::task_create(probeLoop, NULL, TASK_PRIORITY_DEFAULT + 2, TASK_STACK_DEPTH_DEFAULT, "ADI Probe");
+}
+
+void adiProbeStop()
+{
+	if(probeTask != NULL && status.phase != ADI_PROBE_STOPPED) request = REQUEST_STOP;
+}
+
+AdiProbeStatus adiProbeStatus()
+{
+	if(probeMutex == NULL) return status;
+	ProbeLock lock;
+	return status;
+}
+
+std::string adiProbeReport()
+{
+	static const char * phaseName[] = {"stopped", "scanning", "confirming", "testing"};
+
+	AdiProbeStatus copy = adiProbeStatus();
+	std::string a = "3-wire probe: " + (std::string)phaseName[copy.phase] + "\n";
+	if(copy.phase == ADI_PROBE_STOPPED) return a;
+	if(copy.phase == ADI_PROBE_SCANNING)
+	{
+		char line[80];
+		snprintf(line, sizeof(line), "Turn encoders and press switches: %lu ms left\n",
+			(unsigned long)(adiProbeWindow - std::min(adiProbeWindow, pros::millis() - copy.phaseStart)));
+		return a + line;
+	}
+
+	for(int i = 0; i < ADI_PORT_COUNT; i++)
+	{
+		const AdiPortTest & test = copy.port[i];
+		char line[112];
+		switch(test.type)
+		{
+		case ADI_DEVICE_EMPTY:
+			snprintf(line, sizeof(line), "%c: empty or open switch\n", 'A' + i);
+			break;
+		case ADI_DEVICE_ANALOG:
+			snprintf(line, sizeof(line), "%c: analog %ld-%ld, mean %.0f, noise %.1f\n", 'A' + i, (long)test.low, (long)test.high, test.mean, test.noise);
+			break;
+		case ADI_DEVICE_SWITCH:
+			snprintf(line, sizeof(line), "%c: switch, %lu edges, %lu bounces\n", 'A' + i, (unsigned long)test.edges, (unsigned long)test.bounces);
+			break;
+		case ADI_DEVICE_ENCODER:
+			snprintf(line, sizeof(line), "%c%c: encoder %ld, %.0f/s (peak %.0f), jitter %lu, missed %lu\n", 'A' + i, 'A' + i + 1, (long)test.count,
+				test.rate, test.peakRate, (unsigned long)test.jitter, (unsigned long)test.illegalTransitions);
+			break;
+		case ADI_DEVICE_ULTRASONIC:
+			snprintf(line, sizeof(line), "%c%c: ultrasonic %ld mm, echo %lu us, update %lu/%lu ms, missed %lu\n", 'A' + i, 'A' + i + 1, (long)test.distance,
+				(unsigned long)test.echoUs, (unsigned long)test.updateMs, (unsigned long)test.maxUpdateMs, (unsigned long)test.missedEchoes);
+			break;
+		default:
+			continue;
+		}
+		a += line;
+	}
+	return a;
+}
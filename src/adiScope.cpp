@@ -0,0 +1,241 @@
+#include <cstdio>
+#include "main.h"
+#include "adiScope.hpp"
+#include "profiler.hpp"
+#include "taskMonitor.hpp"
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+// 1 ms is the shortest task_delay_until() period
+uint32_t adiScopePeriod = 1;
+
+static int16_t ring[ADI_SCOPE_CHANNELS][ADI_SCOPE_DEPTH];
+static uint32_t head = 0;
+static uint32_t filled = 0;
+
+static pros::task_t scopeTask = NULL;
+static pros::mutex_t scopeMutex = NULL;
+static volatile bool running = false;
+static uint8_t channels = 0;
+static AdiScopeState state = ADI_SCOPE_RUNNING;
+static AdiTrigger trigger = {ADI_TRIGGER_FREE, 0, 2048, ADI_SCOPE_DEPTH / 4};
+
+static uint32_t armedSamples = 0;
+static uint32_t remaining = 0;
+static uint32_t triggerSlot = 0;
+static uint32_t triggerTime = 0;
+static int16_t previous = -1;
+
+static uint32_t samples = 0;
+static uint32_t rateStart = 0;
+static uint64_t lastSampleUs = 0;
+static uint32_t maxGapUs = 0;
+
+class ScopeLock
+{
+public:
+	ScopeLock() {pros::c::mutex_take(scopeMutex, TIMEOUT_MAX);}
+	~ScopeLock() {pros::c::mutex_give(scopeMutex);}
+};
+
+static bool fires(int16_t before, int16_t value)
+{
+	switch(trigger.mode)
+	{
+	case ADI_TRIGGER_RISING: return before >= 0 && before < trigger.level && value >= trigger.level;
+	case ADI_TRIGGER_FALLING: return before >= trigger.level && value < trigger.level;
+	case ADI_TRIGGER_ABOVE: return value > trigger.level;
+	case ADI_TRIGGER_BELOW: return value < trigger.level;
+	default: return false;
+	}
+}
+
+// Empties the rings and restarts the trigger; called with the lock held
+static void restart()
+{
+	head = 0;
+	filled = 0;
+	state = trigger.mode == ADI_TRIGGER_FREE ? ADI_SCOPE_RUNNING : ADI_SCOPE_ARMED;
+	armedSamples = 0;
+	previous = -1;
+	samples = 0;
+	rateStart = pros::millis();
+	lastSampleUs = 0;
+	maxGapUs = 0;
+}
+
+static void store(const int16_t * value)
+{
+	if(state == ADI_SCOPE_CAPTURED) return;
+
+	uint64_t nowUs = vexSystemHighResTimeGet();
+	if(lastSampleUs != 0 && nowUs - lastSampleUs > maxGapUs) maxGapUs = nowUs - lastSampleUs;
+	lastSampleUs = nowUs;
+
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++) if(channels & (1 << i)) ring[i][head] = value[i];
+	uint32_t slot = head;
+	head = (head + 1) % ADI_SCOPE_DEPTH;
+	if(filled < ADI_SCOPE_DEPTH) filled++;
+	samples++;
+
+	int16_t watched = value[trigger.channel];
+	if(state == ADI_SCOPE_ARMED)
+	{
+		armedSamples++;
+		if(armedSamples > (uint32_t)trigger.preTrigger && fires(previous, watched))
+		{
+			state = ADI_SCOPE_TRIGGERED;
+			triggerSlot = slot;
+			triggerTime = pros::millis();
+			remaining = ADI_SCOPE_DEPTH - trigger.preTrigger - 1;
+		}
+	}
+	else if(state == ADI_SCOPE_TRIGGERED) remaining--;
+	if(state == ADI_SCOPE_TRIGGERED && remaining == 0) state = ADI_SCOPE_CAPTURED;
+	previous = watched;
+}
+
+static void scopeLoop(void * parameter)
+{
+	uint32_t wake = pros::millis();
+
+	while(true)
+	{
+		if(!running)
+		{
+			taskMonitorCountSwitch();
+			pros::delay(20);
+			wake = pros::millis();
+			continue;
+		}
+
+		{
+			PROFILE_ZONE(ZONE_ADI_SCOPE);
+
+			// The reads stay outside the lock so drawing never delays them
+			uint8_t mask = channels;
+			int16_t value[ADI_SCOPE_CHANNELS] = {};
+			for(int i = 0; i < ADI_SCOPE_CHANNELS; i++)
+			{
+				if(!(mask & (1 << i))) continue;
+				int32_t reading = pros::c::adi_analog_read(i + 1);
+				value[i] = reading == PROS_ERR ? 0 : reading;
+			}
+
+			ScopeLock lock;
+			if(running && mask == channels) store(value);
+		}
+
+		taskMonitorCountSwitch();
+		pros::c::task_delay_until(&wake, adiScopePeriod);
+	}
+}
+
+void adiScopeStart(uint8_t mask)
+{
+	if(scopeMutex == NULL) scopeMutex = pros::c::mutex_create();
+
+	{
+		ScopeLock lock;
+		if(trigger.mode != ADI_TRIGGER_FREE) mask |= 1 << trigger.channel;
+		if(mask != channels)
+		{
+			channels = mask;
+			restart();
+		}
+		else if(!running)
+		{
+			samples = 0;
+			rateStart = pros::millis();
+			lastSampleUs = 0;
+		}
+		running = true;
+	}
+
+	if(scopeTask == NULL) scopeTask = pros::c::task_create(scopeLoop, NULL, TASK_PRIORITY_DEFAULT + 2, TASK_STACK_DEPTH_DEFAULT, "ADI Scope");
+}
+
+void adiScopeStop() {running = false;}
+
+void adiScopeArm(const AdiTrigger & newTrigger)
+{
+	if(scopeMutex == NULL) scopeMutex = pros::c::mutex_create();
+
+	ScopeLock lock;
+	trigger = newTrigger;
+	if(trigger.channel < 0 || trigger.channel >= ADI_SCOPE_CHANNELS) trigger.channel = 0;
+	if(trigger.preTrigger < 0) trigger.preTrigger = 0;
+	if(trigger.preTrigger >= ADI_SCOPE_DEPTH) trigger.preTrigger = ADI_SCOPE_DEPTH - 1;
+	if(trigger.mode != ADI_TRIGGER_FREE) channels |= 1 << trigger.channel;
+	restart();
+}
+
+AdiScopeStatus adiScopeStatus()
+{
+	AdiScopeStatus status = {ADI_SCOPE_STOPPED, 0, 0, -1, 0, 0, 0};
+	if(scopeMutex == NULL) return status;
+
+	ScopeLock lock;
+	status.state = running ? state : ADI_SCOPE_STOPPED;
+	status.channels = channels;
+	status.samples = filled;
+	if(state == ADI_SCOPE_TRIGGERED || state == ADI_SCOPE_CAPTURED)
+	{
+		uint32_t oldest = (head + ADI_SCOPE_DEPTH - filled) % ADI_SCOPE_DEPTH;
+		status.triggerIndex = (triggerSlot + ADI_SCOPE_DEPTH - oldest) % ADI_SCOPE_DEPTH;
+		status.triggerTime = triggerTime;
+	}
+	status.maxGapUs = maxGapUs;
+	uint32_t elapsed = pros::millis() - rateStart;
+	status.rate = elapsed == 0 ? 0 : samples * 1000.0 / elapsed;
+	return status;
+}
+
+void adiScopeDecimate(int channel, int columns, int16_t * low, int16_t * high)
+{
+	for(int i = 0; i < columns; i++) low[i] = high[i] = -1;
+	if(scopeMutex == NULL || channel < 0 || channel >= ADI_SCOPE_CHANNELS || columns <= 0) return;
+
+	ScopeLock lock;
+	if(!(channels & (1 << channel))) return;
+
+	const int16_t * values = ring[channel];
+	uint32_t oldest = (head + ADI_SCOPE_DEPTH - filled) % ADI_SCOPE_DEPTH;
+	for(int column = 0; column < columns; column++)
+	{
+		uint32_t first = column * ADI_SCOPE_DEPTH / columns;
+		uint32_t last = (column + 1) * ADI_SCOPE_DEPTH / columns;
+		if(last > filled) last = filled;
+		if(first >= last)
+		{
+			// Bins narrower than a sample repeat the sample they fall on
+			if(first >= filled) break;
+			last = first + 1;
+		}
+
+		int16_t lowest = INT16_MAX, highest = INT16_MIN;
+		for(uint32_t i = first; i < last; i++)
+		{
+			int16_t value = values[(oldest + i) % ADI_SCOPE_DEPTH];
+			if(value < lowest) lowest = value;
+			if(value > highest) highest = value;
+		}
+		low[column] = lowest;
+		high[column] = highest;
+	}
+}
+
+std::string adiScopeReport()
+{
+	AdiScopeStatus status = adiScopeStatus();
+	if(status.channels == 0) return "";
+
+	static const char * stateName[] = {"stopped", "running", "armed", "triggered", "captured"};
+	std::string names;
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++) if(status.channels & (1 << i)) names += (char)('A' + i);
+
+	char line[112];
+	snprintf(line, sizeof(line), "ADI scope: %s, %s, %.0f Hz, max gap %lu us, %lu/%d samples\n", names.c_str(), stateName[status.state],
+		status.rate, (unsigned long)status.maxGapUs, (unsigned long)status.samples, ADI_SCOPE_DEPTH);
+	return line;
+}
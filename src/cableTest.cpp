@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cstdio>
+#include "main.h"
+#include "pros/apix.h"
+#include "vdml/registry.h"
+#include "cableTest.hpp"
+#include "testEngine.hpp"
+#include "taskMonitor.hpp"
+
+extern "C"
+{
+	void * vexDeviceGetByIndex(uint32_t index);
+	void vexDeviceGenericSerialEnable(void * device, int32_t options);
+	void vexDeviceGenericSerialDisableAll(void);
+	void vexDeviceGenericSerialBaudrate(void * device, int32_t baudrate);
+	void vexDeviceGenericSerialFlush(void * device);
+	int32_t vexDeviceGenericSerialWriteChar(void * device, uint8_t c);
+	int32_t vexDeviceGenericSerialWriteFree(void * device);
+	int32_t vexDeviceGenericSerialTransmit(void * device, uint8_t * buffer, int32_t length);
+	int32_t vexDeviceGenericSerialReadChar(void * device);
+	int32_t vexDeviceGenericSerialReceiveAvail(void * device);
+	int32_t vexDeviceGenericSerialReceive(void * device, uint8_t * buffer, int32_t length);
+	uint64_t vexSystemHighResTimeGet(void);
+}
+
+#define CABLE_CHUNK 256
+#define CABLE_SETTLE_MS 10
+#define CABLE_PING_TIMEOUT_US 20000
+#define CABLE_SPIN_US 2000
+
+const int32_t cableBaudRates[CABLE_BAUD_STEPS] = {115200, 230400, 460800, 921600};
+
+struct PairStream
+{
+	uint32_t transmit;
+	uint32_t receive;
+	uint64_t startUs;
+	bool done;
+};
+
+static pros::task_t cableTask = NULL;
+static pros::mutex_t cableMutex = NULL;
+static CableTestStatus status = {CABLE_IDLE};
+static volatile bool cancelled = false;
+
+class CableLock
+{
+public:
+	CableLock() {pros::c::mutex_take(cableMutex, TIMEOUT_MAX);}
+	~CableLock() {pros::c::mutex_give(cableMutex);}
+};
+
+static void * device(int port) {return vexDeviceGetByIndex(port);}
+
+static uint8_t xorshift(uint32_t & state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static void setPhase(CableTestPhase phase, int step)
+{
+	CableLock lock;
+	status.phase = phase;
+	status.step = step;
+	status.phaseStart = pros::millis();
+}
+
+static void discover()
+{
+	bool candidate[PORT_COUNT] = {};
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		pros::c::v5_device_e_t type = pros::c::registry_get_plugged_type(i);
+		candidate[i] = type == pros::c::E_DEVICE_NONE || type == pros::c::E_DEVICE_GENERIC;
+		if(!candidate[i]) continue;
+		vexDeviceGenericSerialEnable(device(i), 0);
+		vexDeviceGenericSerialBaudrate(device(i), cableBaudRates[0]);
+	}
+	pros::delay(CABLE_SETTLE_MS);
+
+	int pairs = 0;
+	for(int i = 0; i < PORT_COUNT && pairs < CABLE_MAX_PAIRS; i++)
+	{
+		if(!candidate[i]) continue;
+		for(int a = 0; a < PORT_COUNT; a++) if(candidate[a]) vexDeviceGenericSerialFlush(device(a));
+
+		uint8_t hello[4] = {0x5A, (uint8_t)i, (uint8_t)~i, 0xA5};
+		vexDeviceGenericSerialTransmit(device(i), hello, sizeof(hello));
+		pros::delay(CABLE_SETTLE_MS);
+
+		// The sender may hear itself on the half-duplex line, so it is never its own partner
+		for(int j = 0; j < PORT_COUNT; j++)
+		{
+			if(!candidate[j] || j == i || vexDeviceGenericSerialReceiveAvail(device(j)) < (int32_t)sizeof(hello)) continue;
+			uint8_t heard[4];
+			vexDeviceGenericSerialReceive(device(j), heard, sizeof(heard));
+			if(!std::equal(heard, heard + sizeof(heard), hello)) continue;
+
+			CableLock lock;
+			status.pair[pairs] = {(uint8_t)i, (uint8_t)j, 0};
+			status.pairCount = ++pairs;
+			candidate[i] = candidate[j] = false;
+			break;
+		}
+	}
+
+	// Hand every port back to the device registry, then take only the pairs again
+	vexDeviceGenericSerialDisableAll();
+	for(int p = 0; p < pairs; p++)
+	{
+		vexDeviceGenericSerialEnable(device(status.pair[p].from), 0);
+		vexDeviceGenericSerialEnable(device(status.pair[p].to), 0);
+	}
+}
+
+static void stream(int step)
+{
+	int32_t baud = cableBaudRates[step];
+	PairStream state[CABLE_MAX_PAIRS];
+	int count = status.pairCount;
+
+	for(int p = 0; p < count; p++)
+	{
+		const CablePair & pair = status.pair[p];
+		vexDeviceGenericSerialBaudrate(device(pair.from), baud);
+		vexDeviceGenericSerialBaudrate(device(pair.to), baud);
+	}
+	pros::delay(CABLE_SETTLE_MS);
+
+	uint64_t startUs = vexSystemHighResTimeGet();
+	for(int p = 0; p < count; p++)
+	{
+		const CablePair & pair = status.pair[p];
+		vexDeviceGenericSerialFlush(device(pair.from));
+		vexDeviceGenericSerialFlush(device(pair.to));
+		uint32_t seed = 0x9E3779B9 ^ (p * 65537 + step);
+		state[p] = {seed, seed, startUs, false};
+
+		CableLock lock;
+		status.pair[p].step[step] = {baud};
+		status.pair[p].steps = step + 1;
+	}
+
+	// Twice the time the stream needs on the wire at 10 bits a byte
+	uint64_t timeoutUs = CABLE_STREAM_BYTES * 10ULL * 1000000 / baud * 2 + 200000;
+	uint32_t wake = pros::millis();
+	int remaining = count;
+
+	while(remaining > 0 && !cancelled)
+	{
+		uint64_t nowUs = vexSystemHighResTimeGet();
+		{
+			CableLock lock;
+			for(int p = 0; p < count; p++)
+			{
+				if(state[p].done) continue;
+				CablePair & pair = status.pair[p];
+				CableStep & result = pair.step[step];
+
+				int32_t room = std::min(vexDeviceGenericSerialWriteFree(device(pair.from)), (int32_t)(CABLE_STREAM_BYTES - result.sent));
+				if(room > 0)
+				{
+					uint8_t chunk[CABLE_CHUNK];
+					int32_t length = std::min(room, (int32_t)CABLE_CHUNK);
+					for(int i = 0; i < length; i++) chunk[i] = xorshift(state[p].transmit);
+					result.sent += vexDeviceGenericSerialTransmit(device(pair.from), chunk, length);
+				}
+
+				int32_t available = vexDeviceGenericSerialReceiveAvail(device(pair.to));
+				while(available > 0)
+				{
+					uint8_t chunk[CABLE_CHUNK];
+					int32_t length = vexDeviceGenericSerialReceive(device(pair.to), chunk, std::min(available, (int32_t)CABLE_CHUNK));
+					if(length <= 0) break;
+					for(int i = 0; i < length; i++) result.bitErrors += __builtin_popcount(chunk[i] ^ xorshift(state[p].receive));
+					result.received += length;
+					available -= length;
+				}
+
+				result.elapsedUs = nowUs - state[p].startUs;
+				if(result.received >= CABLE_STREAM_BYTES || nowUs - state[p].startUs > timeoutUs)
+				{
+					result.bytesPerSecond = result.elapsedUs == 0 ? 0 : result.received * 1000000.0 / result.elapsedUs;
+					state[p].done = true;
+					remaining--;
+				}
+			}
+		}
+
+		taskMonitorCountSwitch();
+		pros::c::task_delay_until(&wake, 1);
+	}
+}
+
+/**
+ * Waits for a byte on port, skipping anything but expected. Polls without
+ * sleeping for CABLE_SPIN_US so a round trip keeps microsecond resolution,
+ * then sleeps between polls so a lost byte doesn't starve the engine.
+ */
+static bool await(int port, uint8_t expected, uint64_t deadlineUs)
+{
+	uint64_t spinUntilUs = vexSystemHighResTimeGet() + CABLE_SPIN_US;
+	while(vexSystemHighResTimeGet() < deadlineUs && !cancelled)
+	{
+		if(vexDeviceGenericSerialReceiveAvail(device(port)) > 0 && vexDeviceGenericSerialReadChar(device(port)) == expected) return true;
+		if(vexSystemHighResTimeGet() >= spinUntilUs) pros::c::task_delay(1);
+	}
+	return false;
+}
+
+static void ping(int step)
+{
+	for(int p = 0; p < status.pairCount && !cancelled; p++)
+	{
+		CablePair pair = status.pair[p];
+		uint32_t rtt[CABLE_PINGS];
+		int pings = 0;
+
+		for(int k = 0; k < CABLE_PINGS; k++)
+		{
+			vexDeviceGenericSerialFlush(device(pair.from));
+			vexDeviceGenericSerialFlush(device(pair.to));
+
+			// The echo is a different byte so neither end mistakes its own transmission for it
+			uint8_t out = k, back = ~k;
+			uint64_t startUs = vexSystemHighResTimeGet();
+			uint64_t deadlineUs = startUs + CABLE_PING_TIMEOUT_US;
+			vexDeviceGenericSerialWriteChar(device(pair.from), out);
+			if(!await(pair.to, out, deadlineUs)) continue;
+			vexDeviceGenericSerialWriteChar(device(pair.to), back);
+			if(!await(pair.from, back, deadlineUs)) continue;
+			rtt[pings++] = vexSystemHighResTimeGet() - startUs;
+		}
+
+		std::sort(rtt, rtt + pings);
+		CableLock lock;
+		CableStep & result = status.pair[p].step[step];
+		result.pings = pings;
+		result.rttUs = pings == 0 ? 0 : rtt[pings / 2];
+		result.maxRttUs = pings == 0 ? 0 : rtt[pings - 1];
+		taskMonitorCountSwitch();
+		pros::delay(1);
+	}
+}
+
+static void cableLoop(void * parameter)
+{
+	while(true)
+	{
+		if(status.phase != CABLE_DISCOVERING)
+		{
+			taskMonitorCountSwitch();
+			pros::delay(20);
+			continue;
+		}
+
+		discover();
+		for(int step = 0; step < CABLE_BAUD_STEPS && status.pairCount > 0 && !cancelled; step++)
+		{
+			setPhase(CABLE_STREAMING, step);
+			stream(step);
+			setPhase(CABLE_PINGING, step);
+			ping(step);
+		}
+
+		// Left in serial mode, a port wouldn't show a motor plugged into it later
+		vexDeviceGenericSerialDisableAll();
+		setPhase(CABLE_DONE, 0);
+	}
+}
+
+void cableTestStart()
+{
+	if(cableMutex == NULL) cableMutex = pros::c::mutex_create();
+
+	{
+		CableLock lock;
+		if(status.phase != CABLE_IDLE && status.phase != CABLE_DONE) return;
+		status = {CABLE_DISCOVERING, 0, pros::millis(), 0};
+		cancelled = false;
+	}
+
+	if(cableTask == NULL) cableTask = pros::c::task_create(cableLoop, NULL, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "Cable Test");
+}
+
+void cableTestStop()
+{
+	if(status.phase != CABLE_IDLE && status.phase != CABLE_DONE) cancelled = true;
+}
+
+CableTestStatus cableTestStatus()
+{
+	if(cableMutex == NULL) return status;
+	CableLock lock;
+	return status;
+}
+
+static bool passed(const CableStep & step) {return step.received == CABLE_STREAM_BYTES && step.bitErrors == 0;}
+
+int32_t cableRating(const CablePair & pair)
+{
+	int32_t rating = 0;
+	for(int i = 0; i < pair.steps && passed(pair.step[i]); i++) rating = pair.step[i].baud;
+	return rating;
+}
+
+std::string cableTestReport()
+{
+	static const char * phaseName[] = {"idle", "discovering", "streaming", "pinging", "done"};
+
+	CableTestStatus copy = cableTestStatus();
+	char line[128];
+	snprintf(line, sizeof(line), "Cables: %s", phaseName[copy.phase]);
+	std::string a = line;
+	if(copy.phase == CABLE_STREAMING || copy.phase == CABLE_PINGING) a += " at " + std::to_string(cableBaudRates[copy.step]) + " baud";
+	a += ", " + std::to_string(copy.pairCount) + " pairs\n";
+
+	for(int p = 0; p < copy.pairCount; p++)
+	{
+		const CablePair & pair = copy.pair[p];
+		int32_t rating = cableRating(pair);
+		snprintf(line, sizeof(line), "%d-%d: %s", pair.from + 1, pair.to + 1, rating == 0 ? "#ff0000 FAIL#" : rating == cableBaudRates[CABLE_BAUD_STEPS - 1] ? "#008000 PASS#" : "#ffa500 LIMITED#");
+		a += line;
+		for(int i = 0; i < pair.steps; i++)
+		{
+			const CableStep & step = pair.step[i];
+			snprintf(line, sizeof(line), "  %ldk %.0f%% %lu err %lu lost %lu us", (long)(step.baud / 1000), step.bytesPerSecond * 1000 / step.baud,
+				(unsigned long)step.bitErrors, (unsigned long)(step.sent - step.received), (unsigned long)step.rttUs);
+			a += line;
+		}
+		a += "\n";
+	}
+	return a;
+}
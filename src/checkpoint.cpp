@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include "checkpoint.hpp"
+#include "profiler.hpp"
+#include "testEngine.hpp"
+
+#define CHECKPOINT_MAGIC 0x4B43544D
+#define CHECKPOINT_VERSION 2
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+struct __attribute__((packed)) CheckpointPort
+{
+	uint8_t state;
+	uint8_t flags;
+	uint8_t resultCount;
+	uint8_t reserved;
+	int16_t coastTime;
+	int16_t breakTime;
+	float averageScore;
+	float settleSpeed[CHECKPOINT_MAX_RESULTS];
+	int16_t settleCurrent[CHECKPOINT_MAX_RESULTS];
+	uint32_t faults[CHECKPOINT_MAX_RESULTS];
+};
+
+struct __attribute__((packed)) CheckpointData
+{
+	float sumSettleSpeed[testPointCount];
+	int32_t sumSettleCurrent[testPointCount];
+	int32_t resultCount[testPointCount];
+	int32_t coastTimeResultSum;
+	int32_t breakTimeResultSum;
+	int32_t totalResultCount;
+	CheckpointPort port[PORT_COUNT];
+};
+
+struct __attribute__((packed)) CheckpointHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;
+	uint32_t sequence;
+	uint32_t savedAt;
+	uint32_t crc;
+};
+
+enum CheckpointFlag
+{
+	FLAG_TIMED_OUT = 1,
+	FLAG_MOTOR_WORKING = 2,
+	FLAG_CURRENT_WORKING = 4,
+	FLAG_BREAK_MODE_WORKING = 8,
+	FLAG_ENCODER_ERROR = 16 // Set on error so checkpoints from before the encoder check restore as working
+};
+
+static const char * slotFile[2] = {"/usd/ckpt_a.bin", "/usd/ckpt_b.bin"};
+
+static CheckpointData lastSaved;
+static bool haveLastSaved = false;
+static int nextSlot = 0;
+static uint32_t lastSave = 0;
+static CheckpointStats stats = {};
+
+static uint32_t crc32(const void * data, size_t length)
+{
+	const uint8_t * bytes = (const uint8_t *)data;
+	uint32_t crc = 0xFFFFFFFF;
+
+	for(size_t i = 0; i < length; i++)
+	{
+		crc ^= bytes[i];
+		for(int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+static bool readSlot(int slot, CheckpointHeader & header, CheckpointData & data)
+{
+	FILE * file = fopen(slotFile[slot], "rb");
+	if(file == NULL) return false;
+
+	bool ok = fread(&header, sizeof(header), 1, file) == 1 && fread(&data, sizeof(data), 1, file) == 1;
+	fclose(file);
+
+	return ok && header.magic == CHECKPOINT_MAGIC && header.version == CHECKPOINT_VERSION
+		&& header.size == sizeof(CheckpointData) && header.crc == crc32(&data, sizeof(data));
+}
+
+// Caller holds EngineLock
+static void capture(CheckpointData & data)
+{
+	memset(&data, 0, sizeof(data));
+
+	for(int i = 0; i < testPointCount; i++)
+	{
+		data.sumSettleSpeed[i] = testResultSum[i].settleSpeed;
+		data.sumSettleCurrent[i] = testResultSum[i].settleCurrent;
+		data.resultCount[i] = testResultCount[i];
+	}
+	data.coastTimeResultSum = coastTimeResultSum;
+	data.breakTimeResultSum = breakTimeResultSum;
+	data.totalResultCount = totalResultCount;
+
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		const PortData & source = portData[i];
+		CheckpointPort & port = data.port[i];
+		if(source.state < 100) continue;
+
+		port.state = source.state;
+		port.flags = (source.timedOut ? FLAG_TIMED_OUT : 0) | (source.motorWorking ? FLAG_MOTOR_WORKING : 0)
+			| (source.currentWorking ? FLAG_CURRENT_WORKING : 0) | (source.breakModeWorking ? FLAG_BREAK_MODE_WORKING : 0)
+			| (source.encoderWorking ? 0 : FLAG_ENCODER_ERROR);
+		port.resultCount = std::min((int)source.results.size(), CHECKPOINT_MAX_RESULTS);
+		port.coastTime = source.coastTime;
+		port.breakTime = source.breakTime;
+		port.averageScore = source.averageScore;
+
+		for(int a = 0; a < port.resultCount; a++)
+		{
+			port.settleSpeed[a] = source.results[a].settleSpeed;
+			port.settleCurrent[a] = source.results[a].settleCurrent;
+			port.faults[a] = source.results[a].faults;
+		}
+	}
+}
+
+bool checkpointLoad()
+{
+	CheckpointHeader header[2];
+	static CheckpointData data[2];
+	bool valid[2] = {readSlot(0, header[0], data[0]), readSlot(1, header[1], data[1])};
+
+	if(!valid[0] && !valid[1]) return false;
+
+	int slot = !valid[0] || (valid[1] && header[1].sequence > header[0].sequence) ? 1 : 0;
+	const CheckpointData & saved = data[slot];
+
+	EngineLock lock;
+
+	for(int i = 0; i < testPointCount; i++)
+	{
+		testResultSum[i].settleSpeed = saved.sumSettleSpeed[i];
+		testResultSum[i].settleCurrent = saved.sumSettleCurrent[i];
+		testResultCount[i] = saved.resultCount[i];
+	}
+	coastTimeResultSum = saved.coastTimeResultSum;
+	breakTimeResultSum = saved.breakTimeResultSum;
+	totalResultCount = saved.totalResultCount;
+
+	stats.restoredPorts = 0;
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		const CheckpointPort & port = saved.port[i];
+		PortData & target = portData[i];
+		if(port.state < 100) continue;
+
+		target.state = port.state;
+		target.device = pros::c::E_DEVICE_MOTOR;
+		target.timedOut = port.flags & FLAG_TIMED_OUT;
+		target.motorWorking = port.flags & FLAG_MOTOR_WORKING;
+		target.currentWorking = port.flags & FLAG_CURRENT_WORKING;
+		target.breakModeWorking = port.flags & FLAG_BREAK_MODE_WORKING;
+		target.encoderWorking = !(port.flags & FLAG_ENCODER_ERROR);
+		target.coastTime = port.coastTime;
+		target.breakTime = port.breakTime;
+		target.averageScore = port.averageScore;
+		target.results.clear();
+		for(int a = 0; a < port.resultCount && a < CHECKPOINT_MAX_RESULTS; a++) target.results.push_back({port.settleSpeed[a], port.settleCurrent[a], port.faults[a]});
+		target.revision++;
+		stats.restoredPorts++;
+	}
+
+	lastSaved = saved;
+	haveLastSaved = true;
+	nextSlot = 1 - slot;
+	stats.sequence = header[slot].sequence;
+	stats.bytes = sizeof(CheckpointHeader) + sizeof(CheckpointData);
+
+	printf("CKPT restored seq=%lu ports=%lu results=%ld\n", (unsigned long)stats.sequence, (unsigned long)stats.restoredPorts, (long)totalResultCount);
+	return true;
+}
+
+bool checkpointSave(uint32_t now, uint32_t interval)
+{
+	if(now - lastSave < interval) return false;
+	lastSave = now;
+
+	static CheckpointData data;
+	{
+		EngineLock lock;
+		capture(data);
+	}
+	if(haveLastSaved && memcmp(&data, &lastSaved, sizeof(data)) == 0) return false;
+
+	PROFILE_ZONE(ZONE_CHECKPOINT);
+	uint64_t start = vexSystemHighResTimeGet();
+
+	CheckpointHeader header = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, sizeof(CheckpointData), stats.sequence + 1, now, crc32(&data, sizeof(data))};
+
+	FILE * file = fopen(slotFile[nextSlot], "wb");
+	if(file == NULL) return false;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&data, sizeof(data), 1, file) == 1;
+	ok = fclose(file) == 0 && ok;
+	if(!ok) return false;
+
+	uint32_t elapsed = vexSystemHighResTimeGet() - start;
+
+	lastSaved = data;
+	haveLastSaved = true;
+	nextSlot = 1 - nextSlot;
+	stats.sequence = header.sequence;
+	stats.bytes = sizeof(header) + sizeof(data);
+	stats.saves++;
+	stats.lastUs = elapsed;
+	if(elapsed > stats.maxUs) stats.maxUs = elapsed;
+
+	return true;
+}
+
+const CheckpointStats & checkpointStats() {return stats;}
+
+std::string checkpointReport()
+{
+	char line[112];
+	snprintf(line, sizeof(line), "Checkpoint: seq %lu, %lu B, %lu saves, last %lu us, max %lu us, restored %lu\n", (unsigned long)stats.sequence,
+		(unsigned long)stats.bytes, (unsigned long)stats.saves, (unsigned long)stats.lastUs, (unsigned long)stats.maxUs, (unsigned long)stats.restoredPorts);
+	return line;
+}
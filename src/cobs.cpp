@@ -0,0 +1,23 @@
+#include "rpc.hpp"
+
+// libpros only ships the encoder (common/cobs.h), so decoding lives here
+int cobsDecode(uint8_t * dest, const uint8_t * src, size_t length)
+{
+	size_t read = 0;
+	size_t written = 0;
+
+	while(read < length)
+	{
+		uint8_t code = src[read++];
+		if(code == 0 || read + code - 1 > length) return -1;
+
+		for(int i = 1; i < code; i++)
+		{
+			if(src[read] == 0) return -1;
+			dest[written++] = src[read++];
+		}
+		if(code != 0xFF && read < length) dest[written++] = 0;
+	}
+
+	return written;
+}
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "main.h"
+#include "controllerLatency.hpp"
+#include "taskMonitor.hpp"
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+// The controller drops screen updates sent closer together than this
+#define CONTROLLER_PRINT_GAP_MS 50
+#define RTT_TIMEOUT_MS 5000
+
+enum PromptState {PROMPT_WAIT, PROMPT_SHOWN};
+
+struct ControllerProbe
+{
+	bool haveInput;
+	uint16_t buttons;
+	int8_t sticks[4];
+	uint64_t lastChangeUs;
+
+	PromptState prompt;
+	uint32_t nextPrompt;
+	uint64_t promptUs;
+	bool aHeld;
+};
+
+static pros::task_t latencyTask = NULL;
+static pros::mutex_t latencyMutex = NULL;
+static volatile bool running = false;
+static ControllerLatency latency[CONTROLLER_COUNT];
+static ControllerProbe probe[CONTROLLER_COUNT];
+
+static const pros::controller_id_e_t controllerId[CONTROLLER_COUNT] = {pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_PARTNER};
+
+class LatencyLock
+{
+public:
+	LatencyLock() {pros::c::mutex_take(latencyMutex, TIMEOUT_MAX);}
+	~LatencyLock() {pros::c::mutex_give(latencyMutex);}
+};
+
+double controllerHistogramPercentile(const uint32_t * bins, int count, double binWidth, double fraction)
+{
+	uint32_t total = 0;
+	for(int i = 0; i < count; i++) total += bins[i];
+	if(total == 0) return 0;
+
+	uint32_t target = ceil(total * fraction);
+	uint32_t seen = 0;
+	for(int i = 0; i < count; i++)
+	{
+		seen += bins[i];
+		if(seen >= target) return (i + 1) * binWidth;
+	}
+	return count * binWidth;
+}
+
+void controllerHistogramPeriod(const uint32_t * bins, int count, double & periodMs, double & jitterMs)
+{
+	int mode = 0;
+	for(int i = 1; i < count - 1; i++) if(bins[i] > bins[mode]) mode = i;
+	if(bins[mode] == 0) return;
+
+	int first = std::max(0, mode - (mode + 1) / 2), last = std::min(count - 2, mode + (mode + 1) / 2);
+	double total = 0, sum = 0, sumSquares = 0;
+	for(int i = first; i <= last; i++)
+	{
+		double ms = i + 0.5;
+		total += bins[i];
+		sum += bins[i] * ms;
+		sumSquares += bins[i] * ms * ms;
+	}
+
+	periodMs = sum / total;
+	jitterMs = sqrt(fmax(0, sumSquares / total - periodMs * periodMs));
+}
+
+static void estimatePeriod(ControllerLatency & c)
+{
+	controllerHistogramPeriod(c.interval, CONTROLLER_INTERVAL_BINS, c.periodMs, c.jitterMs);
+	if(c.periodMs > 0) c.rate = 1000.0 / c.periodMs;
+}
+
+static void timeCall(ControllerLatency & c, int32_t result, uint64_t startUs)
+{
+	uint32_t us = vexSystemHighResTimeGet() - startUs;
+	c.callUs = us;
+	if(us > c.maxCallUs) c.maxCallUs = us;
+	if(result == PROS_ERR) c.rejected++;
+}
+
+static void poll(int i, uint32_t now)
+{
+	pros::controller_id_e_t id = controllerId[i];
+	ControllerLatency & c = latency[i];
+	ControllerProbe & p = probe[i];
+
+	c.connected = pros::c::controller_is_connected(id);
+	if(!c.connected)
+	{
+		p.haveInput = false;
+		return;
+	}
+
+	uint16_t buttons = 0;
+	for(int b = pros::E_CONTROLLER_DIGITAL_L1; b <= pros::E_CONTROLLER_DIGITAL_A; b++)
+		if(pros::c::controller_get_digital(id, (pros::controller_digital_e_t)b)) buttons |= 1 << (b - pros::E_CONTROLLER_DIGITAL_L1);
+	int8_t sticks[4];
+	for(int a = 0; a < 4; a++) sticks[a] = pros::c::controller_get_analog(id, (pros::controller_analog_e_t)a);
+
+	uint64_t nowUs = vexSystemHighResTimeGet();
+	if(p.haveInput && (buttons != p.buttons || memcmp(sticks, p.sticks, sizeof(sticks)) != 0))
+	{
+		uint32_t ms = (nowUs - p.lastChangeUs) / 1000;
+		c.interval[std::min(ms, (uint32_t)CONTROLLER_INTERVAL_BINS - 1)]++;
+		c.intervalCount++;
+		c.changes++;
+		p.lastChangeUs = nowUs;
+		estimatePeriod(c);
+	}
+	if(!p.haveInput) p.lastChangeUs = nowUs;
+	p.haveInput = true;
+	p.buttons = buttons;
+	memcpy(p.sticks, sticks, sizeof(sticks));
+
+	bool a = buttons & (1 << (pros::E_CONTROLLER_DIGITAL_A - pros::E_CONTROLLER_DIGITAL_L1));
+	bool pressed = a && !p.aHeld;
+	p.aHeld = a;
+
+	if(p.prompt == PROMPT_WAIT && (int32_t)(now - p.nextPrompt) >= 0)
+	{
+		uint64_t start = vexSystemHighResTimeGet();
+		int32_t result = pros::c::controller_print(id, 0, 0, "Press A       ");
+		timeCall(c, result, start);
+		if(result == PROS_ERR)
+		{
+			p.nextPrompt = now + CONTROLLER_PRINT_GAP_MS;
+			return;
+		}
+
+		start = vexSystemHighResTimeGet();
+		timeCall(c, pros::c::controller_rumble(id, "."), start);
+		p.prompt = PROMPT_SHOWN;
+		p.promptUs = start;
+	}
+	else if(p.prompt == PROMPT_SHOWN && pressed)
+	{
+		uint32_t ms = (nowUs - p.promptUs) / 1000;
+		c.rtt[std::min(ms / CONTROLLER_RTT_BIN_MS, (uint32_t)CONTROLLER_RTT_BINS - 1)]++;
+		c.rttCount++;
+		c.lastRttMs = ms;
+
+		p.prompt = PROMPT_WAIT;
+		p.nextPrompt = now + 1000 + rand() % 2000;
+	}
+	else if(p.prompt == PROMPT_SHOWN && nowUs - p.promptUs > RTT_TIMEOUT_MS * 1000ULL)
+	{
+		p.prompt = PROMPT_WAIT;
+		p.nextPrompt = now;
+	}
+}
+
+static void latencyLoop(void * parameter)
+{
+	uint32_t wake = pros::millis();
+
+	while(true)
+	{
+		if(!running)
+		{
+			taskMonitorCountSwitch();
+			pros::delay(20);
+			wake = pros::millis();
+			continue;
+		}
+
+		{
+			uint32_t now = pros::millis();
+			LatencyLock lock;
+			for(int i = 0; i < CONTROLLER_COUNT; i++) poll(i, now);
+		}
+
+		taskMonitorCountSwitch();
+		pros::c::task_delay_until(&wake, 1);
+	}
+}
+
+void controllerLatencyStart()
+{
+	if(latencyMutex == NULL) latencyMutex = pros::c::mutex_create();
+	if(!running)
+	{
+		LatencyLock lock;
+		for(int i = 0; i < CONTROLLER_COUNT; i++)
+		{
+			probe[i].haveInput = false;
+			probe[i].prompt = PROMPT_WAIT;
+			probe[i].nextPrompt = pros::millis() + 1000;
+		}
+	}
+	running = true;
+	if(latencyTask == NULL) latencyTask = pros::c::task_create(latencyLoop, NULL, TASK_PRIORITY_DEFAULT + 2, TASK_STACK_DEPTH_DEFAULT, "Ctrl Latency");
+}
+
+void controllerLatencyStop() {running = false;}
+
+void controllerLatencyReset()
+{
+	if(latencyMutex == NULL) return;
+	LatencyLock lock;
+	for(int i = 0; i < CONTROLLER_COUNT; i++)
+	{
+		latency[i] = ControllerLatency();
+		probe[i].haveInput = false;
+	}
+}
+
+ControllerLatency controllerLatencyGet(int controller)
+{
+	if(latencyMutex == NULL) return latency[controller];
+	LatencyLock lock;
+	return latency[controller];
+}
+
+std::string controllerLatencyReport()
+{
+	std::string a;
+	for(int i = 0; i < CONTROLLER_COUNT; i++)
+	{
+		ControllerLatency c = controllerLatencyGet(i);
+		char line[160];
+		snprintf(line, sizeof(line), "%s: %s\n%.1f ms, %.0f Hz, jitter %.2f\ngap p50 %.0f p99 %.0f, n %lu\nRTT p50 %.0f p90 %.0f, n %lu\ncall %lu/%lu us, refused %lu\n",
+			i == 0 ? "Master" : "Partner", c.connected ? "connected" : "not connected", c.periodMs, c.rate, c.jitterMs,
+			controllerHistogramPercentile(c.interval, CONTROLLER_INTERVAL_BINS, 1, 0.5), controllerHistogramPercentile(c.interval, CONTROLLER_INTERVAL_BINS, 1, 0.99),
+			(unsigned long)c.changes, controllerHistogramPercentile(c.rtt, CONTROLLER_RTT_BINS, CONTROLLER_RTT_BIN_MS, 0.5),
+			controllerHistogramPercentile(c.rtt, CONTROLLER_RTT_BINS, CONTROLLER_RTT_BIN_MS, 0.9), (unsigned long)c.rttCount,
+			(unsigned long)c.callUs, (unsigned long)c.maxCallUs, (unsigned long)c.rejected);
+		a += line;
+	}
+	return a;
+}
@@ -1,6 +1,18 @@
 #include "main.h"
+#include "profiler.hpp"
+#include "styleCache.hpp"
+#include "testEngine.hpp"
+#include "ui.hpp"
+#include "rpc.hpp"
 
-void initialize() {}
+void initialize()
+{
+	profilerInit();
+	styleInit();
+	engineStart();
+	uiAttach();
+	rpcStart();
+}
 
 void disabled() {}
 
@@ -0,0 +1,256 @@
+#include <cstring>
+#include "lzBlock.hpp"
+
+static inline uint32_t read32(const uint8_t * p)
+{
+	uint32_t value;
+	memcpy(&value, p, 4);
+	return value;
+}
+
+static inline uint32_t hash(uint32_t value) {return (value * 2654435761u) >> (32 - LZ_HASH_BITS);}
+
+// Writes the 15-and-over part of a length as 255-runs
+static inline uint8_t * putLength(uint8_t * out, size_t length)
+{
+	for(length -= 15; length >= 255; length -= 255) *out++ = 255;
+	*out++ = length;
+	return out;
+}
+
+static bool emit(uint8_t *& out, const uint8_t * outEnd, const uint8_t * literal, size_t literals, size_t offset, size_t match)
+{
+	// Worst case: token, both length runs, literals, offset
+	if((size_t)(outEnd - out) < 1 + literals / 255 + 1 + literals + 2 + match / 255 + 1) return false;
+
+	uint8_t * token = out++;
+	*token = (literals < 15 ? literals : 15) << 4;
+	if(literals >= 15) out = putLength(out, literals);
+	memcpy(out, literal, literals);
+	out += literals;
+
+	if(match == 0) return true;
+
+	*out++ = offset;
+	*out++ = offset >> 8;
+	match -= LZ_MIN_MATCH;
+	*token |= match < 15 ? match : 15;
+	if(match >= 15) out = putLength(out, match);
+	return true;
+}
+
+int lzCompress(LzWork & work, const uint8_t * src, size_t length, uint8_t * dst, size_t capacity)
+{
+	if(length > LZ_BLOCK_SIZE) return -1;
+
+	uint8_t * out = dst;
+	const uint8_t * outEnd = dst + capacity;
+	size_t anchor = 0;
+	size_t position = 0;
+
+	memset(work.table, 0, sizeof(work.table));
+
+	while(position + LZ_MIN_MATCH <= length)
+	{
+		uint32_t value = read32(src + position);
+		uint16_t & slot = work.table[hash(value)];
+		size_t candidate = slot;
+		slot = position;
+
+		// An empty slot reads as position 0; comparing the bytes rules that out too
+		if(candidate >= position || read32(src + candidate) != value)
+		{
+			// Step faster through data that keeps missing
+			position += 1 + ((position - anchor) >> 6);
+			continue;
+		}
+
+		size_t match = LZ_MIN_MATCH;
+		while(position + match < length && src[candidate + match] == src[position + match]) match++;
+
+		if(!emit(out, outEnd, src + anchor, position - anchor, position - candidate, match)) return -1;
+		position += match;
+		anchor = position;
+	}
+
+	if(!emit(out, outEnd, src + anchor, length - anchor, 0, 0)) return -1;
+	return out - dst;
+}
+
+int lzDecompress(const uint8_t * src, size_t length, uint8_t * dst, size_t capacity)
+{
+	const uint8_t * in = src;
+	const uint8_t * end = src + length;
+	size_t written = 0;
+
+	while(in < end)
+	{
+		uint8_t token = *in++;
+
+		size_t literals = token >> 4;
+		if(literals == 15)
+		{
+			uint8_t extra;
+			do
+			{
+				if(in >= end) return -1;
+				extra = *in++;
+				literals += extra;
+			} while(extra == 255);
+		}
+		if((size_t)(end - in) < literals || capacity - written < literals) return -1;
+		memcpy(dst + written, in, literals);
+		in += literals;
+		written += literals;
+
+		if(in == end) break;
+
+		if(end - in < 2) return -1;
+		size_t offset = in[0] | in[1] << 8;
+		in += 2;
+
+		size_t match = (token & 15) + LZ_MIN_MATCH;
+		if((token & 15) == 15)
+		{
+			uint8_t extra;
+			do
+			{
+				if(in >= end) return -1;
+				extra = *in++;
+				match += extra;
+			} while(extra == 255);
+		}
+		if(offset == 0 || offset > written || capacity - written < match) return -1;
+
+		// Byte by byte: a match may overlap the bytes it is producing
+		for(size_t i = 0; i < match; i++, written++) dst[written] = dst[written - offset];
+	}
+
+	return written;
+}
+
+bool LzStreamDecoder::feed(const uint8_t * data, size_t length)
+{
+	const uint8_t * in = data;
+	const uint8_t * end = data + length;
+
+	while(in < end && state != STATE_ERROR)
+	{
+		switch(state)
+		{
+		case STATE_HEADER:
+			headerBytes[headerFill++] = *in++;
+			if(headerFill < sizeof(header)) break;
+			memcpy(&header, headerBytes, sizeof(header));
+			headerFill = 0;
+			fill = 0;
+			stored = 0;
+			if(header.rawLength > LZ_BLOCK_SIZE || header.storedLength > LZ_COMPRESS_BOUND((size_t)header.rawLength)) state = STATE_ERROR;
+			else if(header.storedLength == header.rawLength) state = STATE_STORED;
+			else state = STATE_TOKEN;
+			if(header.storedLength == 0 && !endBlock()) state = STATE_ERROR;
+			break;
+
+		case STATE_STORED:
+		{
+			size_t take = header.storedLength - stored;
+			if(take > (size_t)(end - in)) take = end - in;
+			memcpy(window + fill, in, take);
+			in += take;
+			fill += take;
+			stored += take;
+			if(stored == header.storedLength && !endBlock()) state = STATE_ERROR;
+			break;
+		}
+
+		case STATE_TOKEN:
+		{
+			uint8_t token = *in++;
+			stored++;
+			literals = token >> 4;
+			match = (token & 15) + LZ_MIN_MATCH;
+			state = literals == 15 ? STATE_LITERAL_LENGTH : STATE_LITERALS;
+			if(state == STATE_LITERALS && literals == 0)
+			{
+				// No literals: the offset follows, unless the block just ended
+				if(stored == header.storedLength) state = endBlock() ? STATE_HEADER : STATE_ERROR;
+				else state = STATE_OFFSET;
+			}
+			break;
+		}
+
+		case STATE_LITERAL_LENGTH:
+		{
+			uint8_t extra = *in++;
+			stored++;
+			literals += extra;
+			if(extra != 255) state = STATE_LITERALS;
+			break;
+		}
+
+		case STATE_LITERALS:
+		{
+			size_t take = literals;
+			if(take > (size_t)(end - in)) take = end - in;
+			if(take > header.storedLength - stored || fill + take > header.rawLength)
+			{
+				state = STATE_ERROR;
+				break;
+			}
+			memcpy(window + fill, in, take);
+			in += take;
+			fill += take;
+			stored += take;
+			literals -= take;
+			if(literals > 0) break;
+			if(stored == header.storedLength) state = endBlock() ? STATE_HEADER : STATE_ERROR;
+			else state = STATE_OFFSET;
+			offsetFill = 0;
+			offset = 0;
+			break;
+		}
+
+		case STATE_OFFSET:
+			offset |= *in++ << (8 * offsetFill++);
+			stored++;
+			if(offsetFill < 2) break;
+			offsetFill = 0;
+			if(match == 15 + LZ_MIN_MATCH) state = STATE_MATCH_LENGTH;
+			else state = copyMatch() ? STATE_TOKEN : STATE_ERROR;
+			break;
+
+		case STATE_MATCH_LENGTH:
+		{
+			uint8_t extra = *in++;
+			stored++;
+			match += extra;
+			if(extra != 255) state = copyMatch() ? STATE_TOKEN : STATE_ERROR;
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		if(state == STATE_TOKEN && stored > header.storedLength) state = STATE_ERROR;
+	}
+
+	return state != STATE_ERROR;
+}
+
+bool LzStreamDecoder::copyMatch()
+{
+	if(offset == 0 || offset > fill || fill + match > header.rawLength || stored >= header.storedLength) return false;
+	for(size_t i = 0; i < match; i++, fill++) window[fill] = window[fill - offset];
+	offset = 0;
+	return true;
+}
+
+bool LzStreamDecoder::endBlock()
+{
+	if(fill != header.rawLength) return false;
+	sink(context, window, fill);
+	raw += fill;
+	state = STATE_HEADER;
+	return true;
+}
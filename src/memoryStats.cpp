@@ -0,0 +1,253 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include <unistd.h>
+#include "memoryStats.hpp"
+
+#define MEM_HISTORY_LENGTH 90
+
+static MemCounter subsystemCounter[MEM_SUBSYSTEM_COUNT] = {};
+static MemCounter heapCounter[HEAP_COUNT] = {};
+static const char * subsystemName[MEM_SUBSYSTEM_COUNT] = {"Styles", "Graph", "Widgets", "PortData"};
+static const char * heapName[HEAP_COUNT] = {"malloc", "new", "LVGL"};
+
+static MemSnapshot history[MEM_HISTORY_LENGTH];
+static int historyCount = 0;
+static int historyNext = 0;
+static uint32_t lowestLargestFree = UINT32_MAX;
+static uint32_t lastSample = 0;
+
+void memCount(MemCounter & counter, int32_t delta)
+{
+	int32_t bytes = __atomic_add_fetch(&counter.bytes, delta, __ATOMIC_RELAXED);
+	if(delta >= 0)
+	{
+		__atomic_add_fetch(&counter.allocs, 1, __ATOMIC_RELAXED);
+		if(bytes > counter.peak) counter.peak = bytes;
+	}
+	else __atomic_add_fetch(&counter.frees, 1, __ATOMIC_RELAXED);
+}
+
+MemCounter & memSubsystemCounter(MemSubsystem subsystem) {return subsystemCounter[subsystem];}
+
+const MemCounter & memHeapCounter(MemHeap heap) {return heapCounter[heap];}
+
+size_t memBlockSize(void * pointer) {return pointer == NULL ? 0 : malloc_usable_size(pointer);}
+
+void * memAlloc(MemSubsystem subsystem, size_t size)
+{
+	void * pointer = std::malloc(size);
+	memCount(subsystemCounter[subsystem], memBlockSize(pointer));
+	return pointer;
+}
+
+void * memRealloc(MemSubsystem subsystem, void * pointer, size_t size)
+{
+	size_t oldSize = memBlockSize(pointer);
+	void * newPointer = std::realloc(pointer, size);
+	if(newPointer != NULL || size == 0) memCount(subsystemCounter[subsystem], (int32_t)memBlockSize(newPointer) - (int32_t)oldSize);
+	return newPointer;
+}
+
+void memFree(MemSubsystem subsystem, void * pointer)
+{
+	if(pointer == NULL) return;
+	memCount(subsystemCounter[subsystem], -(int32_t)memBlockSize(pointer));
+	std::free(pointer);
+}
+
+#if defined(__arm__)
+extern "C"
+{
+	extern char _heap_end;
+	size_t xPortGetFreeHeapSize(void);
+
+	void * __real_malloc(size_t size);
+	void __real_free(void * pointer);
+	void * __real_realloc(void * pointer, size_t size);
+	void * __real_calloc(size_t count, size_t size);
+
+	void * __real_lv_mem_alloc(uint32_t size);
+	void __real_lv_mem_free(const void * data);
+	void * __real_lv_mem_realloc(void * data, uint32_t size);
+	uint32_t lv_mem_get_size(const void * data);
+
+	void * __wrap_malloc(size_t size)
+	{
+		void * pointer = __real_malloc(size);
+		if(pointer != NULL) memCount(heapCounter[HEAP_MALLOC], malloc_usable_size(pointer));
+		return pointer;
+	}
+
+	void __wrap_free(void * pointer)
+	{
+		if(pointer == NULL) return;
+		memCount(heapCounter[HEAP_MALLOC], -(int32_t)malloc_usable_size(pointer));
+		__real_free(pointer);
+	}
+
+	void * __wrap_realloc(void * pointer, size_t size)
+	{
+		size_t oldSize = memBlockSize(pointer);
+		void * newPointer = __real_realloc(pointer, size);
+		if(newPointer != NULL || size == 0) memCount(heapCounter[HEAP_MALLOC], (int32_t)memBlockSize(newPointer) - (int32_t)oldSize);
+		return newPointer;
+	}
+
+	void * __wrap_calloc(size_t count, size_t size)
+	{
+		void * pointer = __real_calloc(count, size);
+		if(pointer != NULL) memCount(heapCounter[HEAP_MALLOC], malloc_usable_size(pointer));
+		return pointer;
+	}
+
+	void * __wrap_lv_mem_alloc(uint32_t size)
+	{
+		void * pointer = __real_lv_mem_alloc(size);
+		if(pointer != NULL) memCount(heapCounter[HEAP_LVGL], lv_mem_get_size(pointer));
+		return pointer;
+	}
+
+	void __wrap_lv_mem_free(const void * data)
+	{
+		if(data == NULL) return;
+		memCount(heapCounter[HEAP_LVGL], -(int32_t)lv_mem_get_size(data));
+		__real_lv_mem_free(data);
+	}
+
+	void * __wrap_lv_mem_realloc(void * data, uint32_t size)
+	{
+		uint32_t oldSize = data == NULL ? 0 : lv_mem_get_size(data);
+		void * newData = __real_lv_mem_realloc(data, size);
+		if(newData != NULL) memCount(heapCounter[HEAP_LVGL], (int32_t)lv_mem_get_size(newData) - (int32_t)oldSize);
+		return newData;
+	}
+}
+
+static void * countedNew(size_t size)
+{
+	void * pointer = __real_malloc(size == 0 ? 1 : size);
+	if(pointer != NULL) memCount(heapCounter[HEAP_NEW], malloc_usable_size(pointer));
+	return pointer;
+}
+
+static void countedDelete(void * pointer)
+{
+	if(pointer == NULL) return;
+	memCount(heapCounter[HEAP_NEW], -(int32_t)malloc_usable_size(pointer));
+	__real_free(pointer);
+}
+
+void * operator new(size_t size)
+{
+	void * pointer = countedNew(size);
+	if(pointer == NULL) throw std::bad_alloc();
+	return pointer;
+}
+
+void * operator new[](size_t size) {return operator new(size);}
+void * operator new(size_t size, const std::nothrow_t &) noexcept {return countedNew(size);}
+void * operator new[](size_t size, const std::nothrow_t &) noexcept {return countedNew(size);}
+void operator delete(void * pointer) noexcept {countedDelete(pointer);}
+void operator delete[](void * pointer) noexcept {countedDelete(pointer);}
+void operator delete(void * pointer, size_t) noexcept {countedDelete(pointer);}
+void operator delete[](void * pointer, size_t) noexcept {countedDelete(pointer);}
+void operator delete(void * pointer, const std::nothrow_t &) noexcept {countedDelete(pointer);}
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept {countedDelete(pointer);}
+
+static uint32_t heapHeadroom() {return &_heap_end - (char *)sbrk(0);}
+static uint32_t kernelFree() {return xPortGetFreeHeapSize();}
+#else
+static uint32_t heapHeadroom() {return 0;}
+static uint32_t kernelFree() {return 0;}
+#endif
+
+MemSnapshot memCurrent()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	// Host builds; glibc deprecates mallinfo() for mallinfo2()
+	struct mallinfo2 info = mallinfo2();
+#else
+	struct mallinfo info = mallinfo();
+#endif
+	MemSnapshot snapshot;
+
+	snapshot.time = lastSample;
+	snapshot.arena = info.arena;
+	snapshot.used = info.uordblks;
+	snapshot.free = info.fordblks + heapHeadroom();
+	snapshot.largestFree = info.keepcost + heapHeadroom();
+	snapshot.fragmentation = info.fordblks == 0 ? 0 : (uint32_t)((info.fordblks - info.keepcost) * 100ULL / info.fordblks);
+	snapshot.kernelFree = kernelFree();
+
+	return snapshot;
+}
+
+bool memSample(uint32_t now, uint32_t interval)
+{
+	if(lastSample != 0 && now - lastSample < interval) return false;
+	lastSample = now;
+
+	MemSnapshot snapshot = memCurrent();
+	if(snapshot.largestFree < lowestLargestFree) lowestLargestFree = snapshot.largestFree;
+
+	history[historyNext] = snapshot;
+	historyNext = (historyNext + 1) % MEM_HISTORY_LENGTH;
+	if(historyCount < MEM_HISTORY_LENGTH) historyCount++;
+
+	return true;
+}
+
+std::string memReport()
+{
+	if(historyCount == 0) return "";
+
+	const MemSnapshot & latest = history[(historyNext + MEM_HISTORY_LENGTH - 1) % MEM_HISTORY_LENGTH];
+	const MemSnapshot & oldest = history[historyCount < MEM_HISTORY_LENGTH ? 0 : historyNext];
+	char line[96];
+	std::string a = "Heap: bytes (peak)\n";
+
+	for(int i = 0; i < HEAP_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "%s: %ld (%ld)\n", heapName[i], (long)heapCounter[i].bytes, (long)heapCounter[i].peak);
+		a += line;
+	}
+	for(int i = 0; i < MEM_SUBSYSTEM_COUNT; i++)
+	{
+		snprintf(line, sizeof(line), "%s: %ld (%ld)\n", subsystemName[i], (long)subsystemCounter[i].bytes, (long)subsystemCounter[i].peak);
+		a += line;
+	}
+
+	snprintf(line, sizeof(line), "Used %lu, free %lu, frag %lu%%\n", (unsigned long)latest.used, (unsigned long)latest.free, (unsigned long)latest.fragmentation);
+	a += line;
+	snprintf(line, sizeof(line), "Largest free %lu (low %lu)\n", (unsigned long)latest.largestFree, (unsigned long)lowestLargestFree);
+	a += line;
+	snprintf(line, sizeof(line), "Trend %lds: used %+ld, largest %+ld\n", (long)(latest.time - oldest.time) / 1000,
+		(long)latest.used - (long)oldest.used, (long)latest.largestFree - (long)oldest.largestFree);
+	a += line;
+	snprintf(line, sizeof(line), "Kernel heap free %lu\n", (unsigned long)latest.kernelFree);
+	a += line;
+
+	return a;
+}
+
+bool memStream(uint32_t now, uint32_t interval)
+{
+	static uint32_t lastStream = 0;
+	if(now - lastStream < interval || historyCount == 0) return false;
+	lastStream = now;
+
+	const MemSnapshot & latest = history[(historyNext + MEM_HISTORY_LENGTH - 1) % MEM_HISTORY_LENGTH];
+
+	for(int i = 0; i < HEAP_COUNT; i++)
+		printf("MEM %lu heap=%s bytes=%ld peak=%ld allocs=%lu frees=%lu\n", (unsigned long)now, heapName[i], (long)heapCounter[i].bytes,
+			(long)heapCounter[i].peak, (unsigned long)heapCounter[i].allocs, (unsigned long)heapCounter[i].frees);
+	for(int i = 0; i < MEM_SUBSYSTEM_COUNT; i++)
+		printf("MEM %lu subsystem=%s bytes=%ld peak=%ld allocs=%lu frees=%lu\n", (unsigned long)now, subsystemName[i], (long)subsystemCounter[i].bytes,
+			(long)subsystemCounter[i].peak, (unsigned long)subsystemCounter[i].allocs, (unsigned long)subsystemCounter[i].frees);
+	printf("MEM %lu arena=%lu used=%lu free=%lu largest=%lu lowest=%lu frag=%lu kernel=%lu\n", (unsigned long)now, (unsigned long)latest.arena,
+		(unsigned long)latest.used, (unsigned long)latest.free, (unsigned long)latest.largestFree, (unsigned long)lowestLargestFree,
+		(unsigned long)latest.fragmentation, (unsigned long)latest.kernelFree);
+	return true;
+}
@@ -3,19 +3,32 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 #include "main.h"
 #include "pros/apix.h"
-#include "vdml/registry.h"
+#include "display/lv_core/lv_refr.h"
+#include "profiler.hpp"
+#include "taskMonitor.hpp"
+#include "memoryStats.hpp"
+#include "styleCache.hpp"
+#include "testEngine.hpp"
+#include "ui.hpp"
+#include "checkpoint.hpp"
+#include "traceLog.hpp"
+#include "adiScope.hpp"
+#include "adiProbe.hpp"
+#include "controllerLatency.hpp"
+#include "cableTest.hpp"
+#include "visionBench.hpp"
 
 #define map(value, iMin, iMax, oMin, oMax) ((value - iMin) / (double)(iMax - iMin) * (oMax - oMin) + oMin)
 #define expectedSpeed(voltage) ((voltage * 381) / 20000.0)
 
-class Button
+class Button : public TrackedObject<MEM_WIDGET>
 {
 public:
 	lv_style_t * buttonStyleRel = NULL;
 	lv_style_t * buttonStylePr = NULL;
-	lv_style_t * labelStyle = NULL;
 	lv_obj_t * object = NULL;
 	lv_obj_t * label = NULL;
 
@@ -28,26 +41,22 @@ public:
 		label = lv_label_create(object, NULL);
 		lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
 		lv_label_set_recolor(label, true);
-		lv_obj_set_style(label, labelStyle);
+		lv_obj_set_style(label, NULL);
 		lv_label_set_text(label, "");
 	}
 
 	void setStyle(lv_color_t colorRel, lv_color_t colorPr, lv_color_t textColor)
 	{
-		if(buttonStyleRel == NULL) {buttonStyleRel = (lv_style_t *)malloc(sizeof(lv_style_t));lv_style_copy(buttonStyleRel, &lv_style_plain);}
-		if(buttonStylePr == NULL) {buttonStylePr = (lv_style_t *)malloc(sizeof(lv_style_t));lv_style_copy(buttonStylePr, &lv_style_plain);}
-		if(labelStyle == NULL) {labelStyle = (lv_style_t *)malloc(sizeof(lv_style_t));lv_style_copy(labelStyle, &lv_style_plain);}
-		buttonStyleRel->body.main_color = buttonStyleRel->body.grad_color = colorRel;
-		buttonStylePr->body.main_color = buttonStylePr->body.grad_color = colorPr;
-		labelStyle->text.color = textColor;
-		updateStyle();
+		setStyle(styleGet(StyleKey(colorRel, textColor)), styleGet(StyleKey(colorPr, textColor)));
 	}
 
-	void updateStyle()
+	void setStyle(lv_style_t * styleRel, lv_style_t * stylePr)
 	{
+		if(styleRel == buttonStyleRel && stylePr == buttonStylePr) return;
+		buttonStyleRel = styleRel;
+		buttonStylePr = stylePr;
 		lv_btn_set_style(object, LV_BTN_STYLE_REL, buttonStyleRel);
 		lv_btn_set_style(object, LV_BTN_STYLE_PR, buttonStylePr);
-		lv_obj_set_style(label, labelStyle);
 	}
 
 	void setAction(lv_btn_action_t actionType, lv_action_t action) {lv_btn_set_action(object, actionType, action);}
@@ -57,7 +66,7 @@ public:
 	void setTitle(const char * text) {lv_label_set_text(label, text);}
 };
 
-class Graph
+class Graph : public TrackedObject<MEM_GRAPH>
 {
 private:
 	struct Line
@@ -77,7 +86,7 @@ private:
 	{
 		Line newLine;
 		newLine.object = lv_line_create(backgroundObject, NULL);
-		newLine.style = (lv_style_t *)malloc(sizeof(lv_style_t));
+		newLine.style = (lv_style_t *)memAlloc(MEM_GRAPH, sizeof(lv_style_t));
 		lv_style_copy(newLine.style, &lv_style_plain);
 		newLine.style->line = {color, width, opa};
 		lv_obj_set_style(newLine.object, newLine.style);
@@ -91,7 +100,7 @@ public:
 		backgroundObject = lv_obj_create(parent, NULL);
 		lv_obj_set_pos(backgroundObject, x, y);
 		lv_obj_set_size(backgroundObject, graphWidth, graphHeight);
-		backgroundStyle = (lv_style_t *)malloc(sizeof(lv_style_t));
+		backgroundStyle = (lv_style_t *)memAlloc(MEM_GRAPH, sizeof(lv_style_t));
 		lv_style_copy(backgroundStyle, &lv_style_plain);
 		backgroundStyle->body.main_color = backgroundStyle->body.grad_color = backgroundColor;
 		lv_obj_set_style(backgroundObject, backgroundStyle);
@@ -100,7 +109,7 @@ public:
 	void addYGuide(lv_coord_t y, lv_color_t color = LV_COLOR_BLACK, lv_coord_t width = 1, lv_opa_t opa = LV_OPA_100)
 	{
 		Line guideLine = createLine(color, width, opa);
-		guideLine.points = (lv_point_t *)std::malloc(2 * sizeof(lv_point_t));
+		guideLine.points = (lv_point_t *)memAlloc(MEM_GRAPH, 2 * sizeof(lv_point_t));
 		guideLine.points[0] = {0, (lv_coord_t)map(y, yMin, yMax, graphHeight, 0)};
 		guideLine.points[1] = {graphWidth, (lv_coord_t)map(y, yMin, yMax, graphHeight, 0)};
 		lv_line_set_points(guideLine.object, guideLine.points, 2);
@@ -110,7 +119,7 @@ public:
 	void addXGuide(lv_coord_t x, lv_color_t color = LV_COLOR_BLACK, lv_coord_t width = 1, lv_opa_t opa = LV_OPA_100)
 	{
 		Line guideLine = createLine(color, width, opa);
-		guideLine.points = (lv_point_t *)std::malloc(2 * sizeof(lv_point_t));
+		guideLine.points = (lv_point_t *)memAlloc(MEM_GRAPH, 2 * sizeof(lv_point_t));
 		guideLine.points[0] = {(lv_coord_t)map(x, xMin, xMax, 0, graphWidth), 0};
 		guideLine.points[1] = {(lv_coord_t)map(x, xMin, xMax, 0, graphWidth), graphHeight};
 		lv_line_set_points(guideLine.object, guideLine.points, 2);
@@ -122,8 +131,8 @@ public:
 	void setPoints(int lineIndex, std::vector<int> x, std::vector<int> y)
 	{
 		if(lineIndex >= line.size() || y.size() < x.size()) return;
-		std::free(line[lineIndex].points);
-		line[lineIndex].points = (lv_point_t *)std::malloc(x.size() * sizeof(lv_point_t));
+		memFree(MEM_GRAPH, line[lineIndex].points);
+		line[lineIndex].points = (lv_point_t *)memAlloc(MEM_GRAPH, x.size() * sizeof(lv_point_t));
 		for(int i = 0; i < x.size(); i++) line[lineIndex].points[i] = {(lv_coord_t)map(x[i], xMin, xMax, 0, graphWidth), (lv_coord_t)map(y[i], yMin, yMax, graphHeight, 0)};
 		lv_line_set_points(line[lineIndex].object, line[lineIndex].points, x.size());
 	}
@@ -132,24 +141,265 @@ public:
 	{
 		setPoints(lineIndex, {}, {});
 	}
+
+	// The LVGL objects belong to the parent page and are deleted with it.
+	~Graph()
+	{
+		for(std::vector<Line> * lines : {&yGuides, &xGuides, &line})
+		{
+			for(Line & l : *lines)
+			{
+				memFree(MEM_GRAPH, l.style);
+				memFree(MEM_GRAPH, l.points);
+			}
+		}
+		memFree(MEM_GRAPH, backgroundStyle);
+	}
 };
 
-lv_obj_t * allInfoPage = lv_obj_create(lv_scr_act(), NULL);
-Button * box[24];
+class OverviewGrid
+{
+private:
+	static const int columns = 6;
+	static const int rows = 4;
 
-lv_obj_t * motorInfoPage = lv_obj_create(lv_scr_act(), NULL);
-Button motorInfoTitle(motorInfoPage, 0, 0, LV_HOR_RES, 50);
-Button motorInfoBackButton(motorInfoPage, 0, 0, 75, 50);
-lv_obj_t * motorInfoText;
-lv_obj_t * motorInfoSwitch;
-lv_style_t bg_style, indic_style, knob_on_style, knob_off_style;
-Graph motorInfoGraph(motorInfoPage, 150, 50, LV_HOR_RES - 150, LV_VER_RES - 50, -120, 120);
-Button motorInfoRetestButton(motorInfoPage, 0, LV_VER_RES - 50, 150, 50);
+	struct Cell
+	{
+		char text[32];
+		lv_style_t * style;
+	};
+
+	Cell cell[columns * rows];
+	lv_obj_t * object;
+	lv_coord_t cellWidth, cellHeight;
+	void (*action)(int index) = NULL;
+
+	static lv_signal_func_t ancestorSignal;
+
+	void getCellArea(int index, lv_area_t * area)
+	{
+		lv_area_t coords;
+		lv_obj_get_coords(object, &coords);
+		area->x1 = coords.x1 + (index % columns) * cellWidth;
+		area->y1 = coords.y1 + (index / columns) * cellHeight;
+		area->x2 = area->x1 + cellWidth - 1;
+		area->y2 = area->y1 + cellHeight - 1;
+	}
+
+	static bool design(lv_obj_t * obj, const lv_area_t * mask, lv_design_mode_t mode)
+	{
+		OverviewGrid * grid = (OverviewGrid *)lv_obj_get_free_ptr(obj);
+
+		if(mode == LV_DESIGN_COVER_CHK)
+		{
+			lv_area_t coords;
+			lv_obj_get_coords(obj, &coords);
+			return lv_area_is_in(mask, &coords);
+		}
+		if(mode != LV_DESIGN_DRAW_MAIN) return true;
+
+		for(int i = 0; i < columns * rows; i++)
+		{
+			lv_area_t area;
+			grid->getCellArea(i, &area);
+			if(!lv_area_is_on(&area, mask)) continue;
+
+			const lv_style_t * style = grid->cell[i].style != NULL ? grid->cell[i].style : &lv_style_plain;
+			lv_draw_rect(&area, mask, style);
+
+			lv_point_t textSize;
+			lv_txt_get_size(&textSize, grid->cell[i].text, style->text.font, style->text.letter_space, style->text.line_space, grid->cellWidth, LV_TXT_FLAG_CENTER);
+			area.y1 += (grid->cellHeight - textSize.y) / 2;
+			lv_draw_label(&area, mask, style, grid->cell[i].text, LV_TXT_FLAG_CENTER, NULL);
+		}
+
+		return true;
+	}
+
+	static lv_res_t signal(lv_obj_t * obj, lv_signal_t sign, void * param)
+	{
+		lv_res_t res = ancestorSignal(obj, sign, param);
+		if(res != LV_RES_OK) return res;
+
+		OverviewGrid * grid = (OverviewGrid *)lv_obj_get_free_ptr(obj);
+
+		if(sign == LV_SIGNAL_RELEASED && grid->action != NULL)
+		{
+			lv_point_t point;
+			lv_area_t coords;
+			lv_indev_get_point(lv_indev_get_act(), &point);
+			lv_obj_get_coords(obj, &coords);
+
+			int column = (point.x - coords.x1) / grid->cellWidth;
+			int row = (point.y - coords.y1) / grid->cellHeight;
+			if(column >= 0 && column < columns && row >= 0 && row < rows) grid->action(row * columns + column);
+		}
+
+		return LV_RES_OK;
+	}
+
+public:
+	OverviewGrid(lv_coord_t width, lv_coord_t height) : object(NULL), cellWidth(width / columns), cellHeight(height / rows)
+	{
+		for(int i = 0; i < columns * rows; i++) {cell[i].text[0] = '\0';cell[i].style = NULL;}
+	}
+
+	void create(lv_obj_t * parent)
+	{
+		object = lv_obj_create(parent, NULL);
+		lv_obj_set_pos(object, 0, 0);
+		lv_obj_set_size(object, cellWidth * columns, cellHeight * rows);
+		lv_obj_set_click(object, true);
+		lv_obj_set_free_ptr(object, this);
+		if(ancestorSignal == NULL) ancestorSignal = lv_obj_get_signal_func(object);
+		lv_obj_set_signal_func(object, signal);
+		lv_obj_set_design_func(object, design);
+	}
+
+	void setAction(void (*newAction)(int index)) {action = newAction;}
+
+	void setText(int index, const char * text)
+	{
+		if(strncmp(cell[index].text, text, sizeof(cell[index].text) - 1) == 0) return;
+		strncpy(cell[index].text, text, sizeof(cell[index].text) - 1);
+		cell[index].text[sizeof(cell[index].text) - 1] = '\0';
+		invalidate(index);
+	}
+
+	void setStyle(int index, lv_color_t bodyColor, lv_color_t textColor)
+	{
+		lv_style_t * style = styleGet(StyleKey(bodyColor, textColor).withLineSpace(-3));
+		if(style == cell[index].style) return;
+		cell[index].style = style;
+		invalidate(index);
+	}
+
+	void invalidate(int index)
+	{
+		if(object == NULL) return;
+
+		lv_area_t area;
+		getCellArea(index, &area);
+		lv_inv_area(&area);
+	}
+};
+
+lv_signal_func_t OverviewGrid::ancestorSignal = NULL;
+
+const lv_color_t scopeColor[ADI_SCOPE_CHANNELS] = {LV_COLOR_NAVY, LV_COLOR_RED, LV_COLOR_GREEN, LV_COLOR_ORANGE, LV_COLOR_PURPLE, LV_COLOR_TEAL, LV_COLOR_MAGENTA, LV_COLOR_OLIVE};
+
+/**
+ * The 3-wire scope trace. Each channel's ring is reduced to a min/max pair
+ * per pixel column (adiScopeDecimate()) and drawn as one 1 px rect per
+ * column, so a single-sample dropout still shows as a spike however many
+ * samples share its column.
+ */
+class ScopeView : public TrackedObject<MEM_GRAPH>
+{
+private:
+	static const int width = LV_HOR_RES;
+
+	lv_obj_t * object = NULL;
+	lv_coord_t height;
+	int16_t low[ADI_SCOPE_CHANNELS][width];
+	int16_t high[ADI_SCOPE_CHANNELS][width];
+	uint8_t shown = 0;
+	int triggerColumn = -1;
+	int triggerLevel = -1;
+	lv_style_t * guideStyle = NULL;
+	lv_style_t * channelStyle[ADI_SCOPE_CHANNELS] = {};
+
+	lv_coord_t valueY(int value) const
+	{
+		lv_coord_t bottom = height - 1;
+		return map(value, 0, 4095, bottom, 0);
+	}
+
+	static bool design(lv_obj_t * obj, const lv_area_t * mask, lv_design_mode_t mode)
+	{
+		ScopeView * view = (ScopeView *)lv_obj_get_free_ptr(obj);
+
+		lv_area_t coords;
+		lv_obj_get_coords(obj, &coords);
+		if(mode == LV_DESIGN_COVER_CHK) return lv_area_is_in(mask, &coords);
+		if(mode != LV_DESIGN_DRAW_MAIN) return true;
+
+		lv_draw_rect(&coords, mask, &lv_style_plain);
+
+		lv_style_t * guide = view->guideStyle;
+		if(view->triggerLevel >= 0)
+		{
+			lv_area_t area = {coords.x1, (lv_coord_t)(coords.y1 + view->valueY(view->triggerLevel)), coords.x2, 0};
+			area.y2 = area.y1;
+			lv_draw_rect(&area, mask, guide);
+		}
+		if(view->triggerColumn >= 0)
+		{
+			lv_area_t area = {(lv_coord_t)(coords.x1 + view->triggerColumn), coords.y1, 0, coords.y2};
+			area.x2 = area.x1;
+			lv_draw_rect(&area, mask, guide);
+		}
+
+		for(int channel = 0; channel < ADI_SCOPE_CHANNELS; channel++)
+		{
+			if(!(view->shown & (1 << channel))) continue;
+			lv_style_t * style = view->channelStyle[channel];
+
+			for(int column = 0; column < width; column++)
+			{
+				if(view->low[channel][column] < 0) continue;
+				lv_area_t area;
+				area.x1 = area.x2 = coords.x1 + column;
+				area.y1 = coords.y1 + view->valueY(view->high[channel][column]);
+				area.y2 = coords.y1 + view->valueY(view->low[channel][column]);
+				lv_draw_rect(&area, mask, style);
+			}
+		}
+
+		return true;
+	}
+
+public:
+	ScopeView(lv_coord_t height) : height(height) {}
+
+	void create(lv_obj_t * parent, lv_coord_t x, lv_coord_t y)
+	{
+		object = lv_obj_create(parent, NULL);
+		lv_obj_set_pos(object, x, y);
+		lv_obj_set_size(object, width, height);
+		lv_obj_set_free_ptr(object, this);
+		lv_obj_set_design_func(object, design);
 
-lv_obj_t * controllerPage = lv_obj_create(lv_scr_act(), NULL);
-Button controllerTitle(controllerPage, 0, 0, LV_HOR_RES, 50);
-Button controllerBackButton(controllerPage, 0, 0, 75, 50);
-lv_style_t ctrStyleOpen, ctrStyleClosed;
+		guideStyle = styleGet(StyleKey(LV_COLOR_SILVER, LV_COLOR_SILVER));
+		for(int channel = 0; channel < ADI_SCOPE_CHANNELS; channel++) channelStyle[channel] = styleGet(StyleKey(scopeColor[channel], scopeColor[channel]));
+	}
+
+	// triggerIndex is the trigger's ring position from adiScopeStatus(), or -1
+	void update(uint8_t channels, int triggerIndex, int level)
+	{
+		shown = channels;
+		for(int channel = 0; channel < ADI_SCOPE_CHANNELS; channel++) if(channels & (1 << channel)) adiScopeDecimate(channel, width, low[channel], high[channel]);
+		triggerColumn = triggerIndex < 0 ? -1 : triggerIndex * width / ADI_SCOPE_DEPTH;
+		triggerLevel = level;
+		if(object != NULL) lv_obj_invalidate(object);
+	}
+};
+
+OverviewGrid overviewGrid(LV_HOR_RES, LV_VER_RES);
+
+Button * motorInfoTitle = NULL;
+Button * motorInfoBackButton = NULL;
+lv_obj_t * motorInfoText = NULL;
+lv_obj_t * motorInfoSwitch = NULL;
+lv_style_t bg_style, indic_style, knob_on_style, knob_off_style;
+Graph * motorInfoGraph = NULL;
+Button * motorInfoRetestButton = NULL;
+Button * motorInfoVisionButton = NULL;
+bool motorInfoShowVoltage = false;
+
+Button * controllerTitle = NULL;
+Button * controllerBackButton = NULL;
+lv_style_t * ctrStyleOpen, * ctrStyleClosed;
 struct
 {
 	Button * title;
@@ -160,145 +410,197 @@ struct
 	Button * up, * right, * down, * left;
 	Button * x, * a, * b, * y;
 
-} controller[2];
-
-lv_obj_t * adiPage = lv_obj_create(lv_scr_act(), NULL);
-Button adiTitle(adiPage, 0, 0, LV_HOR_RES, 50);
-Button adiBackButton(adiPage, 0, 0, 75, 50);
+} controller[2] = {};
+Button * controllerLatencyButton = NULL;
+
+Button * latencyTitle = NULL;
+Button * latencyBackButton = NULL;
+Button * latencyResetButton = NULL;
+lv_obj_t * latencyText = NULL;
+Graph * latencyIntervalGraph = NULL;
+Graph * latencyRttGraph = NULL;
+long lastLatencyUpdate = 0;
+int latencyUpdateInterval = 250;
+
+Button * visionTitle = NULL;
+Button * visionBackButton = NULL;
+Button * visionModeButton = NULL;
+Button * visionResetButton = NULL;
+lv_obj_t * visionText = NULL;
+Graph * visionGraph = NULL;
+VisionReadMode visionMode = VISION_READ_SIZE;
+const lv_color_t visionColor[VISION_EXPOSURE_STEPS] = {LV_COLOR_NAVY, LV_COLOR_ORANGE, LV_COLOR_TEAL, LV_COLOR_LIME};
+long lastVisionUpdate = 0;
+int visionUpdateInterval = 250;
+
+Button * adiTitle = NULL;
+Button * adiBackButton = NULL;
 lv_style_t adiPortDisplayStyle;
-Button * adiPortTitle[8];
-lv_obj_t * adiPortDisplay[8];
-Button * adiPortValue[8];
+Button * adiPortTitle[8] = {};
+lv_obj_t * adiPortDisplay[8] = {};
+Button * adiPortValue[8] = {};
 const char * adiName[] = {"A", "B", "C", "D", "E", "F", "G", "H"};
-
-lv_obj_t * infoPage = lv_obj_create(lv_scr_act(), NULL);
-Button infoTitle(infoPage, 0, 0, LV_HOR_RES, 50);
-Button infoBackButton(infoPage, 0, 0, 75, 50);
-lv_obj_t * infoText;
+Button * adiScopeButton = NULL;
+Button * adiProbeButton = NULL;
+
+Button * scopeTitle = NULL;
+Button * scopeBackButton = NULL;
+Button * scopeChannelButton[ADI_SCOPE_CHANNELS] = {};
+Button * scopeTriggerChannelButton = NULL;
+Button * scopeModeButton = NULL;
+Button * scopeLevelDownButton = NULL;
+Button * scopeLevelButton = NULL;
+Button * scopeLevelUpButton = NULL;
+Button * scopeArmButton = NULL;
+ScopeView * scopeView = NULL;
+uint8_t scopeChannels = 0x01;
+AdiTrigger scopeTrigger = {ADI_TRIGGER_FREE, 0, 2048, ADI_SCOPE_DEPTH / 4};
+const char * scopeModeName[ADI_TRIGGER_MODE_COUNT] = {"Free", "Rising", "Falling", "Above", "Below"};
+const char * scopeStateName[] = {"Stopped", "Running", "Armed", "Triggered", "Captured"};
+int scopeLevelStep = 128;
+long lastScopeUpdate = 0;
+int scopeUpdateInterval = 100;
+bool scopeCaptureDrawn = false;
+
+Button * probeTitle = NULL;
+Button * probeBackButton = NULL;
+Button * probeRescanButton = NULL;
+lv_obj_t * probeText = NULL;
+long lastProbeUpdate = 0;
+int probeUpdateInterval = 200;
+
+Button * infoTitle = NULL;
+Button * infoBackButton = NULL;
+Button * infoTaskButton = NULL;
+Button * infoHeadlessButton = NULL;
+Button * infoCableButton = NULL;
+lv_obj_t * infoScroll = NULL;
+lv_obj_t * infoText = NULL;
+long lastInfoUpdate = 0;
+int infoUpdateInterval = 500;
+
+Button * cableTitle = NULL;
+Button * cableBackButton = NULL;
+Button * cableStartButton = NULL;
+lv_obj_t * cableText = NULL;
+long lastCableUpdate = 0;
+int cableUpdateInterval = 250;
+
+Button * taskTitle = NULL;
+Button * taskBackButton = NULL;
+lv_obj_t * taskScroll = NULL;
+lv_obj_t * taskText = NULL;
+
+Button * headlessStatus = NULL;
 
 void setButton(Button * button, bool state)
 {
-	if(state) button->buttonStyleRel = button->buttonStylePr = &ctrStyleClosed;
-	else button->buttonStyleRel = button->buttonStylePr = &ctrStyleOpen;
-	button->updateStyle();
+	if(state) button->setStyle(ctrStyleClosed, ctrStyleClosed);
+	else button->setStyle(ctrStyleOpen, ctrStyleOpen);
 }
 
+bool isButton(lv_obj_t * btn, Button * button) {return button != NULL && btn == button->object;}
+
 int currentPage = 0;
 int motorSelected = 0;
+// Page | port << 8 from uiShowPage(), -1 when none is waiting; only the UI task changes the page
+int pageRequest = -1;
+uint32_t motorInfoRevision = 0;
 
-struct TestPoint
+// What the motor info page shows of a port; the sample vectors stay behind, the trace is read separately
+static void copyMotorInfo(const PortData & source, PortData & port)
 {
-	int voltage;
-	double settleSpeed;
-	int settleCurrent;
-};
+	port.device = source.device;
+	port.state = source.state;
+	port.start = source.start;
+	port.averageScore = source.averageScore;
+	port.coastTime = source.coastTime;
+	port.breakTime = source.breakTime;
+	port.timedOut = source.timedOut;
+	port.motorWorking = source.motorWorking;
+	port.currentWorking = source.currentWorking;
+	port.breakModeWorking = source.breakModeWorking;
+	port.encoderWorking = source.encoderWorking;
+	port.rampStart = source.rampStart;
+	port.rampFit = source.rampFit;
+	port.results.assign(source.results.begin(), source.results.end());
+	port.velocityResults.assign(source.velocityResults.begin(), source.velocityResults.end());
+	port.events.assign(source.events.begin(), source.events.end());
+	port.eventsDropped = source.eventsDropped;
+	port.revision = source.revision;
+}
 
-struct TestPointResult
+void updateMotorInfo()
 {
-	double settleSpeed;
-	int settleCurrent;
-};
-
-struct PortData
-{
-	int state = 0;
-	long lastPlug = -1;
-	pros::c::v5_device_e_t device = pros::c::E_DEVICE_NONE;
-	int requestedVoltageValue = 0;
-	double acceleration = 0;
-	long testingStart = 0;
-	int testPoint = 0;
-	int testPointStep = 0;
-	long testStart = 0;
-	long lastReading = 0;
-	std::vector<long> time;
-	std::vector<int> appliedVoltage;
-	std::vector<int> requestedVoltage;
-	std::vector<int> current;
-	std::vector<int> velocity;
-	std::vector<TestPointResult> results;
-	long start = 0;
-	int coastTime;
-	int breakTime;
-	bool motorWorking = false;
-	bool currentWorking = false;
-	double averageScore = 0;
-	bool timedOut = false;
-	bool breakModeWorking = true;
-};
-
-const int maxMotorsRunning = 8;
-int testingTimeout = 8000;
-int currentMotorsRunning = 0;
-PortData portData[21];
-
-int readingInterval = 3;
-double errorPercent = 5;
-TestPoint testPointList[] = {
-	{6000, 117, 70},
-	{12000, 237, 160},
-	{-6000, -117, 73},
-	{-12000, -236, 156},
-};
+	if(motorInfoTitle == NULL) return;
 
-int averageCoastTime = 885;
-int averageBreakTime = 196;
+	PROFILE_ZONE(ZONE_MOTOR_INFO);
 
-TestPointResult testResultSum[4] = {{0, 0}, {0, 0}, {0, 0}, {0, 0}};
-int coastTimeResultSum = 0;
-int breakTimeResultSum = 0;
-int totalResultCount = 0;
+	PortData port;
+	PositionSummary position;
+	std::vector<TraceSample> samples;
+	{
+		EngineLock lock;
+		const PortData & source = portData[motorSelected];
+		copyMotorInfo(source, port);
+		position = enginePositionSummary(source);
+		samples.resize(engineTraceLength(source));
+		samples.resize(engineTraceRead(source, 0, samples.data(), samples.size()));
+	}
+	motorInfoRevision = port.revision;
 
-void updateMotorInfo()
-{
-	lv_obj_set_hidden(motorInfoRetestButton.object, portData[motorSelected].device != pros::c::E_DEVICE_MOTOR);
+	lv_obj_set_hidden(motorInfoRetestButton->object, port.device != pros::c::E_DEVICE_MOTOR);
+	lv_obj_set_hidden(motorInfoVisionButton->object, port.device != pros::c::E_DEVICE_VISION);
 
 	std::string a = "Port " + std::to_string(motorSelected + 1);
-	if(portData[motorSelected].device == pros::c::E_DEVICE_MOTOR) a += ": Motor";
-	if(portData[motorSelected].device == pros::c::E_DEVICE_RADIO) a += ": Radio";
-	if(portData[motorSelected].device == pros::c::E_DEVICE_VISION) a += ": Vision";
+	if(port.device == pros::c::E_DEVICE_MOTOR) a += ": Motor";
+	if(port.device == pros::c::E_DEVICE_RADIO) a += ": Radio";
+	if(port.device == pros::c::E_DEVICE_VISION) a += ": Vision";
 
-	if(portData[motorSelected].state >= 100)
+	if(port.state >= 100)
 	{
 		std::stringstream stream;
-		stream << std::fixed << std::setprecision(2) << portData[motorSelected].averageScore;
+		stream << std::fixed << std::setprecision(2) << port.averageScore;
 		a += ": " + stream.str() + "%";
 
-		if(portData[motorSelected].timedOut) a += "\n#ff0000 Error: Timed Out#";
-		else if(!portData[motorSelected].motorWorking) a += "\n#ff0000 Error: Motor Not Running#";
-		else if(!portData[motorSelected].currentWorking) a += "\n#ff0000 Error: Current Reading Problem#";
-		else if(!portData[motorSelected].breakModeWorking) a += "\n#ff0000 Error: Motor Brake Not Working#";
+		if(port.timedOut) a += "\n#ff0000 Error: Timed Out#";
+		else if(!port.motorWorking) a += "\n#ff0000 Error: Motor Not Running#";
+		else if(!port.currentWorking) a += "\n#ff0000 Error: Current Reading Problem#";
+		else if(!port.breakModeWorking) a += "\n#ff0000 Error: Motor Brake Not Working#";
+		else if(!port.encoderWorking) a += "\n#ff0000 Error: Encoder Counts Wrong#";
 	}
 
-	motorInfoTitle.setTitle(a.c_str());
+	motorInfoTitle->setTitle(a.c_str());
 
 	a = "#008080 Current#\n#000080 Velocity#\n";
-	if(lv_sw_get_state(motorInfoSwitch)) a += "#ffa500 Applied Voltage#\n#00ff00 Voltage#\n";
+	if(port.rampFit.valid) a += "#ff00ff Fit#\n";
+	if(!port.events.empty()) a += "#ff0000 Faults#\n";
+	if(motorInfoShowVoltage) a += "#ffa500 Applied Voltage#\n#00ff00 Voltage#\n";
 
-	if(portData[motorSelected].results.size() > 0)
+	if(port.results.size() > 0)
 	{
 		double ssResult = 0;
 		double scResult = 0;
-		double cResult = portData[motorSelected].coastTime / (double)averageCoastTime * 100.0 - 100.0;
-		double bResult = tanh((averageBreakTime - portData[motorSelected].breakTime) * 0.005) * 100.0;
+		double cResult = port.coastTime / (double)averageCoastTime * 100.0 - 100.0;
+		double bResult = tanh((averageBreakTime - port.breakTime) * 0.005) * 100.0;
 		if(bResult > 10) bResult = 10;
 
-		if(portData[motorSelected].coastTime == 0) cResult = 0;
-		if(portData[motorSelected].breakTime == 0) bResult = 0;
+		if(port.coastTime == 0) cResult = 0;
+		if(port.breakTime == 0) bResult = 0;
 
-		for(int i = 0; i < portData[motorSelected].results.size(); i++)
+		for(int i = 0; i < port.results.size(); i++)
 		{
-			int testPoint = i % (sizeof(testPointList) / sizeof(TestPoint));
+			int testPoint = i % testPointCount;
 
-			double ssPercent = portData[motorSelected].results[i].settleSpeed / (double)testPointList[testPoint].settleSpeed * 100.0 - 100.0;
-			double scPercent = testPointList[testPoint].settleCurrent / (double)(portData[motorSelected].results[i].settleCurrent + 0.0001) * 100.0 - 100.0;
+			double ssPercent = port.results[i].settleSpeed / (double)testPointList[testPoint].settleSpeed * 100.0 - 100.0;
+			double scPercent = testPointList[testPoint].settleCurrent / (double)(port.results[i].settleCurrent + 0.0001) * 100.0 - 100.0;
 
 			ssResult += ssPercent;
 			scResult += scPercent;
 		}
 
-		ssResult /= portData[motorSelected].results.size();
-		scResult /= portData[motorSelected].results.size();
+		ssResult /= port.results.size();
+		scResult /= port.results.size();
 
 		a += "SS: " + std::to_string((int)ssResult) + ", ";
 		a += "SC: " + std::to_string((int)scResult) + "\n";
@@ -306,42 +608,99 @@ void updateMotorInfo()
 		a += "B: " + std::to_string((int)bResult) + "\n";
 	}
 
+	// Ramp dead band forward/reverse, non-linearity forward/reverse and asymmetry
+	if(port.rampFit.valid)
+	{
+		char line[64];
+		snprintf(line, sizeof(line), "Ramp: db %.1f/%.1f V\nnl %.0f/%.0f%%, asym %.0f%%\n", port.rampFit.deadBand[0] / 1000, port.rampFit.deadBand[1] / 1000,
+			port.rampFit.nonLinearity[0], port.rampFit.nonLinearity[1], port.rampFit.asymmetry);
+		a += line;
+	}
+
+	// Velocity steps as rise/settle ms and overshoot; - for never
+	double worstError = 0;
+	for(const VelocityStepResult & step : port.velocityResults)
+	{
+		char line[48];
+		snprintf(line, sizeof(line), "V%d: %s/%s %d%%\n", step.setpoint, step.riseTime < 0 ? "-" : std::to_string(step.riseTime).c_str(),
+			step.settleTime < 0 ? "-" : std::to_string(step.settleTime).c_str(), (int)step.overshoot);
+		a += line;
+		if(fabs(step.steadyStateError) > fabs(worstError)) worstError = step.steadyStateError;
+	}
+	if(!port.velocityResults.empty()) a += "V err: " + std::to_string((int)round(worstError)) + " rpm\n";
+
+	if(position.moves > 0)
+	{
+		char line[64];
+		snprintf(line, sizeof(line), "P%d: %.1f/%.1f deg\n%.0f ms\n", position.moves, position.meanError, position.spread, position.meanTime);
+		a += line;
+	}
+
+	// Fault and flag changes, seconds into the test, then the test points a fault left out of the score
+	for(size_t e = 0; e < port.events.size() && e < 4; e++)
+	{
+		char line[48];
+		snprintf(line, sizeof(line), "F %.2fs: %s\n", (port.events[e].time - port.start) / 1000.0, engineFaultNames(port.events[e].faults, port.events[e].flags).c_str());
+		a += line;
+	}
+	size_t hiddenEvents = (port.events.size() > 4 ? port.events.size() - 4 : 0) + port.eventsDropped;
+	if(hiddenEvents > 0) a += "+" + std::to_string(hiddenEvents) + " more\n";
+	std::string faulted;
+	for(size_t r = 0; r < port.results.size(); r++) if(port.results[r].faults != 0) faulted += " TP" + std::to_string(r + 1);
+	if(!faulted.empty()) a += "Faulted:" + faulted + "\n";
+
 	if(pros::c::motor_get_temperature(motorSelected + 1) != PROS_ERR) a += "Temp: " + std::to_string((int)pros::c::motor_get_temperature(motorSelected + 1));
 
 	lv_label_set_text(motorInfoText, a.c_str());
 
 	int timeFrame = 1;
-	if(portData[motorSelected].time.size() > 2) timeFrame = portData[motorSelected].time.back() - portData[motorSelected].time.front();
+	if(samples.size() > 2) timeFrame = samples.back().value[TRACE_TIME] - samples.front().value[TRACE_TIME];
 
-	std::vector<int> time, appliedVoltage, requestedVoltage, current, velocity;
+	std::vector<int> time, appliedVoltage, requestedVoltage, current, velocity, fitTime, fitVelocity, fault;
+	size_t event = 0;
+	uint32_t faults = 0;
 
-	for(int i = 0; i < portData[motorSelected].time.size(); i++)
+	for(const TraceSample & sample : samples)
 	{
-		time.push_back((portData[motorSelected].time[i] - portData[motorSelected].time.front()) / (double)timeFrame * 100);
-		requestedVoltage.push_back(expectedSpeed(portData[motorSelected].requestedVoltage[i]) / 2.5);
-		appliedVoltage.push_back(expectedSpeed(portData[motorSelected].appliedVoltage[i]) / 2.5);
-		current.push_back(portData[motorSelected].current[i] / 20.0);
-		velocity.push_back(portData[motorSelected].velocity[i] / 2.5);
+		time.push_back((sample.value[TRACE_TIME] - samples.front().value[TRACE_TIME]) / (double)timeFrame * 100);
+		requestedVoltage.push_back(expectedSpeed(sample.value[TRACE_REQUESTED_VOLTAGE]) / 2.5);
+		appliedVoltage.push_back(expectedSpeed(sample.value[TRACE_APPLIED_VOLTAGE]) / 2.5);
+		current.push_back(sample.value[TRACE_CURRENT] / 20.0);
+		velocity.push_back(sample.value[TRACE_VELOCITY] / 2.5);
+
+		// The fitted speed over the ramp, at the voltage the motor was given
+		long sinceRamp = sample.value[TRACE_TIME] - port.rampStart;
+		if(port.rampFit.valid && sinceRamp >= 0 && sinceRamp <= rampSweepTime && sample.value[TRACE_APPLIED_VOLTAGE] != 0)
+		{
+			fitTime.push_back(time.back());
+			fitVelocity.push_back(engineRampValue(port.rampFit.velocity, sample.value[TRACE_APPLIED_VOLTAGE]) / 2.5);
+		}
+
+		// Along the bottom, raised while any fault or flag was set
+		for(; event < port.events.size() && port.events[event].time <= (uint32_t)sample.value[TRACE_TIME]; event++) faults = port.events[event].faults | port.events[event].flags;
+		fault.push_back(faults != 0 ? -100 : -115);
 	}
 
-	if(lv_sw_get_state(motorInfoSwitch))
+	if(motorInfoShowVoltage)
 	{
-		motorInfoGraph.setPoints(0, time, requestedVoltage);
-		motorInfoGraph.setPoints(1, time, appliedVoltage);
+		motorInfoGraph->setPoints(0, time, requestedVoltage);
+		motorInfoGraph->setPoints(1, time, appliedVoltage);
 	}
 	else
 	{
-		motorInfoGraph.clear(0);
-		motorInfoGraph.clear(1);
+		motorInfoGraph->clear(0);
+		motorInfoGraph->clear(1);
 	}
-	motorInfoGraph.setPoints(2, time, current);
-	motorInfoGraph.setPoints(3, time, velocity);
+	motorInfoGraph->setPoints(2, time, current);
+	motorInfoGraph->setPoints(3, time, velocity);
+	if(fitTime.empty()) motorInfoGraph->clear(4);
+	else motorInfoGraph->setPoints(4, fitTime, fitVelocity);
+	if(port.events.empty()) motorInfoGraph->clear(5);
+	else motorInfoGraph->setPoints(5, time, fault);
 }
 
-lv_res_t clickAction(lv_obj_t * btn)
+void overviewAction(int i)
 {
-    uint32_t i = lv_obj_get_free_num(btn);
-
 	if(i >= 0 && i < 21)
 	{
 		currentPage = 1;
@@ -351,34 +710,74 @@ lv_res_t clickAction(lv_obj_t * btn)
 	if(i == 21) currentPage = 2;
 	if(i == 22) currentPage = 3;
 	if(i == 23) currentPage = 4;
+}
 
-	if(btn == motorInfoBackButton.object ||
-		btn == controllerBackButton.object ||
-		btn == adiBackButton.object ||
-		btn == infoBackButton.object) currentPage = 0;
+void updateScopeControls()
+{
+	if(scopeTitle == NULL) return;
 
-	if(btn == motorInfoRetestButton.object && portData[motorSelected].device == pros::c::E_DEVICE_MOTOR)
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++)
 	{
-		if(portData[motorSelected].state >= 3 || portData[motorSelected].state <= 9) currentMotorsRunning--;
+		if(scopeChannels & (1 << i)) scopeChannelButton[i]->setStyle(scopeColor[i], scopeColor[i], LV_COLOR_WHITE);
+		else scopeChannelButton[i]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, scopeColor[i]);
+	}
 
-		box[motorSelected]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	std::string a = "Trig " + (std::string)adiName[scopeTrigger.channel];
+	scopeTriggerChannelButton->setTitle(a.c_str());
+	scopeModeButton->setTitle(scopeModeName[scopeTrigger.mode]);
+	scopeLevelButton->setTitle(std::to_string(scopeTrigger.level).c_str());
+	scopeArmButton->setTitle(scopeTrigger.mode == ADI_TRIGGER_FREE ? "Run" : "Arm");
+}
 
-		portData[motorSelected].lastReading = 0;
-		portData[motorSelected].time.clear();
-		portData[motorSelected].current.clear();
-		portData[motorSelected].velocity.clear();
-		portData[motorSelected].results.clear();
-		portData[motorSelected].coastTime = 0;
-		portData[motorSelected].breakTime = 0;
+lv_res_t clickAction(lv_obj_t * btn)
+{
+	if(isButton(btn, motorInfoBackButton) ||
+		isButton(btn, controllerBackButton) ||
+		isButton(btn, adiBackButton) ||
+		isButton(btn, infoBackButton)) currentPage = 0;
+
+	if(isButton(btn, adiScopeButton)) currentPage = 7;
+	if(isButton(btn, scopeBackButton)) currentPage = 3;
+	if(isButton(btn, adiProbeButton)) currentPage = 8;
+	if(isButton(btn, probeBackButton)) currentPage = 3;
+	if(isButton(btn, probeRescanButton)) adiProbeStart();
+	if(isButton(btn, controllerLatencyButton)) currentPage = 9;
+	if(isButton(btn, latencyBackButton)) currentPage = 2;
+	if(isButton(btn, latencyResetButton)) controllerLatencyReset();
+	if(isButton(btn, motorInfoVisionButton)) currentPage = 11;
+	if(isButton(btn, visionBackButton)) currentPage = 1;
+	if(isButton(btn, visionResetButton)) visionBenchReset();
+	if(isButton(btn, visionModeButton))
+	{
+		visionMode = visionMode == VISION_READ_SIZE ? VISION_READ_SIGNATURE : VISION_READ_SIZE;
+		visionModeButton->setTitle(visionMode == VISION_READ_SIZE ? "By Size" : "By Sig 1");
+	}
 
-		pros::c::motor_move(motorSelected + 1, 0);
-		portData[motorSelected].requestedVoltageValue = 0;
-		portData[motorSelected].state = 1;
-		portData[motorSelected].motorWorking = false;
-		portData[motorSelected].currentWorking = false;
-		portData[motorSelected].timedOut = false;
-		portData[motorSelected].breakModeWorking = true;
+	if(isButton(btn, infoTaskButton)) currentPage = 5;
+	if(isButton(btn, taskBackButton)) currentPage = 4;
+	if(isButton(btn, infoCableButton)) currentPage = 10;
+	if(isButton(btn, cableBackButton)) currentPage = 4;
+	if(isButton(btn, cableStartButton)) cableTestStart();
+
+	if(isButton(btn, infoHeadlessButton)) uiDetach();
+	if(isButton(btn, headlessStatus)) uiAttach();
+
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++) if(isButton(btn, scopeChannelButton[i])) scopeChannels ^= 1 << i;
+	if(isButton(btn, scopeTriggerChannelButton)) scopeTrigger.channel = (scopeTrigger.channel + 1) % ADI_SCOPE_CHANNELS;
+	if(isButton(btn, scopeModeButton)) scopeTrigger.mode = (AdiTriggerMode)((scopeTrigger.mode + 1) % ADI_TRIGGER_MODE_COUNT);
+	if(isButton(btn, scopeLevelDownButton)) scopeTrigger.level = std::max(0, scopeTrigger.level - scopeLevelStep);
+	if(isButton(btn, scopeLevelUpButton)) scopeTrigger.level = std::min(4095, scopeTrigger.level + scopeLevelStep);
+	if(isButton(btn, scopeArmButton))
+	{
+		if(scopeTrigger.mode != ADI_TRIGGER_FREE) scopeChannels |= 1 << scopeTrigger.channel;
+		adiScopeArm(scopeTrigger);
+		scopeCaptureDrawn = false;
+	}
+	updateScopeControls();
 
+	if(isButton(btn, motorInfoRetestButton))
+	{
+		engineRetest(motorSelected);
 		updateMotorInfo();
 	}
 
@@ -387,52 +786,30 @@ lv_res_t clickAction(lv_obj_t * btn)
 
 lv_res_t event_handler(lv_obj_t * obj)
 {
+	motorInfoShowVoltage = lv_sw_get_state(obj);
 	if(currentPage == 1) updateMotorInfo();
 	return LV_RES_OK;
 }
 
-void opcontrol()
+void buildOverviewPage(lv_obj_t * page)
 {
-	lv_obj_set_style(allInfoPage, &lv_style_plain);
-	lv_obj_set_size(allInfoPage, LV_HOR_RES, LV_VER_RES);
-	lv_obj_set_style(motorInfoPage, &lv_style_plain);
-	lv_obj_set_size(motorInfoPage, LV_HOR_RES, LV_VER_RES);
-	lv_obj_set_style(controllerPage, &lv_style_plain);
-	lv_obj_set_size(controllerPage, LV_HOR_RES, LV_VER_RES);
-	lv_obj_set_style(adiPage, &lv_style_plain);
-	lv_obj_set_size(adiPage, LV_HOR_RES, LV_VER_RES);
-	lv_obj_set_style(infoPage, &lv_style_plain);
-	lv_obj_set_size(infoPage, LV_HOR_RES, LV_VER_RES);
-
-	int blockWidth = LV_HOR_RES / 6;
-	int blockHeight = LV_VER_RES / 4;
-
-	for(int i = 0; i < 24; i++)
-	{
-		int x = (i % 6) * blockWidth;
-		int y = roundf(i / 6) * blockHeight;
-
-		box[i] = new Button(allInfoPage, x, y, blockWidth, blockHeight);
-		box[i]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-		box[i]->setAction(LV_BTN_ACTION_CLICK, clickAction);
-		box[i]->setId(i);
-
-		box[i]->labelStyle->text.line_space = -3;
-		box[i]->updateStyle();
-	}
+	overviewGrid.create(page);
+	overviewGrid.setAction(overviewAction);
+}
 
-	box[21]->setTitle("Test\nControl-\nlers");
-	box[22]->setTitle("Test\n3-Wire\nPorts");
-	box[23]->setTitle("Extra\nInfo");
+void buildMotorInfoPage(lv_obj_t * page)
+{
+	motorInfoTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	motorInfoBackButton = new Button(page, 0, 0, 75, 50);
 
-	motorInfoBackButton.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	motorInfoBackButton.setAction(LV_BTN_ACTION_CLICK, clickAction);
-	motorInfoBackButton.setId();
-	motorInfoBackButton.setTitle(SYMBOL_LEFT);
+	motorInfoBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	motorInfoBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	motorInfoBackButton->setId();
+	motorInfoBackButton->setTitle(SYMBOL_LEFT);
 
-	motorInfoTitle.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	motorInfoTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
 
-	motorInfoText = lv_label_create(motorInfoPage, NULL);
+	motorInfoText = lv_label_create(page, NULL);
 	lv_obj_set_pos(motorInfoText, 3, 50);
 	lv_label_set_recolor(motorInfoText, true);
 	lv_obj_set_style(motorInfoText, &lv_style_plain);
@@ -458,97 +835,294 @@ void opcontrol()
     knob_on_style.body.shadow.width = 4;
     knob_on_style.body.shadow.type = LV_SHADOW_BOTTOM;
 
-	motorInfoSwitch = lv_sw_create(motorInfoPage, NULL);
+	motorInfoSwitch = lv_sw_create(page, NULL);
 	lv_sw_set_style(motorInfoSwitch, LV_SW_STYLE_BG, &bg_style);
     lv_sw_set_style(motorInfoSwitch, LV_SW_STYLE_INDIC, &indic_style);
     lv_sw_set_style(motorInfoSwitch, LV_SW_STYLE_KNOB_ON, &knob_on_style);
     lv_sw_set_style(motorInfoSwitch, LV_SW_STYLE_KNOB_OFF, &knob_off_style);
 	lv_obj_set_size(motorInfoSwitch, 60, 40);
 	lv_obj_align(motorInfoSwitch, NULL, LV_ALIGN_IN_TOP_RIGHT, -10, 10);
+	if(motorInfoShowVoltage) lv_sw_on(motorInfoSwitch);
 	lv_sw_set_action(motorInfoSwitch, event_handler);
 
-	motorInfoGraph.addYGuide(0);
-	motorInfoGraph.add(LV_COLOR_LIME, 2);
-	motorInfoGraph.add(LV_COLOR_ORANGE, 2);
-	motorInfoGraph.add(LV_COLOR_TEAL, 2);
-	motorInfoGraph.add(LV_COLOR_NAVY, 2);
+	motorInfoGraph = new Graph(page, 150, 50, LV_HOR_RES - 150, LV_VER_RES - 50, -120, 120);
+	motorInfoGraph->addYGuide(0);
+	motorInfoGraph->add(LV_COLOR_LIME, 2);
+	motorInfoGraph->add(LV_COLOR_ORANGE, 2);
+	motorInfoGraph->add(LV_COLOR_TEAL, 2);
+	motorInfoGraph->add(LV_COLOR_NAVY, 2);
+	motorInfoGraph->add(LV_COLOR_MAGENTA, 2);
+	motorInfoGraph->add(LV_COLOR_RED, 2);
+
+	motorInfoRetestButton = new Button(page, 0, LV_VER_RES - 50, 150, 50);
+	motorInfoRetestButton->setStyle(LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_WHITE);
+	motorInfoRetestButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	motorInfoRetestButton->setId();
+	motorInfoRetestButton->setTitle("Retest Motor");
+
+	motorInfoVisionButton = new Button(page, 0, LV_VER_RES - 50, 150, 50);
+	motorInfoVisionButton->setStyle(LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_WHITE);
+	motorInfoVisionButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	motorInfoVisionButton->setId();
+	motorInfoVisionButton->setTitle("Test Vision");
+
+	updateMotorInfo();
+}
 
-	motorInfoRetestButton.setStyle(LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_MAKE(0x00, 0x65, 0xA0), LV_COLOR_WHITE);
-	motorInfoRetestButton.setAction(LV_BTN_ACTION_CLICK, clickAction);
-	motorInfoRetestButton.setId();
-	motorInfoRetestButton.setTitle("Retest Motor");
+void destroyMotorInfoPage()
+{
+	delete motorInfoTitle; motorInfoTitle = NULL;
+	delete motorInfoBackButton; motorInfoBackButton = NULL;
+	delete motorInfoGraph; motorInfoGraph = NULL;
+	delete motorInfoRetestButton; motorInfoRetestButton = NULL;
+	delete motorInfoVisionButton; motorInfoVisionButton = NULL;
+	motorInfoText = NULL;
+	motorInfoSwitch = NULL;
+}
 
-	controllerBackButton.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	controllerBackButton.setAction(LV_BTN_ACTION_CLICK, clickAction);
-	controllerBackButton.setId();
-	controllerBackButton.setTitle(SYMBOL_LEFT);
+void buildControllerPage(lv_obj_t * page)
+{
+	controllerTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	controllerBackButton = new Button(page, 0, 0, 75, 50);
 
-	controllerTitle.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	controllerTitle.setTitle("Test Controllers");
+	controllerBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	controllerBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	controllerBackButton->setId();
+	controllerBackButton->setTitle(SYMBOL_LEFT);
 
-	lv_style_copy(&ctrStyleOpen, &lv_style_plain);
-	lv_style_copy(&ctrStyleClosed, &lv_style_plain);
+	controllerTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	controllerTitle->setTitle("Test Controllers");
 
-	ctrStyleOpen.body.main_color = ctrStyleOpen.body.grad_color = LV_COLOR_WHITE;
-	ctrStyleOpen.body.border.width = 1;
-	ctrStyleOpen.body.border.color = LV_COLOR_NAVY;
-	ctrStyleOpen.body.radius = 100;
-	ctrStyleOpen.text.color = LV_COLOR_NAVY;
+	controllerLatencyButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+	controllerLatencyButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	controllerLatencyButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	controllerLatencyButton->setId();
+	controllerLatencyButton->setTitle("Latency");
 
-	ctrStyleClosed.body.main_color = ctrStyleClosed.body.grad_color = LV_COLOR_NAVY;
-	ctrStyleClosed.body.border.width = 1;
-	ctrStyleClosed.body.border.color = LV_COLOR_NAVY;
-	ctrStyleClosed.body.radius = 100;
-	ctrStyleClosed.text.color = LV_COLOR_WHITE;
+	ctrStyleOpen = styleGet(StyleKey(LV_COLOR_WHITE, LV_COLOR_NAVY).withBorder(LV_COLOR_NAVY, 1).withRadius(100));
+	ctrStyleClosed = styleGet(StyleKey(LV_COLOR_NAVY, LV_COLOR_WHITE).withBorder(LV_COLOR_NAVY, 1).withRadius(100));
 
 	for(int i = 0; i < 2; i++)
 	{
-		controller[i].title = new Button(controllerPage, i * LV_HOR_RES * 0.5, 50, LV_HOR_RES * 0.5, 45);
+		controller[i].title = new Button(page, i * LV_HOR_RES * 0.5, 50, LV_HOR_RES * 0.5, 45);
 		controller[i].title->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
 
-		controller[i].l2 = new Button(controllerPage, 5 + i * LV_HOR_RES * 0.5, 95, 50, 25);controller[i].l2->setTitle("L2");
-		controller[i].l1 = new Button(controllerPage, 5 + i * LV_HOR_RES * 0.5, 125, 50, 25);controller[i].l1->setTitle("L1");
-		controller[i].r2 = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 55, 95, 50, 25);controller[i].r2->setTitle("R2");
-		controller[i].r1 = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 55, 125, 50, 25);controller[i].r1->setTitle("R1");
+		controller[i].l2 = new Button(page, 5 + i * LV_HOR_RES * 0.5, 95, 50, 25);controller[i].l2->setTitle("L2");
+		controller[i].l1 = new Button(page, 5 + i * LV_HOR_RES * 0.5, 125, 50, 25);controller[i].l1->setTitle("L1");
+		controller[i].r2 = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 55, 95, 50, 25);controller[i].r2->setTitle("R2");
+		controller[i].r1 = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 55, 125, 50, 25);controller[i].r1->setTitle("R1");
 
-		controller[i].lJoyOuter = lv_obj_create(controllerPage, NULL);
+		controller[i].lJoyOuter = lv_obj_create(page, NULL);
 		lv_obj_set_pos(controller[i].lJoyOuter, 58 + i * LV_HOR_RES * 0.5, 95);
 		lv_obj_set_size(controller[i].lJoyOuter, 60, 60);
-		lv_obj_set_style(controller[i].lJoyOuter, &ctrStyleOpen);
+		lv_obj_set_style(controller[i].lJoyOuter, ctrStyleOpen);
 
 		controller[i].lJoyInner = lv_obj_create(controller[i].lJoyOuter, NULL);
 		lv_obj_set_pos(controller[i].lJoyInner, 25, 25);
 		lv_obj_set_size(controller[i].lJoyInner, 10, 10);
-		lv_obj_set_style(controller[i].lJoyInner, &ctrStyleClosed);
+		lv_obj_set_style(controller[i].lJoyInner, ctrStyleClosed);
 
-		controller[i].rJoyOuter = lv_obj_create(controllerPage, NULL);
+		controller[i].rJoyOuter = lv_obj_create(page, NULL);
 		lv_obj_set_pos(controller[i].rJoyOuter, (i + 1) * LV_HOR_RES * 0.5 - 118, 95);
 		lv_obj_set_size(controller[i].rJoyOuter, 60, 60);
-		lv_obj_set_style(controller[i].rJoyOuter, &ctrStyleOpen);
+		lv_obj_set_style(controller[i].rJoyOuter, ctrStyleOpen);
 
 		controller[i].rJoyInner = lv_obj_create(controller[i].rJoyOuter, NULL);
 		lv_obj_set_pos(controller[i].rJoyInner, 25, 25);
 		lv_obj_set_size(controller[i].rJoyInner, 10, 10);
-		lv_obj_set_style(controller[i].rJoyInner, &ctrStyleClosed);
+		lv_obj_set_style(controller[i].rJoyInner, ctrStyleClosed);
+
+		controller[i].up = new Button(page, 40 + i * LV_HOR_RES * 0.5, 155, 30, 30);controller[i].up->setTitle(SYMBOL_UP);
+		controller[i].right = new Button(page, 65 + i * LV_HOR_RES * 0.5, 180, 30, 30);controller[i].right->setTitle(SYMBOL_RIGHT);
+		controller[i].down = new Button(page, 40 + i * LV_HOR_RES * 0.5, 205, 30, 30);controller[i].down->setTitle(SYMBOL_DOWN);
+		controller[i].left = new Button(page, 15 + i * LV_HOR_RES * 0.5, 180, 30, 30);controller[i].left->setTitle(SYMBOL_LEFT);
+
+		controller[i].x = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 70, 155, 30, 30);controller[i].x->setTitle("X");
+		controller[i].a = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 45, 180, 30, 30);controller[i].a->setTitle("A");
+		controller[i].b = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 70, 205, 30, 30);controller[i].b->setTitle("B");
+		controller[i].y = new Button(page, (i + 1) * LV_HOR_RES * 0.5 - 95, 180, 30, 30);controller[i].y->setTitle("Y");
+	}
+}
+
+void destroyControllerPage()
+{
+	delete controllerTitle; controllerTitle = NULL;
+	delete controllerBackButton; controllerBackButton = NULL;
+	delete controllerLatencyButton; controllerLatencyButton = NULL;
+
+	for(int i = 0; i < 2; i++)
+	{
+		for(Button * button : {controller[i].title, controller[i].l2, controller[i].l1, controller[i].r2, controller[i].r1, controller[i].up,
+			controller[i].right, controller[i].down, controller[i].left, controller[i].x, controller[i].a, controller[i].b, controller[i].y}) delete button;
+		controller[i] = {};
+	}
+}
+
+void buildLatencyPage(lv_obj_t * page)
+{
+	latencyTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	latencyBackButton = new Button(page, 0, 0, 75, 50);
+	latencyResetButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+
+	latencyBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	latencyBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	latencyBackButton->setId();
+	latencyBackButton->setTitle(SYMBOL_LEFT);
+
+	latencyTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	latencyTitle->setTitle("Controller Latency");
+
+	latencyResetButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	latencyResetButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	latencyResetButton->setId();
+	latencyResetButton->setTitle("Reset");
+
+	latencyText = lv_label_create(page, NULL);
+	lv_obj_set_pos(latencyText, 3, 50);
+	lv_label_set_recolor(latencyText, true);
+	lv_obj_set_style(latencyText, &lv_style_plain);
+	lv_label_set_text(latencyText, "");
+
+	// Gaps between input changes (0-100 ms) above, operator round trips (0-1 s) below
+	int graphHeight = (LV_VER_RES - 50) / 2;
+	latencyIntervalGraph = new Graph(page, 230, 50, LV_HOR_RES - 230, graphHeight - 2, 0, 100, 0, CONTROLLER_INTERVAL_BINS);
+	latencyRttGraph = new Graph(page, 230, 50 + graphHeight, LV_HOR_RES - 230, graphHeight, 0, 100, 0, CONTROLLER_RTT_BINS);
+	for(Graph * graph : {latencyIntervalGraph, latencyRttGraph})
+	{
+		graph->addYGuide(0);
+		graph->add(LV_COLOR_NAVY, 2);
+		graph->add(LV_COLOR_ORANGE, 2);
+	}
+
+	lastLatencyUpdate = 0;
+}
+
+void destroyLatencyPage()
+{
+	delete latencyTitle; latencyTitle = NULL;
+	delete latencyBackButton; latencyBackButton = NULL;
+	delete latencyResetButton; latencyResetButton = NULL;
+	delete latencyIntervalGraph; latencyIntervalGraph = NULL;
+	delete latencyRttGraph; latencyRttGraph = NULL;
+	latencyText = NULL;
+}
+
+// Draws a histogram as steps scaled to its tallest bin
+void setHistogram(Graph * graph, int line, const uint32_t * bins, int count)
+{
+	uint32_t peak = 1;
+	for(int i = 0; i < count; i++) peak = std::max(peak, bins[i]);
+
+	std::vector<int> x, y;
+	for(int i = 0; i < count; i++)
+	{
+		int height = bins[i] * 100 / peak;
+		x.push_back(i);
+		y.push_back(height);
+		x.push_back(i + 1);
+		y.push_back(height);
+	}
+	graph->setPoints(line, x, y);
+}
+
+void updateLatency()
+{
+	PROFILE_ZONE(ZONE_CONTROLLER_PAGE);
 
-		controller[i].up = new Button(controllerPage, 40 + i * LV_HOR_RES * 0.5, 155, 30, 30);controller[i].up->setTitle(SYMBOL_UP);
-		controller[i].right = new Button(controllerPage, 65 + i * LV_HOR_RES * 0.5, 180, 30, 30);controller[i].right->setTitle(SYMBOL_RIGHT);
-		controller[i].down = new Button(controllerPage, 40 + i * LV_HOR_RES * 0.5, 205, 30, 30);controller[i].down->setTitle(SYMBOL_DOWN);
-		controller[i].left = new Button(controllerPage, 15 + i * LV_HOR_RES * 0.5, 180, 30, 30);controller[i].left->setTitle(SYMBOL_LEFT);
+	std::string a = "#000080 Master# #ffa500 Partner#\n" + controllerLatencyReport();
+	lv_label_set_text(latencyText, a.c_str());
 
-		controller[i].x = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 70, 155, 30, 30);controller[i].x->setTitle("X");
-		controller[i].a = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 45, 180, 30, 30);controller[i].a->setTitle("A");
-		controller[i].b = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 70, 205, 30, 30);controller[i].b->setTitle("B");
-		controller[i].y = new Button(controllerPage, (i + 1) * LV_HOR_RES * 0.5 - 95, 180, 30, 30);controller[i].y->setTitle("Y");
+	for(int i = 0; i < CONTROLLER_COUNT; i++)
+	{
+		ControllerLatency c = controllerLatencyGet(i);
+		setHistogram(latencyIntervalGraph, i, c.interval, CONTROLLER_INTERVAL_BINS);
+		setHistogram(latencyRttGraph, i, c.rtt, CONTROLLER_RTT_BINS);
 	}
+}
 
-	adiBackButton.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	adiBackButton.setAction(LV_BTN_ACTION_CLICK, clickAction);
-	adiBackButton.setId();
-	adiBackButton.setTitle(SYMBOL_LEFT);
+void buildVisionPage(lv_obj_t * page)
+{
+	visionTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	visionBackButton = new Button(page, 0, 0, 75, 50);
+	visionModeButton = new Button(page, LV_HOR_RES - 190, 0, 100, 50);
+	visionResetButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+
+	visionBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	visionBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	visionBackButton->setId();
+	visionBackButton->setTitle(SYMBOL_LEFT);
+
+	visionTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	visionTitle->setTitle("Vision");
+
+	visionModeButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	visionModeButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	visionModeButton->setId();
+	visionModeButton->setTitle(visionMode == VISION_READ_SIZE ? "By Size" : "By Sig 1");
+
+	visionResetButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	visionResetButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	visionResetButton->setId();
+	visionResetButton->setTitle("Reset");
+
+	visionText = lv_label_create(page, NULL);
+	lv_obj_set_pos(visionText, 3, 50);
+	lv_label_set_recolor(visionText, true);
+	lv_obj_set_style(visionText, &lv_style_plain);
+	lv_label_set_text(visionText, "");
+
+	// Gaps between fresh frames (0-100 ms), one line per exposure
+	visionGraph = new Graph(page, 230, 50, LV_HOR_RES - 230, LV_VER_RES - 50, 0, 100, 0, VISION_INTERVAL_BINS);
+	visionGraph->addYGuide(0);
+	for(int i = 0; i < VISION_EXPOSURE_STEPS; i++) visionGraph->add(visionColor[i], 2);
+
+	lastVisionUpdate = 0;
+}
+
+void destroyVisionPage()
+{
+	delete visionTitle; visionTitle = NULL;
+	delete visionBackButton; visionBackButton = NULL;
+	delete visionModeButton; visionModeButton = NULL;
+	delete visionResetButton; visionResetButton = NULL;
+	delete visionGraph; visionGraph = NULL;
+	visionText = NULL;
+}
+
+void updateVision()
+{
+	PROFILE_ZONE(ZONE_VISION_PAGE);
 
-	adiTitle.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	adiTitle.setTitle("Test 3-Wire Ports");
+	lv_label_set_text(visionText, visionBenchReport().c_str());
+
+	VisionBench bench = visionBenchGet();
+	for(int i = 0; i < VISION_EXPOSURE_STEPS; i++) setHistogram(visionGraph, i, bench.steps[i].interval, VISION_INTERVAL_BINS);
+}
+
+void buildAdiPage(lv_obj_t * page)
+{
+	adiTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	adiBackButton = new Button(page, 0, 0, 75, 50);
+
+	adiBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	adiBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	adiBackButton->setId();
+	adiBackButton->setTitle(SYMBOL_LEFT);
+
+	adiTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	adiTitle->setTitle("Test 3-Wire Ports");
+
+	adiScopeButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+	adiScopeButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	adiScopeButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	adiScopeButton->setId();
+	adiScopeButton->setTitle("Scope");
+
+	adiProbeButton = new Button(page, LV_HOR_RES - 180, 0, 90, 50);
+	adiProbeButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	adiProbeButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	adiProbeButton->setId();
+	adiProbeButton->setTitle("Probe");
 
 	lv_style_copy(&adiPortDisplayStyle, &lv_style_plain);
 	adiPortDisplayStyle.body.main_color = adiPortDisplayStyle.body.grad_color = LV_COLOR_NAVY;
@@ -557,385 +1131,745 @@ void opcontrol()
 
 	for(int i = 0; i < 8; i++)
 	{
-		pros::c::adi_pin_mode(i + 1, INPUT_ANALOG);
-		adiPortTitle[i] = new Button(adiPage, i * adiPortWidth, 50, adiPortWidth, 45);
+		adiPortTitle[i] = new Button(page, i * adiPortWidth, 50, adiPortWidth, 45);
 		adiPortTitle[i]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
 		std::string a = "Port\n" + (std::string)adiName[i];
 		adiPortTitle[i]->setTitle(a.c_str());
 
-		adiPortDisplay[i] = lv_obj_create(adiPage, NULL);
+		adiPortDisplay[i] = lv_obj_create(page, NULL);
 		lv_obj_set_style(adiPortDisplay[i], &adiPortDisplayStyle);
 
-		adiPortValue[i] = new Button(adiPage, i * adiPortWidth, LV_VER_RES - 45, adiPortWidth, 45);
+		adiPortValue[i] = new Button(page, i * adiPortWidth, LV_VER_RES - 45, adiPortWidth, 45);
 		adiPortValue[i]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
 	}
+}
 
-	infoBackButton.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	infoBackButton.setAction(LV_BTN_ACTION_CLICK, clickAction);
-	infoBackButton.setId();
-	infoBackButton.setTitle(SYMBOL_LEFT);
+void destroyAdiPage()
+{
+	delete adiTitle; adiTitle = NULL;
+	delete adiBackButton; adiBackButton = NULL;
+	delete adiScopeButton; adiScopeButton = NULL;
+	delete adiProbeButton; adiProbeButton = NULL;
 
-	infoTitle.setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-	infoTitle.setTitle("Extra Info");
+	for(int i = 0; i < 8; i++)
+	{
+		delete adiPortTitle[i]; adiPortTitle[i] = NULL;
+		delete adiPortValue[i]; adiPortValue[i] = NULL;
+		adiPortDisplay[i] = NULL;
+	}
+}
+
+void buildScopePage(lv_obj_t * page)
+{
+	scopeTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	scopeBackButton = new Button(page, 0, 0, 75, 50);
+
+	scopeBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	scopeBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	scopeBackButton->setId();
+	scopeBackButton->setTitle(SYMBOL_LEFT);
+
+	scopeTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	scopeTitle->setTitle("3-Wire Scope");
+
+	int channelWidth = LV_HOR_RES / ADI_SCOPE_CHANNELS;
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++)
+	{
+		scopeChannelButton[i] = new Button(page, i * channelWidth, 50, channelWidth, 30);
+		scopeChannelButton[i]->setAction(LV_BTN_ACTION_CLICK, clickAction);
+		scopeChannelButton[i]->setId();
+		scopeChannelButton[i]->setTitle(adiName[i]);
+	}
+
+	scopeView = new ScopeView(LV_VER_RES - 130);
+	scopeView->create(page, 0, 80);
+
+	Button ** control[] = {&scopeTriggerChannelButton, &scopeModeButton, &scopeLevelDownButton, &scopeLevelButton, &scopeLevelUpButton, &scopeArmButton};
+	int controlWidth = LV_HOR_RES / 6;
+	for(int i = 0; i < 6; i++)
+	{
+		*control[i] = new Button(page, i * controlWidth, LV_VER_RES - 50, controlWidth, 50);
+		(*control[i])->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+		(*control[i])->setAction(LV_BTN_ACTION_CLICK, clickAction);
+		(*control[i])->setId();
+	}
+	scopeLevelDownButton->setTitle(SYMBOL_MINUS);
+	scopeLevelUpButton->setTitle(SYMBOL_PLUS);
+
+	updateScopeControls();
+	lastScopeUpdate = 0;
+	scopeCaptureDrawn = false;
+}
+
+void destroyScopePage()
+{
+	delete scopeTitle; scopeTitle = NULL;
+	delete scopeBackButton; scopeBackButton = NULL;
+	delete scopeView; scopeView = NULL;
+
+	for(int i = 0; i < ADI_SCOPE_CHANNELS; i++)
+	{
+		delete scopeChannelButton[i]; scopeChannelButton[i] = NULL;
+	}
+	for(Button ** button : {&scopeTriggerChannelButton, &scopeModeButton, &scopeLevelDownButton, &scopeLevelButton, &scopeLevelUpButton, &scopeArmButton})
+	{
+		delete *button; *button = NULL;
+	}
+}
+
+void updateScope()
+{
+	PROFILE_ZONE(ZONE_ADI_PAGE);
 
-	infoText = lv_label_create(infoPage, NULL);
-	lv_obj_set_pos(infoText, 3, 50);
+	AdiScopeStatus status = adiScopeStatus();
+
+	char text[80];
+	if(status.state == ADI_SCOPE_TRIGGERED || status.state == ADI_SCOPE_CAPTURED)
+		snprintf(text, sizeof(text), "3-Wire Scope\n%s at %lu ms, %.0f Hz", scopeStateName[status.state], (unsigned long)status.triggerTime, status.rate);
+	else snprintf(text, sizeof(text), "3-Wire Scope\n%s, %.0f Hz, gap %lu us", scopeStateName[status.state], status.rate, (unsigned long)status.maxGapUs);
+	scopeTitle->setTitle(text);
+
+	// A finished capture is frozen, so it is drawn once
+	if(status.state == ADI_SCOPE_CAPTURED && scopeCaptureDrawn) return;
+	scopeCaptureDrawn = status.state == ADI_SCOPE_CAPTURED;
+
+	bool triggered = status.state == ADI_SCOPE_TRIGGERED || status.state == ADI_SCOPE_CAPTURED;
+	bool armed = triggered || status.state == ADI_SCOPE_ARMED;
+	scopeView->update(status.channels & scopeChannels, triggered ? status.triggerIndex : -1, armed ? scopeTrigger.level : -1);
+}
+
+void buildProbePage(lv_obj_t * page)
+{
+	probeTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	probeBackButton = new Button(page, 0, 0, 75, 50);
+	probeRescanButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+
+	probeBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	probeBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	probeBackButton->setId();
+	probeBackButton->setTitle(SYMBOL_LEFT);
+
+	probeTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	probeTitle->setTitle("Probe 3-Wire Ports");
+
+	probeRescanButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	probeRescanButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	probeRescanButton->setId();
+	probeRescanButton->setTitle("Rescan");
+
+	probeText = lv_label_create(page, NULL);
+	lv_obj_set_pos(probeText, 3, 53);
+	lv_obj_set_style(probeText, &lv_style_plain);
+	lv_label_set_text(probeText, "");
+
+	lastProbeUpdate = 0;
+}
+
+void destroyProbePage()
+{
+	delete probeTitle; probeTitle = NULL;
+	delete probeBackButton; probeBackButton = NULL;
+	delete probeRescanButton; probeRescanButton = NULL;
+	probeText = NULL;
+}
+
+void buildInfoPage(lv_obj_t * page)
+{
+	infoTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	infoBackButton = new Button(page, 0, 0, 75, 50);
+	infoTaskButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+
+	infoBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	infoBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	infoBackButton->setId();
+	infoBackButton->setTitle(SYMBOL_LEFT);
+
+	infoTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	infoTitle->setTitle("Extra Info");
+
+	infoScroll = lv_page_create(page, NULL);
+	lv_obj_set_pos(infoScroll, 0, 50);
+	lv_obj_set_size(infoScroll, LV_HOR_RES, LV_VER_RES - 50);
+	lv_page_set_style(infoScroll, LV_PAGE_STYLE_BG, &lv_style_plain);
+	lv_page_set_style(infoScroll, LV_PAGE_STYLE_SCRL, &lv_style_transp);
+	lv_page_set_sb_mode(infoScroll, LV_SB_MODE_AUTO);
+
+	infoText = lv_label_create(infoScroll, NULL);
+	lv_obj_set_pos(infoText, 3, 0);
 	lv_label_set_recolor(infoText, true);
 	lv_obj_set_style(infoText, &lv_style_plain);
+	lv_label_set_text(infoText, "");
+
+	infoTaskButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	infoTaskButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	infoTaskButton->setId();
+	infoTaskButton->setTitle("Tasks");
+
+	infoHeadlessButton = new Button(page, LV_HOR_RES - 190, 0, 100, 50);
+	infoHeadlessButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	infoHeadlessButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	infoHeadlessButton->setId();
+	infoHeadlessButton->setTitle("Headless");
+
+	infoCableButton = new Button(page, 75, 0, 100, 50);
+	infoCableButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	infoCableButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	infoCableButton->setId();
+	infoCableButton->setTitle("Cables");
+
+	lastInfoUpdate = 0;
+}
+
+void destroyInfoPage()
+{
+	delete infoTitle; infoTitle = NULL;
+	delete infoBackButton; infoBackButton = NULL;
+	delete infoTaskButton; infoTaskButton = NULL;
+	delete infoHeadlessButton; infoHeadlessButton = NULL;
+	delete infoCableButton; infoCableButton = NULL;
+	infoScroll = NULL;
+	infoText = NULL;
+}
+
+void buildCablePage(lv_obj_t * page)
+{
+	cableTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	cableBackButton = new Button(page, 0, 0, 75, 50);
+	cableStartButton = new Button(page, LV_HOR_RES - 90, 0, 90, 50);
+
+	cableBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	cableBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	cableBackButton->setId();
+	cableBackButton->setTitle(SYMBOL_LEFT);
+
+	cableTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	cableTitle->setTitle("Cable Test");
+
+	cableStartButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	cableStartButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	cableStartButton->setId();
+	cableStartButton->setTitle("Start");
+
+	cableText = lv_label_create(page, NULL);
+	lv_obj_set_pos(cableText, 3, 53);
+	lv_label_set_recolor(cableText, true);
+	lv_obj_set_style(cableText, &lv_style_plain);
+	lv_label_set_text(cableText, "Loop a cable between two empty ports and press Start");
+
+	lastCableUpdate = 0;
+}
+
+void destroyCablePage()
+{
+	delete cableTitle; cableTitle = NULL;
+	delete cableBackButton; cableBackButton = NULL;
+	delete cableStartButton; cableStartButton = NULL;
+	cableText = NULL;
+}
+
+void buildTaskPage(lv_obj_t * page)
+{
+	taskTitle = new Button(page, 0, 0, LV_HOR_RES, 50);
+	taskBackButton = new Button(page, 0, 0, 75, 50);
+
+	taskBackButton->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	taskBackButton->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	taskBackButton->setId();
+	taskBackButton->setTitle(SYMBOL_LEFT);
+
+	taskTitle->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	taskTitle->setTitle("Tasks");
+
+	taskScroll = lv_page_create(page, NULL);
+	lv_obj_set_pos(taskScroll, 0, 50);
+	lv_obj_set_size(taskScroll, LV_HOR_RES, LV_VER_RES - 50);
+	lv_page_set_style(taskScroll, LV_PAGE_STYLE_BG, &lv_style_plain);
+	lv_page_set_style(taskScroll, LV_PAGE_STYLE_SCRL, &lv_style_transp);
+	lv_page_set_sb_mode(taskScroll, LV_SB_MODE_AUTO);
+
+	taskText = lv_label_create(taskScroll, NULL);
+	lv_obj_set_pos(taskText, 3, 0);
+	lv_obj_set_style(taskText, &lv_style_plain);
+	lv_label_set_text(taskText, taskMonitorReport().c_str());
+}
+
+void destroyTaskPage()
+{
+	delete taskTitle; taskTitle = NULL;
+	delete taskBackButton; taskBackButton = NULL;
+	taskScroll = NULL;
+	taskText = NULL;
+}
+
+void buildHeadlessPage(lv_obj_t * page)
+{
+	headlessStatus = new Button(page, 0, 0, LV_HOR_RES, LV_VER_RES);
+	headlessStatus->setStyle(LV_COLOR_BLACK, LV_COLOR_BLACK, LV_COLOR_WHITE);
+	headlessStatus->setAction(LV_BTN_ACTION_CLICK, clickAction);
+	headlessStatus->setId();
+	headlessStatus->setTitle("Headless");
+}
+
+void destroyHeadlessPage()
+{
+	delete headlessStatus; headlessStatus = NULL;
+}
+
+/**
+ * Pages are built the first time they are shown. Built pages stay cached
+ * until the memory they cost at build time (all three heaps) exceeds
+ * pageMemoryBudget, then the least recently shown ones are deleted. The
+ * overview is never deleted. Building and deleting happen in pageTask, which
+ * runs inside lv_task_handler() so it never races a refresh, and under
+ * UiLock so it never races the UI task updating a page's widgets.
+ */
+struct Page
+{
+	void (*build)(lv_obj_t * page);
+	void (*destroy)();
+	lv_obj_t * object;
+	int32_t cost;
+	uint32_t lastShown;
+};
+
+Page pages[] = {
+	{buildOverviewPage, NULL},
+	{buildMotorInfoPage, destroyMotorInfoPage},
+	{buildControllerPage, destroyControllerPage},
+	{buildAdiPage, destroyAdiPage},
+	{buildInfoPage, destroyInfoPage},
+	{buildTaskPage, destroyTaskPage},
+	{buildHeadlessPage, destroyHeadlessPage},
+	{buildScopePage, destroyScopePage},
+	{buildProbePage, destroyProbePage},
+	{buildLatencyPage, destroyLatencyPage},
+	{buildCablePage, destroyCablePage},
+	{buildVisionPage, destroyVisionPage},
+};
+const int pageCount = sizeof(pages) / sizeof(Page);
+
+int32_t pageMemoryBudget = 48 * 1024;
+// A page left this recently is kept, so flipping back to it doesn't rebuild it
+uint32_t pageEvictionDelay = 1000;
+int shownPage = -1;
+
+// Guards the page widgets, which the UI task updates and pageTask builds and deletes
+pros::mutex_t uiMutex = NULL;
+
+class UiLock
+{
+public:
+	UiLock() {pros::c::mutex_take(uiMutex, TIMEOUT_MAX);}
+	~UiLock() {pros::c::mutex_give(uiMutex);}
+};
 
+int32_t heapBytes()
+{
+	return memHeapCounter(HEAP_MALLOC).bytes + memHeapCounter(HEAP_NEW).bytes + memHeapCounter(HEAP_LVGL).bytes;
+}
+
+void trimPages(uint32_t now)
+{
 	while(true)
 	{
-		if(currentPage == 0) lv_obj_set_parent(allInfoPage, lv_scr_act());
-		if(currentPage == 1) lv_obj_set_parent(motorInfoPage, lv_scr_act());
-		if(currentPage == 2) lv_obj_set_parent(controllerPage, lv_scr_act());
-		if(currentPage == 3) lv_obj_set_parent(adiPage, lv_scr_act());
-		if(currentPage == 4) lv_obj_set_parent(infoPage, lv_scr_act());
+		int32_t total = 0;
+		int oldest = -1;
 
-		for(int i = 0; i < 21; i++)
+		for(int i = 0; i < pageCount; i++)
 		{
-			pros::c::v5_device_e_t port = pros::c::registry_get_plugged_type(i);
-
-			std::string a = "";
-			if(portData[i].state >= 100 && (portData[i].timedOut || !portData[i].motorWorking || !portData[i].currentWorking || !portData[i].breakModeWorking))
-				a += "    " + std::to_string(i + 1) + " " + SYMBOL_WARNING + "\n";
-			else a += std::to_string(i + 1) + "\n";
-			if(port == pros::c::E_DEVICE_MOTOR) a += "Motor";
-			if(port == pros::c::E_DEVICE_RADIO) a += "Radio";
-			if(port == pros::c::E_DEVICE_VISION) a += "Vision";
-			a += "\n";
-			if(portData[i].state >= 100)
-			{
-				if(portData[i].timedOut) a += "TO ERR";
-				else if(!portData[i].motorWorking) a += "NR ERR";
-				else if(!portData[i].currentWorking) a += "C ERR";
-				else if(!portData[i].breakModeWorking) a += "B ERR";
-				else
-				{
-					std::stringstream stream;
-					stream << std::fixed << std::setprecision(2) << portData[i].averageScore;
-					a += stream.str() + "%";
-				}
-			}
+			if(pages[i].object == NULL) continue;
+			total += pages[i].cost;
+			if(pages[i].destroy == NULL || i == currentPage || now - pages[i].lastShown < pageEvictionDelay) continue;
+			if(oldest == -1 || pages[i].lastShown < pages[oldest].lastShown) oldest = i;
+		}
 
-			box[i]->setTitle(a.c_str());
+		if(total <= pageMemoryBudget || oldest == -1) return;
 
-			if(port != portData[i].device && currentPage == 1) updateMotorInfo();
+		lv_obj_del(pages[oldest].object);
+		pages[oldest].destroy();
+		pages[oldest].object = NULL;
+	}
+}
 
-			if(port == pros::c::E_DEVICE_MOTOR)
-			{
-				if(portData[i].state == 0)
-				{
-					portData[i].lastPlug = pros::millis();
-					portData[i].device = port;
-					portData[i].state++;
-				}
-				if(portData[i].state == 1
-					&& pros::millis() - portData[i].lastPlug > 150
-					&& fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5) portData[i].state++;
-				if(portData[i].state == 2 && currentMotorsRunning < maxMotorsRunning)
-				{
-					currentMotorsRunning++;
-					portData[i].state++;
-					portData[i].testPoint = 0;
-					portData[i].testPointStep = 0;
-					portData[i].testingStart = pros::millis();
-					portData[i].start = pros::millis();
-					portData[i].testStart = pros::millis();
-					portData[i].motorWorking = false;
-					portData[i].currentWorking = false;
-				}
-				if(portData[i].state == 3)
-				{
-					int power = testPointList[portData[i].testPoint].voltage;
-
-					pros::c::motor_move_voltage(i + 1, power);
-					portData[i].requestedVoltageValue = power;
-
-					if(fabs(pros::c::motor_get_actual_velocity(i + 1)) > 10) portData[i].motorWorking = true;
-
-					if(pros::millis() - portData[i].start > 1000 && !portData[i].motorWorking)
-					{
-						portData[i].state = 8;
-						portData[i].testPoint = 0;
-						portData[i].testPointStep = 0;
-					}
-
-					if(fabs(portData[i].acceleration) > 500) portData[i].testPointStep = 1;
-					if(fabs(portData[i].acceleration) < 250 && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
-					if(fabs(portData[i].acceleration) > 300 && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
-					if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
-					{
-						portData[i].testPoint++;
-						portData[i].results.push_back({pros::c::motor_get_actual_velocity(i + 1), pros::c::motor_get_current_draw(i + 1)});
-						portData[i].testPointStep = 0;
-
-						if(portData[i].testPoint >= sizeof(testPointList) / sizeof(TestPoint))
-						{
-							currentMotorsRunning--;
-							pros::c::motor_move(i + 1, 0);
-							portData[i].state++;
-							portData[i].testPointStep = 0;
-							if(currentPage == 1 && motorSelected == i) updateMotorInfo();
-						}
-					}
-				}
-				if(portData[i].state == 4)
-				{
-					pros::c::motor_move_voltage(i + 1, 12000);
-					portData[i].requestedVoltageValue = 12000;
-
-					if(fabs(portData[i].acceleration) > 500) portData[i].testPointStep = 1;
-					if(fabs(portData[i].acceleration) < 250 && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
-					if(fabs(portData[i].acceleration) > 300 && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
-					if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
-					{
-						portData[i].start = pros::millis();
-						pros::c::motor_set_brake_mode(i + 1, pros::E_MOTOR_BRAKE_COAST);
-						pros::c::motor_move_voltage(i + 1, 0);
-						portData[i].requestedVoltageValue = 0;
-						portData[i].state++;
-						portData[i].testPointStep = 0;
-					}
-				}
-				if(portData[i].state == 5)
-				{
-					if(std::fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5)
-					{
-						portData[i].coastTime = pros::millis() - portData[i].start;
-						portData[i].state++;
-					}
-				}
-				if(portData[i].state == 6)
-				{
-					pros::c::motor_move_voltage(i + 1, 12000);
-					portData[i].requestedVoltageValue = 12000;
-
-					if(fabs(portData[i].acceleration) > 500) portData[i].testPointStep = 1;
-					if(fabs(portData[i].acceleration) < 250 && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
-					if(fabs(portData[i].acceleration) > 300 && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
-					if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
-					{
-						portData[i].start = pros::millis();
-						pros::c::motor_set_brake_mode(i + 1, pros::E_MOTOR_BRAKE_BRAKE);
-						pros::c::motor_move_voltage(i + 1, 0);
-						portData[i].requestedVoltageValue = 0;
-						portData[i].state++;
-						portData[i].testPointStep = 0;
-					}
-				}
-				if(portData[i].state == 7)
-				{
-					if(std::fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5)
-					{
-						portData[i].breakTime = pros::millis() - portData[i].start;
-						portData[i].state = 10;
-					}
-				}
-				if(portData[i].state == 8)
-				{
-					portData[i].start = pros::millis();
-					if(portData[i].requestedVoltageValue <= 0)
-					{
-						pros::c::motor_move_voltage(i + 1, 12000);
-						portData[i].requestedVoltageValue = 12000;
-					}
-					else
-					{
-						pros::c::motor_move_voltage(i + 1, -12000);
-						portData[i].requestedVoltageValue = -12000;
-					}
-					portData[i].state++;
-				}
-				if(portData[i].state == 9)
-				{
-					if(fabs(pros::c::motor_get_actual_velocity(i + 1)) > 10)
-					{
-						portData[i].motorWorking = true;
-						portData[i].testingStart = pros::millis();
-						portData[i].state = 3;
-					}
-
-					if(pros::millis() - portData[i].start > 1000 && !portData[i].motorWorking)
-					{
-						portData[i].state = 10;
-					}
-				}
-				if(portData[i].state == 10)
-				{
-					pros::c::motor_move_voltage(i + 1, 0);
-
-					double totalScore = 0;
-					int totalScoreValues = 0;
-
-					for(int a = 0; a < portData[i].results.size(); a++)
-					{
-						int testPoint = a % (sizeof(testPointList) / sizeof(TestPoint));
-
-						double ssPercent = portData[i].results[a].settleSpeed / (double)testPointList[testPoint].settleSpeed * 100.0 - 100.0;
-						double scPercent = testPointList[testPoint].settleCurrent / (double)(portData[i].results[a].settleCurrent + 0.0001) * 100.0 - 100.0;
-
-						totalScore += ssPercent;
-						totalScore += scPercent;
-						totalScoreValues += 2;
-
-						testResultSum[a].settleSpeed += portData[i].results[a].settleSpeed;
-						testResultSum[a].settleCurrent += portData[i].results[a].settleCurrent;
-					}
-
-					double bPercent = tanh((averageBreakTime - portData[i].breakTime) * 0.005) * 100.0;
-					if(bPercent > 10) bPercent = 10;
-
-					totalScore += portData[i].coastTime / (double)averageCoastTime * 100.0 - 100.0;
-					totalScoreValues++;
-
-					if(bPercent < -60) portData[i].breakModeWorking = false;
-					else
-					{
-						totalScore += tanh(abs(averageBreakTime - portData[i].breakTime) * 0.005) * -100.0;
-						totalScoreValues++;
-					}
-
-					coastTimeResultSum += portData[i].coastTime;
-					breakTimeResultSum += portData[i].breakTime;
-					totalResultCount++;
-
-					portData[i].averageScore = totalScore / totalScoreValues;
-
-					if(portData[i].averageScore < -40 || !portData[i].motorWorking || !portData[i].currentWorking || portData[i].timedOut || !portData[i].breakModeWorking)
-					{
-						portData[i].state = 102;
-						box[i]->setStyle(LV_COLOR_RED, LV_COLOR_RED, LV_COLOR_WHITE);
-					}
-					else if(portData[i].averageScore < -35)
-					{
-						portData[i].state = 101;
-						box[i]->setStyle(LV_COLOR_ORANGE, LV_COLOR_ORANGE, LV_COLOR_WHITE);
-					}
-					else
-					{
-						portData[i].state = 100;
-						box[i]->setStyle(LV_COLOR_GREEN, LV_COLOR_GREEN, LV_COLOR_WHITE);
-					}
-
-					if(currentPage == 1 && motorSelected == i) updateMotorInfo();
-				}
-
-				if(pros::millis() - portData[i].testingStart > testingTimeout && portData[i].state >= 3 && portData[i].state <= 9)
-				{
-					portData[i].state = 10;
-					portData[i].timedOut = true;
-				}
-
-				if(portData[i].state >= 3 && portData[i].state <= 9)
-				{
-					if(abs(pros::c::motor_get_current_draw(i + 1)) > 10) portData[i].currentWorking = true;
-				}
-
-				if(pros::millis() - portData[i].lastReading > readingInterval && portData[i].state >= 3 && portData[i].state <= 9)
-				{
-					portData[i].time.push_back(pros::millis());
-					portData[i].appliedVoltage.push_back(pros::c::motor_get_voltage(i + 1));
-					portData[i].requestedVoltage.push_back(portData[i].requestedVoltageValue);
-					portData[i].current.push_back(pros::c::motor_get_current_draw(i + 1));
-					if(portData[i].velocity.size() == 0) portData[i].velocity.push_back(pros::c::motor_get_actual_velocity(i + 1));
-					else portData[i].velocity.push_back(portData[i].velocity.end()[-1] * 0.7 + pros::c::motor_get_actual_velocity(i + 1) * 0.3);
-
-					int velocityChange = portData[i].velocity.end()[-1] - portData[i].velocity.end()[-2];
-					int timeChange = portData[i].time.end()[-1] - portData[i].time.end()[-2];
-					if(portData[i].velocity.size() > 2) portData[i].acceleration = portData[i].acceleration * 0.7 + velocityChange * 1000.0 / timeChange * 0.3;
-
-					portData[i].lastReading = pros::millis();
-					if(currentPage == 1 && motorSelected == i) updateMotorInfo();
-				}
-			}
-			else if(port == pros::c::E_DEVICE_RADIO) portData[i].device = port;
-			else if(port == pros::c::E_DEVICE_VISION) portData[i].device = port;
-			else if(portData[i].state != 0 && portData[i].device == pros::c::E_DEVICE_MOTOR)
+void showPage(int index, uint32_t now)
+{
+	Page & page = pages[index];
+
+	if(page.object == NULL)
+	{
+		int32_t before = heapBytes();
+
+		page.object = lv_obj_create(lv_scr_act(), NULL);
+		lv_obj_set_style(page.object, &lv_style_plain);
+		lv_obj_set_size(page.object, LV_HOR_RES, LV_VER_RES);
+		page.build(page.object);
+
+		page.cost = heapBytes() - before;
+	}
+
+	if(index != shownPage)
+	{
+		lv_obj_set_parent(page.object, lv_scr_act());
+		shownPage = index;
+	}
+
+	page.lastShown = now;
+}
+
+void pageTask(void * parameter)
+{
+	UiLock lock;
+	uint32_t now = pros::millis();
+	showPage(currentPage, now);
+	trimPages(now);
+}
+
+void lvglRefreshMonitor(uint32_t time, uint32_t pixels)
+{
+	profilerRecord(ZONE_LVGL_REFRESH, time * 1000000ULL);
+}
+
+void updateOverview()
+{
+	PROFILE_ZONE(ZONE_OVERVIEW_PAGE);
+
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		EngineLock lock;
+		const PortData & port = portData[i];
+
+		std::string a = "";
+		if(port.state >= 100 && (port.timedOut || !port.motorWorking || !port.currentWorking || !port.breakModeWorking || !port.encoderWorking))
+			a += "    " + std::to_string(i + 1) + " " + SYMBOL_WARNING + "\n";
+		else a += std::to_string(i + 1) + "\n";
+		if(port.device == pros::c::E_DEVICE_MOTOR) a += "Motor";
+		if(port.device == pros::c::E_DEVICE_RADIO) a += "Radio";
+		if(port.device == pros::c::E_DEVICE_VISION) a += "Vision";
+		a += "\n";
+		if(port.state >= 100)
+		{
+			if(port.timedOut) a += "TO ERR";
+			else if(!port.motorWorking) a += "NR ERR";
+			else if(!port.currentWorking) a += "C ERR";
+			else if(!port.breakModeWorking) a += "B ERR";
+			else if(!port.encoderWorking) a += "E ERR";
+			else
 			{
-				if(portData[i].state >= 3 || portData[i].state <= 9) currentMotorsRunning--;
-
-				box[i]->setStyle(LV_COLOR_WHITE, LV_COLOR_WHITE, LV_COLOR_BLACK);
-
-				portData[i].lastReading = 0;
-				portData[i].time.clear();
-				portData[i].current.clear();
-				portData[i].velocity.clear();
-				portData[i].results.clear();
-				portData[i].coastTime = 0;
-				portData[i].breakTime = 0;
-
-				pros::c::motor_move(i + 1, 0);
-				portData[i].requestedVoltageValue = 0;
-				portData[i].device = port;
-				portData[i].state = 0;
-				portData[i].motorWorking = false;
-				portData[i].currentWorking = false;
-				portData[i].timedOut = false;
-				portData[i].breakModeWorking = true;
-
-				if(currentPage == 1 && motorSelected == i) updateMotorInfo();
+				std::stringstream stream;
+				stream << std::fixed << std::setprecision(2) << port.averageScore;
+				a += stream.str() + "%";
 			}
-			else portData[i].device = port;
 		}
 
-		for(int i = 0; i < 2; i++)
+		overviewGrid.setText(i, a.c_str());
+
+		if(port.state == 102) overviewGrid.setStyle(i, LV_COLOR_RED, LV_COLOR_WHITE);
+		else if(port.state == 101) overviewGrid.setStyle(i, LV_COLOR_ORANGE, LV_COLOR_WHITE);
+		else if(port.state == 100) overviewGrid.setStyle(i, LV_COLOR_GREEN, LV_COLOR_WHITE);
+		else overviewGrid.setStyle(i, LV_COLOR_WHITE, LV_COLOR_BLACK);
+	}
+}
+
+bool uiAttached = false;
+pros::task_t uiTask = NULL;
+uint32_t uiUpdateInterval = 20;
+uint32_t headlessUpdateInterval = 100;
+uint32_t headlessStatusInterval = 1000;
+const char * resultFile = "/usd/results.csv";
+const char * traceFile = "/usd/traces.bin";
+
+// Finished tests go to serial always and to the SD card when one is inserted
+void writeRecords()
+{
+	TestRecord record;
+	FILE * file = NULL;
+	FILE * traces = NULL;
+	bool opened = false;
+
+	while(enginePopRecord(record))
+	{
+		// Host tools (host/benchd) parse this line; keep new fields at the end
+		std::stringstream settle;
+		for(int a = 0; a < record.resultCount; a++) settle << (a ? "," : " settle=") << std::fixed << std::setprecision(1) << record.results[a].settleSpeed << ":" << record.results[a].settleCurrent;
+		printf("RESULT %lu port=%d state=%d score=%.2f coast=%d brake=%d to=%d nr=%d c=%d b=%d%s e=%d\n", (unsigned long)record.time, record.port + 1, record.state,
+			record.averageScore, record.coastTime, record.breakTime, record.timedOut, !record.motorWorking, !record.currentWorking, !record.breakModeWorking, settle.str().c_str(),
+			!record.encoderWorking);
+
+		if(!opened)
 		{
-			pros::controller_id_e_t id = i == 0 ? pros::E_CONTROLLER_MASTER : pros::E_CONTROLLER_PARTNER;
-			bool connected = pros::c::controller_is_connected(id);
-
-			std::string a = (i == 0 ? "Master" : "Partner") + (std::string)" Controller" + "\n";
-			if(connected) a += "#00FF00 Connected#";
-			else a += "#FF0000 Not Connected#";
-			controller[i].title->setTitle(a.c_str());
-
-			setButton(controller[i].l2, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_L2));
-			setButton(controller[i].l1, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_L1));
-			setButton(controller[i].r2, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_R2));
-			setButton(controller[i].r1, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_R1));
-
-			setButton(controller[i].up, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_UP));
-			setButton(controller[i].right, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_RIGHT));
-			setButton(controller[i].down, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_DOWN));
-			setButton(controller[i].left, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_LEFT));
-
-			setButton(controller[i].x, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_X));
-			setButton(controller[i].a, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_A));
-			setButton(controller[i].b, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_B));
-			setButton(controller[i].y, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_Y));
-
-			lv_obj_set_pos(controller[i].lJoyInner, map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_LEFT_X), -127, 127, 0, 50),
-				map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_LEFT_Y), -127, 127, 50, 0));
-			lv_obj_set_pos(controller[i].rJoyInner, map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_RIGHT_X), -127, 127, 0, 50),
-				map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_RIGHT_Y), -127, 127, 50, 0));
+			file = fopen(resultFile, "a");
+			traces = fopen(traceFile, "ab");
+			opened = true;
 		}
+		if(file != NULL) fprintf(file, "%lu,%d,%d,%.2f,%d,%d,%d,%d,%d,%d,%d\n", (unsigned long)record.time, record.port + 1, record.state,
+			record.averageScore, record.coastTime, record.breakTime, record.timedOut, record.motorWorking, record.currentWorking, record.breakModeWorking, record.encoderWorking);
+		if(traces != NULL) traceLogWrite(traces, record);
+	}
+
+	if(file != NULL) fclose(file);
+	if(traces != NULL) fclose(traces);
+}
+
+void updateHeadlessStatus()
+{
+	int running = 0;
+	int tested = 0;
+	{
+		EngineLock lock;
+		for(int i = 0; i < PORT_COUNT; i++) if(portData[i].state >= 3 && portData[i].state <= 9) running++;
+		tested = totalResultCount;
+	}
+
+	SampleTiming timing = engineSampleTiming(ENGINE_MODE_HEADLESS);
+	double rate = timing.sumUs == 0 ? 0 : timing.count * 1000000.0 / timing.sumUs;
+
+	char text[96];
+	snprintf(text, sizeof(text), "Headless\n%d tested, %d running\n%.0f Hz per port\nTap to return", tested, running, rate);
+	if(headlessStatus != NULL) headlessStatus->setTitle(text);
+}
 
-		for(int i = 0; i < 8; i++)
+// Refreshes the shown page's widgets and returns how long to sleep; the caller holds UiLock
+uint32_t uiUpdate()
+{
+	if(!uiAttached)
+	{
+		static uint32_t lastStatus = 0;
+		if(pros::millis() - lastStatus > headlessStatusInterval && currentPage == 6)
 		{
+			updateHeadlessStatus();
+			lastStatus = pros::millis();
+		}
+
+		memSample(pros::millis());
+		taskMonitorSample(pros::millis());
+		profilerStream(pros::millis());
+		taskMonitorStream(pros::millis());
+		memStream(pros::millis());
+
+		taskMonitorCountSwitch();
+		return headlessUpdateInterval;
+	}
 
-			int portValue = pros::c::adi_analog_read(i + 1);
-			int displayHeight = map(portValue, 0, 4095, 0, LV_VER_RES - 160);
+	uint32_t loopStart = profilerTicks();
 
-			lv_obj_set_pos(adiPortDisplay[i], (i + 0.5) * (LV_HOR_RES / 8) - 10, 105 + (LV_VER_RES - 160) - displayHeight);
-			lv_obj_set_size(adiPortDisplay[i], 20, displayHeight);
+	updateOverview();
 
-			std::string a = std::to_string(portValue) + "\n/4095";
-			adiPortValue[i]->setTitle(a.c_str());
+	if(currentPage == 1)
+	{
+		bool changed;
+		{
+			EngineLock lock;
+			changed = portData[motorSelected].revision != motorInfoRevision;
 		}
+		if(changed) updateMotorInfo();
+	}
+
+	for(int i = 0; i < 2 && currentPage == 2 && controller[i].title != NULL; i++)
+	{
+		PROFILE_ZONE(ZONE_CONTROLLER_PAGE);
+
+		pros::controller_id_e_t id = i == 0 ? pros::E_CONTROLLER_MASTER : pros::E_CONTROLLER_PARTNER;
+		bool connected = pros::c::controller_is_connected(id);
+
+		std::string a = (i == 0 ? "Master" : "Partner") + (std::string)" Controller" + "\n";
+		if(connected) a += "#00FF00 Connected#";
+		else a += "#FF0000 Not Connected#";
+		controller[i].title->setTitle(a.c_str());
+
+		setButton(controller[i].l2, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_L2));
+		setButton(controller[i].l1, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_L1));
+		setButton(controller[i].r2, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_R2));
+		setButton(controller[i].r1, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_R1));
+
+		setButton(controller[i].up, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_UP));
+		setButton(controller[i].right, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_RIGHT));
+		setButton(controller[i].down, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_DOWN));
+		setButton(controller[i].left, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_LEFT));
+
+		setButton(controller[i].x, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_X));
+		setButton(controller[i].a, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_A));
+		setButton(controller[i].b, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_B));
+		setButton(controller[i].y, pros::c::controller_get_digital(id, pros::E_CONTROLLER_DIGITAL_Y));
+
+		lv_obj_set_pos(controller[i].lJoyInner, map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_LEFT_X), -127, 127, 0, 50),
+			map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_LEFT_Y), -127, 127, 50, 0));
+		lv_obj_set_pos(controller[i].rJoyInner, map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_RIGHT_X), -127, 127, 0, 50),
+			map(pros::c::controller_get_analog(id, pros::E_CONTROLLER_ANALOG_RIGHT_Y), -127, 127, 50, 0));
+	}
+
+	for(int i = 0; i < 8 && currentPage == 3 && adiPortValue[i] != NULL; i++)
+	{
+		PROFILE_ZONE(ZONE_ADI_PAGE);
+
+		int portValue = pros::c::adi_analog_read(i + 1);
+		int displayHeight = map(portValue, 0, 4095, 0, LV_VER_RES - 160);
+
+		lv_obj_set_pos(adiPortDisplay[i], (i + 0.5) * (LV_HOR_RES / 8) - 10, 105 + (LV_VER_RES - 160) - displayHeight);
+		lv_obj_set_size(adiPortDisplay[i], 20, displayHeight);
+
+		std::string a = std::to_string(portValue) + "\n/4095";
+		adiPortValue[i]->setTitle(a.c_str());
+	}
+
+	if(currentPage == 7 && scopeView != NULL && pros::millis() - lastScopeUpdate > scopeUpdateInterval)
+	{
+		updateScope();
+		lastScopeUpdate = pros::millis();
+	}
+
+	if(currentPage == 9 && latencyText != NULL && pros::millis() - lastLatencyUpdate > latencyUpdateInterval)
+	{
+		updateLatency();
+		lastLatencyUpdate = pros::millis();
+	}
+
+	if(currentPage == 11 && visionText != NULL && pros::millis() - lastVisionUpdate > visionUpdateInterval)
+	{
+		updateVision();
+		lastVisionUpdate = pros::millis();
+	}
+
+	if(currentPage == 8 && probeText != NULL && pros::millis() - lastProbeUpdate > probeUpdateInterval)
+	{
+		PROFILE_ZONE(ZONE_ADI_PAGE);
+		lv_label_set_text(probeText, adiProbeReport().c_str());
+		lastProbeUpdate = pros::millis();
+	}
+
+	if(currentPage == 10 && cableText != NULL && cableTestStatus().phase != CABLE_IDLE && pros::millis() - lastCableUpdate > cableUpdateInterval)
+	{
+		lv_label_set_text(cableText, cableTestReport().c_str());
+		lastCableUpdate = pros::millis();
+	}
+
+	if(pros::millis() - lastInfoUpdate > infoUpdateInterval)
+	{
+		std::string a = "";
 
-		if(totalResultCount > 0)
 		{
-			std::string a = "";
+			EngineLock lock;
+			if(totalResultCount > 0)
+			{
+				for(int i = 0; i < 4; i++) a += "SS" + std::to_string(i + 1) + ": " + std::to_string(testResultCount[i] == 0 ? 0 : (int)testResultSum[i].settleSpeed / testResultCount[i]) + ", ";
+				a += "\n";
+				for(int i = 0; i < 4; i++) a += "SC" + std::to_string(i + 1) + ": " + std::to_string(testResultCount[i] == 0 ? 0 : testResultSum[i].settleCurrent / testResultCount[i]) + ", ";
+				a += "\n";
+				a += "C: " + std::to_string(coastTimeResultSum / totalResultCount) + "\n";
+				a += "B: " + std::to_string(breakTimeResultSum / totalResultCount) + "\n";
+			}
+		}
+
+		a += "\n" + engineTimingReport();
+		a += engineTraceReport();
+		a += traceLogReport();
+		a += checkpointReport();
+		a += adiScopeReport();
+		a += "\n" + profilerReport();
+		a += "\n" + memReport();
+		a += "Interned styles: " + std::to_string(styleCount()) + "\n";
+		if(firstMotorAdmitted >= 0) a += "First motor admitted at " + std::to_string(firstMotorAdmitted) + " ms\n";
+		a += "Page cost (B):";
+		for(int i = 0; i < pageCount; i++) if(pages[i].object != NULL) a += " " + std::to_string(i) + "=" + std::to_string(pages[i].cost);
+		a += "\n";
+
+		if(currentPage == 4 && infoText != NULL) lv_label_set_text(infoText, a.c_str());
+		lastInfoUpdate = pros::millis();
+	}
+
+	if(taskMonitorSample(pros::millis()) && currentPage == 5 && taskText != NULL) lv_label_set_text(taskText, taskMonitorReport().c_str());
+
+	memSample(pros::millis());
+
+	profilerStream(pros::millis());
+	taskMonitorStream(pros::millis());
+	memStream(pros::millis());
+	profilerRecord(ZONE_UI_LOOP, profilerTicksToNs(profilerTicks() - loopStart));
+
+	taskMonitorCountSwitch();
+	return uiUpdateInterval;
+}
+
+void uiLoop(void * parameter)
+{
+	lv_refr_set_monitor_cb(lvglRefreshMonitor);
+
+	for(int i = 0; i < 8; i++) pros::c::adi_pin_mode(i + 1, INPUT_ANALOG);
+
+	for(int i = 0; i < 24; i++) overviewGrid.setStyle(i, LV_COLOR_WHITE, LV_COLOR_BLACK);
 
-			for(int i = 0; i < 4; i++) a += "SS" + std::to_string(i + 1) + ": " + std::to_string((int)testResultSum[i].settleSpeed / totalResultCount) + ", ";
-			a += "\n";
-			for(int i = 0; i < 4; i++) a += "SC" + std::to_string(i + 1) + ": " + std::to_string(testResultSum[i].settleCurrent / totalResultCount) + ", ";
-			a += "\n";
-			a += "C: " + std::to_string(coastTimeResultSum / totalResultCount) + "\n";
-			a += "B: " + std::to_string(breakTimeResultSum / totalResultCount) + "\n";
+	overviewGrid.setText(21, "Test\nControl-\nlers");
+	overviewGrid.setText(22, "Test\n3-Wire\nPorts");
+	overviewGrid.setText(23, "Extra\nInfo");
 
-			lv_label_set_text(infoText, a.c_str());
+	lv_task_create(pageTask, 20, LV_TASK_PRIO_MID, NULL);
+
+	while(true)
+	{
+		// A page asked for by uiShowPage() from another task
+		int request = __atomic_exchange_n(&pageRequest, -1, __ATOMIC_ACQ_REL);
+		if(request >= 0 && uiAttached)
+		{
+			currentPage = request & 0xff;
+			if(currentPage == 1 || currentPage == 11) motorSelected = request >> 8;
 		}
 
-		pros::delay(3);
+		writeRecords();
+		checkpointSave(pros::millis());
+
+		// The scope samples only while it is on screen
+		if(uiAttached && currentPage == 7) adiScopeStart(scopeChannels);
+		else adiScopeStop();
+
+		// Entering the probe page starts a scan; leaving it puts every port back to analog
+		static bool probing = false;
+		if(uiAttached && currentPage == 8 && !probing) adiProbeStart();
+		if(!(uiAttached && currentPage == 8) && probing) adiProbeStop();
+		probing = uiAttached && currentPage == 8;
+
+		if(uiAttached && currentPage == 9) controllerLatencyStart();
+		else controllerLatencyStop();
+
+		// Leaving the cable page ends a test so no port is left in serial mode
+		if(!(uiAttached && currentPage == 10)) cableTestStop();
+
+		// Leaving the vision page puts the sensor's exposure back
+		if(uiAttached && currentPage == 11) visionBenchStart(motorSelected, visionMode);
+		else visionBenchStop();
+
+		uint32_t interval;
+		{
+			UiLock lock;
+			interval = uiUpdate();
+		}
+		pros::delay(interval);
 	}
 }
+
+void uiAttach()
+{
+	if(engineGetMode() == ENGINE_MODE_HEADLESS) printf("BENCH %lu\n%s%s%s", (unsigned long)pros::millis(), engineTimingReport().c_str(), engineTraceReport().c_str(), traceLogReport().c_str());
+	engineSetMode(ENGINE_MODE_UI);
+
+	currentPage = 0;
+	uiAttached = true;
+	if(uiMutex == NULL) uiMutex = pros::c::mutex_create();
+	if(uiTask == NULL) uiTask = pros::c::task_create(uiLoop, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "UI");
+}
+
+bool uiShowPage(int page, int port)
+{
+	if(!uiAttached || page < 0 || page > 11 || page == 6 || ((page == 1 || page == 11) && (port < 0 || port >= PORT_COUNT))) return false;
+
+	__atomic_store_n(&pageRequest, page | (port & 0xff) << 8, __ATOMIC_RELEASE);
+	return true;
+}
+
+void uiDetach()
+{
+	uiAttached = false;
+	currentPage = 6;
+	engineSetMode(ENGINE_MODE_HEADLESS);
+}
+
+// The engine and UI tasks are started from initialize() and outlive every competition mode
+void opcontrol() {}
@@ -0,0 +1,168 @@
+#include <cstdio>
+#include <algorithm>
+#include "main.h"
+#include "profiler.hpp"
+
+#if !defined(__arm__)
+#include <ctime>
+#endif
+
+#if PROFILER_ENABLED
+
+static const char * zoneName[ZONE_COUNT] = {"Loop", "UILoop", "Poll", "State", "Sample", "Overview", "MotorInfo", "Ctrl", "ADI", "Ckpt", "RPC", "LVGL", "Scope", "Vision"};
+
+#define PROFILE_MIN_SHIFT 6
+#define PROFILE_SUB_SHIFT 3
+#define PROFILE_SUB_BUCKETS (1 << PROFILE_SUB_SHIFT)
+#define PROFILE_BUCKETS ((32 - PROFILE_MIN_SHIFT) * PROFILE_SUB_BUCKETS + 1)
+
+struct ProfileZone
+{
+	uint32_t count = 0;
+	uint32_t minNs = UINT32_MAX;
+	uint32_t maxNs = 0;
+	uint64_t totalNs = 0;
+	uint32_t bucket[PROFILE_BUCKETS] = {};
+};
+
+static ProfileZone zones[ZONE_COUNT];
+static pros::mutex_t profilerMutex = NULL;
+
+// Does nothing before profilerInit(), when only one task runs
+class ProfileLock
+{
+public:
+	ProfileLock() {if(profilerMutex != NULL) pros::c::mutex_take(profilerMutex, TIMEOUT_MAX);}
+	~ProfileLock() {if(profilerMutex != NULL) pros::c::mutex_give(profilerMutex);}
+};
+
+#if defined(__arm__)
+// CPU1 runs at 666.67 MHz, so one cycle is 1.5 ns
+uint32_t profilerTicks()
+{
+	uint32_t cycles;
+	asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(cycles));
+	return cycles;
+}
+
+uint64_t profilerTicksToNs(uint32_t ticks) {return ticks * 3ULL / 2;}
+
+void profilerInit()
+{
+	if(profilerMutex == NULL) profilerMutex = pros::c::mutex_create();
+
+	// PMCR: enable counters and reset the cycle counter, PMCNTENSET: enable PMCCNTR
+	asm volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(0x5));
+	asm volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(0x80000000));
+}
+#else
+uint32_t profilerTicks()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+uint64_t profilerTicksToNs(uint32_t ticks) {return ticks;}
+
+void profilerInit() {if(profilerMutex == NULL) profilerMutex = pros::c::mutex_create();}
+#endif
+
+static int bucketOf(uint32_t ns)
+{
+	if(ns < (1u << PROFILE_MIN_SHIFT)) return 0;
+	int msb = 31 - __builtin_clz(ns);
+	int sub = (ns >> (msb - PROFILE_SUB_SHIFT)) & (PROFILE_SUB_BUCKETS - 1);
+	return (msb - PROFILE_MIN_SHIFT) * PROFILE_SUB_BUCKETS + sub + 1;
+}
+
+static uint32_t bucketUpperBound(int bucket)
+{
+	if(bucket == 0) return 1u << PROFILE_MIN_SHIFT;
+	int msb = (bucket - 1) / PROFILE_SUB_BUCKETS + PROFILE_MIN_SHIFT;
+	int sub = (bucket - 1) % PROFILE_SUB_BUCKETS + 1;
+	return (uint32_t)((1ULL << msb) + ((uint64_t)sub << (msb - PROFILE_SUB_SHIFT)) - 1);
+}
+
+void profilerRecord(ProfileZoneId zone, uint64_t ns)
+{
+	// The histogram and extremes stop at ~4 s; the total keeps the full time
+	uint32_t clamped = (uint32_t)std::min(ns, (uint64_t)UINT32_MAX);
+
+	ProfileLock lock;
+	ProfileZone & z = zones[zone];
+	z.count++;
+	z.totalNs += ns;
+	if(clamped < z.minNs) z.minNs = clamped;
+	if(clamped > z.maxNs) z.maxNs = clamped;
+	z.bucket[bucketOf(clamped)]++;
+}
+
+void profilerReset()
+{
+	ProfileLock lock;
+	for(int i = 0; i < ZONE_COUNT; i++) zones[i] = ProfileZone();
+}
+
+static uint32_t percentile(const ProfileZone & z, double fraction)
+{
+	uint32_t target = (uint32_t)(z.count * fraction);
+	uint32_t seen = 0;
+	for(int i = 0; i < PROFILE_BUCKETS; i++)
+	{
+		seen += z.bucket[i];
+		if(seen > target) return std::min(std::max(bucketUpperBound(i), z.minNs), z.maxNs);
+	}
+	return z.maxNs;
+}
+
+ProfileSummary profilerSummary(ProfileZoneId zone)
+{
+	ProfileLock lock;
+	const ProfileZone & z = zones[zone];
+	if(z.count == 0) return {0, 0, 0, 0, 0, 0};
+	return {z.count, z.minNs, percentile(z, 0.50), percentile(z, 0.99), z.maxNs, z.totalNs};
+}
+
+#endif
+
+std::string profilerReport()
+{
+#if PROFILER_ENABLED
+	std::string a = "Zone: n, min/p50/p99/max us\n";
+	char line[96];
+
+	for(int i = 0; i < ZONE_COUNT; i++)
+	{
+		ProfileSummary s = profilerSummary((ProfileZoneId)i);
+		if(s.count == 0) continue;
+		snprintf(line, sizeof(line), "%s: %lu, %lu/%lu/%lu/%lu\n", zoneName[i], (unsigned long)s.count,
+			(unsigned long)(s.minNs / 1000), (unsigned long)(s.p50Ns / 1000), (unsigned long)(s.p99Ns / 1000), (unsigned long)(s.maxNs / 1000));
+		a += line;
+	}
+
+	return a;
+#else
+	return "Profiling disabled\n";
+#endif
+}
+
+bool profilerStream(uint32_t now, uint32_t interval)
+{
+#if PROFILER_ENABLED
+	static uint32_t lastStream = 0;
+	if(now - lastStream < interval) return false;
+	lastStream = now;
+
+	for(int i = 0; i < ZONE_COUNT; i++)
+	{
+		ProfileSummary s = profilerSummary((ProfileZoneId)i);
+		if(s.count == 0) continue;
+		printf("PROF %lu %s n=%lu min=%lu p50=%lu p99=%lu max=%lu avg=%lu\n", (unsigned long)now, zoneName[i], (unsigned long)s.count,
+			(unsigned long)s.minNs, (unsigned long)s.p50Ns, (unsigned long)s.p99Ns, (unsigned long)s.maxNs, (unsigned long)(s.totalNs / s.count));
+	}
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include "main.h"
+#include "pros/apix.h"
+#include "rpc.hpp"
+#include "profiler.hpp"
+#include "taskMonitor.hpp"
+#include "testEngine.hpp"
+#include "ui.hpp"
+
+extern "C" int cobs_encode(uint8_t * dest, const uint8_t * src, const size_t src_len, const uint32_t prefix);
+
+#define RPC_SAMPLES_PER_FRAME ((RPC_MAX_FRAME - sizeof(RpcSampleHeader)) / sizeof(RpcSample))
+#define RPC_FRAMES_PER_STREAM_TICK 4
+
+static pros::task_t rpcTask = NULL;
+static pros::task_t streamTask = NULL;
+// Both are shared with the stream task and only touched under EngineLock
+static int streamPort = -1;
+static size_t streamNext = 0;
+uint32_t rpcStreamInterval = 10;
+
+static void sendFrame(uint32_t stream, const uint8_t * payload, size_t length)
+{
+	// Leading and trailing delimiters; the whole frame goes out in one write() so text can't split it
+	uint8_t buffer[(RPC_MAX_FRAME + 4) + (RPC_MAX_FRAME + 4 + 253) / 254 + 2];
+	buffer[0] = 0;
+	int encoded = cobs_encode(buffer + 1, payload, length, stream);
+	buffer[encoded + 1] = 0;
+	write(STDOUT_FILENO, buffer, encoded + 2);
+}
+
+static void respond(uint8_t command, uint8_t sequence, uint8_t status, const void * data = NULL, size_t length = 0)
+{
+	uint8_t payload[RPC_MAX_FRAME];
+	payload[0] = command | RPC_RESPONSE_FLAG;
+	payload[1] = sequence;
+	payload[2] = status;
+	length = std::min(length, sizeof(payload) - 3);
+	if(length > 0) memcpy(payload + 3, data, length);
+	sendFrame(RPC_STREAM_RESPONSE, payload, length + 3);
+}
+
+static void dumpResults(uint8_t sequence)
+{
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		RpcPortResult result;
+		{
+			EngineLock lock;
+			const PortData & port = portData[i];
+			if(port.state < 100) continue;
+
+			result.port = i + 1;
+			result.state = port.state;
+			result.flags = (port.timedOut ? RPC_TIMED_OUT : 0) | (port.motorWorking ? RPC_MOTOR_WORKING : 0)
+				| (port.currentWorking ? RPC_CURRENT_WORKING : 0) | (port.breakModeWorking ? RPC_BREAK_MODE_WORKING : 0) | (port.encoderWorking ? 0 : RPC_ENCODER_ERROR);
+			result.resultCount = std::min((int)port.results.size(), 8);
+			result.averageScore = port.averageScore;
+			result.coastTime = port.coastTime;
+			result.breakTime = port.breakTime;
+			for(int a = 0; a < result.resultCount; a++) result.result[a] = {(float)port.results[a].settleSpeed, (int16_t)port.results[a].settleCurrent};
+		}
+
+		respond(RPC_DUMP_RESULTS, sequence, RPC_MORE, &result, sizeof(result) - (8 - result.resultCount) * sizeof(RpcResult));
+	}
+
+	RpcSummary summary;
+	{
+		EngineLock lock;
+		summary.totalResultCount = totalResultCount;
+		summary.coastTimeResultSum = coastTimeResultSum;
+		summary.breakTimeResultSum = breakTimeResultSum;
+		for(int i = 0; i < testPointCount; i++) summary.resultSum[i] = {(float)testResultSum[i].settleSpeed, (int16_t)testResultSum[i].settleCurrent};
+		for(int i = 0; i < testPointCount; i++) summary.resultCount[i] = testResultCount[i];
+	}
+	respond(RPC_DUMP_RESULTS, sequence, RPC_OK, &summary, sizeof(summary));
+}
+
+static void handleRequest(const uint8_t * request, size_t length)
+{
+	PROFILE_ZONE(ZONE_RPC);
+
+	if(length < 2) return;
+	uint8_t command = request[0];
+	uint8_t sequence = request[1];
+	const uint8_t * argument = request + 2;
+	size_t argumentLength = length - 2;
+
+	switch(command)
+	{
+	case RPC_PING:
+		respond(command, sequence, RPC_OK);
+		break;
+
+	case RPC_RETEST:
+		if(argumentLength < 1 || argument[0] < 1 || argument[0] > PORT_COUNT) {respond(command, sequence, RPC_BAD_REQUEST); break;}
+		engineRetest(argument[0] - 1);
+		respond(command, sequence, RPC_OK);
+		break;
+
+	case RPC_ABORT:
+		engineAbort();
+		respond(command, sequence, RPC_OK);
+		break;
+
+	case RPC_RESUME:
+		engineResume();
+		respond(command, sequence, RPC_OK);
+		break;
+
+	case RPC_SET_PROFILE:
+	{
+		// A trailer of any other size means the host's structs don't match ours
+		if(argumentLength != sizeof(RpcProfile) && argumentLength != sizeof(RpcProfile) + sizeof(RpcTestOptions)) {respond(command, sequence, RPC_BAD_REQUEST); break;}
+		RpcProfile wire;
+		memcpy(&wire, argument, sizeof(wire));
+		if(wire.readingInterval == 0 || wire.headlessReadingInterval == 0 || wire.maxMotorsRunning == 0) {respond(command, sequence, RPC_BAD_REQUEST); break;}
+
+		TestProfile profile = engineGetProfile();
+		profile.testingTimeout = wire.testingTimeout;
+		profile.readingInterval = wire.readingInterval;
+		profile.headlessReadingInterval = wire.headlessReadingInterval;
+		profile.maxMotorsRunning = wire.maxMotorsRunning;
+		for(int i = 0; i < testPointCount; i++) profile.testPoint[i] = {wire.testPoint[i].voltage, wire.testPoint[i].settleSpeed, wire.testPoint[i].settleCurrent};
+
+		if(argumentLength == sizeof(RpcProfile) + sizeof(RpcTestOptions))
+		{
+			RpcTestOptions options;
+			memcpy(&options, argument + sizeof(RpcProfile), sizeof(options));
+			profile.velocityStepTest = options.velocityStepTest;
+			profile.velocityStepTimeout = options.velocityStepTimeout;
+			for(int i = 0; i < testPointCount; i++) profile.velocityStepList[i] = options.velocityStepList[i];
+			profile.positionTest = options.positionTest;
+			profile.positionTestBudget = options.positionTestBudget;
+			profile.positionMoveTimeout = options.positionMoveTimeout;
+			profile.positionMoveVelocity = options.positionMoveVelocity;
+			profile.positionTolerance = options.positionTolerance;
+			profile.positionErrorAllowance = options.positionErrorAllowance;
+			profile.rampSweepTest = options.rampSweepTest;
+			profile.rampSweepTime = options.rampSweepTime;
+			profile.rampMovingSpeed = options.rampMovingSpeed;
+			profile.encoderTest = options.encoderTest;
+			profile.encoderWindow = options.encoderWindow;
+			profile.encoderMinSpeed = options.encoderMinSpeed;
+			profile.encoderMaxAcceleration = options.encoderMaxAcceleration;
+			profile.encoderReversalLimit = options.encoderReversalLimit;
+			profile.encoderSkipTolerance = options.encoderSkipTolerance;
+			profile.encoderSkipLimit = options.encoderSkipLimit;
+			profile.encoderJitterLimit = options.encoderJitterLimit;
+		}
+
+		if(!engineProfileValid(profile)) respond(command, sequence, RPC_BAD_REQUEST);
+		else respond(command, sequence, engineSetProfile(profile) ? RPC_OK : RPC_BUSY);
+		break;
+	}
+
+	case RPC_GET_PROFILE:
+	{
+		TestProfile profile = engineGetProfile();
+		RpcProfile wire;
+		wire.testingTimeout = profile.testingTimeout;
+		wire.readingInterval = profile.readingInterval;
+		wire.headlessReadingInterval = profile.headlessReadingInterval;
+		wire.maxMotorsRunning = profile.maxMotorsRunning;
+		for(int i = 0; i < testPointCount; i++)
+			wire.testPoint[i] = {(int16_t)profile.testPoint[i].voltage, (float)profile.testPoint[i].settleSpeed, (int16_t)profile.testPoint[i].settleCurrent};
+
+		RpcTestOptions options;
+		options.velocityStepTest = profile.velocityStepTest;
+		options.velocityStepTimeout = profile.velocityStepTimeout;
+		for(int i = 0; i < testPointCount; i++) options.velocityStepList[i] = profile.velocityStepList[i];
+		options.positionTest = profile.positionTest;
+		options.positionTestBudget = profile.positionTestBudget;
+		options.positionMoveTimeout = profile.positionMoveTimeout;
+		options.positionMoveVelocity = profile.positionMoveVelocity;
+		options.positionTolerance = profile.positionTolerance;
+		options.positionErrorAllowance = profile.positionErrorAllowance;
+		options.rampSweepTest = profile.rampSweepTest;
+		options.rampSweepTime = profile.rampSweepTime;
+		options.rampMovingSpeed = profile.rampMovingSpeed;
+		options.encoderTest = profile.encoderTest;
+		options.encoderWindow = profile.encoderWindow;
+		options.encoderMinSpeed = profile.encoderMinSpeed;
+		options.encoderMaxAcceleration = profile.encoderMaxAcceleration;
+		options.encoderReversalLimit = profile.encoderReversalLimit;
+		options.encoderSkipTolerance = profile.encoderSkipTolerance;
+		options.encoderSkipLimit = profile.encoderSkipLimit;
+		options.encoderJitterLimit = profile.encoderJitterLimit;
+
+		uint8_t buffer[sizeof(wire) + sizeof(options)];
+		memcpy(buffer, &wire, sizeof(wire));
+		memcpy(buffer + sizeof(wire), &options, sizeof(options));
+		respond(command, sequence, RPC_OK, buffer, sizeof(buffer));
+		break;
+	}
+
+	case RPC_DUMP_RESULTS:
+		dumpResults(sequence);
+		break;
+
+	case RPC_STREAM_PORT:
+		if(argumentLength < 1 || argument[0] > PORT_COUNT) {respond(command, sequence, RPC_BAD_REQUEST); break;}
+		{
+			EngineLock lock;
+			streamPort = argument[0] - 1;
+			streamNext = 0;
+		}
+		respond(command, sequence, RPC_OK);
+		break;
+
+	case RPC_SHOW_PAGE:
+		if(argumentLength < 2 || !uiShowPage(argument[0], argument[1] - 1)) {respond(command, sequence, RPC_BAD_REQUEST); break;}
+		respond(command, sequence, RPC_OK);
+		break;
+
+	default:
+		respond(command, sequence, RPC_UNKNOWN_COMMAND);
+	}
+}
+
+static void rpcLoop(void * parameter)
+{
+	static uint8_t frame[RPC_MAX_FRAME + RPC_MAX_FRAME / 254 + 2];
+	static uint8_t request[sizeof(frame)];
+	size_t length = 0;
+	bool overflow = false;
+
+	while(true)
+	{
+		uint8_t byte;
+		if(read(STDIN_FILENO, &byte, 1) != 1)
+		{
+			pros::delay(1);
+			continue;
+		}
+
+		if(byte != 0)
+		{
+			if(length < sizeof(frame)) frame[length++] = byte;
+			else overflow = true;
+			continue;
+		}
+
+		int decoded = length == 0 || overflow ? -1 : cobsDecode(request, frame, length);
+		if(decoded > 0) handleRequest(request, decoded);
+
+		length = 0;
+		overflow = false;
+		taskMonitorCountSwitch();
+	}
+}
+
+static void streamLoop(void * parameter)
+{
+	uint8_t payload[RPC_MAX_FRAME];
+	RpcSampleHeader * header = (RpcSampleHeader *)payload;
+	RpcSample * sample = (RpcSample *)(payload + sizeof(RpcSampleHeader));
+
+	TraceSample values[RPC_SAMPLES_PER_FRAME];
+
+	while(true)
+	{
+		for(int frame = 0; frame < RPC_FRAMES_PER_STREAM_TICK; frame++)
+		{
+			int count = 0;
+			{
+				EngineLock lock;
+				if(streamPort < 0) break;
+				const PortData & data = portData[streamPort];
+				if(engineTraceLength(data) < streamNext) streamNext = 0;
+
+				header->port = streamPort + 1;
+				header->state = data.state;
+				header->firstIndex = streamNext;
+
+				// Reads the encoded trace once the test finishes, so the tail still goes out
+				count = engineTraceRead(data, streamNext, values, RPC_SAMPLES_PER_FRAME);
+				streamNext += count;
+			}
+			if(count == 0) break;
+
+			for(int i = 0; i < count; i++)
+			{
+				const int32_t * value = values[i].value;
+				sample[i] = {(uint32_t)value[TRACE_TIME], (int16_t)value[TRACE_APPLIED_VOLTAGE], (int16_t)value[TRACE_REQUESTED_VOLTAGE],
+					(int16_t)value[TRACE_CURRENT], (int16_t)value[TRACE_VELOCITY]};
+			}
+
+			header->count = count;
+			sendFrame(RPC_STREAM_SAMPLES, payload, sizeof(RpcSampleHeader) + count * sizeof(RpcSample));
+		}
+
+		taskMonitorCountSwitch();
+		pros::delay(rpcStreamInterval);
+	}
+}
+
+void rpcStart()
+{
+	if(rpcTask != NULL) return;
+
+	pros::c::serctl(SERCTL_DISABLE_COBS, NULL);
+	rpcTask = pros::c::task_create(rpcLoop, NULL, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "RPC");
+	streamTask = pros::c::task_create(streamLoop, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "RPC Stream");
+}
@@ -0,0 +1,56 @@
+#include <vector>
+#include "main.h"
+#include "styleCache.hpp"
+#include "memoryStats.hpp"
+
+struct InternedStyle
+{
+	StyleKey key;
+	lv_style_t * style;
+};
+
+static std::vector<InternedStyle> interned;
+static pros::mutex_t styleMutex = NULL;
+
+// Does nothing before styleInit(), when only one task runs
+class StyleLock
+{
+public:
+	StyleLock() {if(styleMutex != NULL) pros::c::mutex_take(styleMutex, TIMEOUT_MAX);}
+	~StyleLock() {if(styleMutex != NULL) pros::c::mutex_give(styleMutex);}
+};
+
+void styleInit()
+{
+	if(styleMutex == NULL) styleMutex = pros::c::mutex_create();
+}
+
+static bool sameKey(const StyleKey & a, const StyleKey & b)
+{
+	return a.body.full == b.body.full && a.text.full == b.text.full && a.border.full == b.border.full
+		&& a.borderWidth == b.borderWidth && a.radius == b.radius && a.lineSpace == b.lineSpace;
+}
+
+lv_style_t * styleGet(const StyleKey & key)
+{
+	StyleLock lock;
+	for(int i = 0; i < interned.size(); i++) if(sameKey(interned[i].key, key)) return interned[i].style;
+
+	lv_style_t * style = (lv_style_t *)memAlloc(MEM_STYLE, sizeof(lv_style_t));
+	lv_style_copy(style, &lv_style_plain);
+	style->body.main_color = style->body.grad_color = key.body;
+	style->body.border.color = key.border;
+	style->body.border.width = key.borderWidth;
+	style->body.radius = key.radius;
+	style->text.color = key.text;
+	style->text.line_space = key.lineSpace;
+
+	interned.push_back({key, style});
+	return style;
+}
+
+int styleCount()
+{
+	StyleLock lock;
+	return interned.size();
+}
@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "rtos/task.h"
+#include "taskMonitor.hpp"
+
+extern "C" task_t task_get_current(void);
+
+#define MAX_SWITCH_COUNTERS 8
+
+struct SwitchCounter
+{
+	task_t task = NULL;
+	volatile uint32_t count = 0;
+};
+
+struct TaskHistory
+{
+	uint32_t taskNumber;
+	uint32_t runTime;
+	uint32_t switches;
+};
+
+static SwitchCounter switchCounter[MAX_SWITCH_COUNTERS];
+
+static TaskStatus_t status[MAX_MONITORED_TASKS];
+static TaskUsage usage[MAX_MONITORED_TASKS];
+static int usageCount = 0;
+
+static TaskHistory history[MAX_MONITORED_TASKS];
+static int historyCount = 0;
+static uint32_t lastTotalRunTime = 0;
+static uint32_t lastSample = 0;
+static bool tooManyTasks = false;
+
+static const char * stateName[] = {"Run", "Rdy", "Blk", "Sus", "Del", "Inv"};
+
+void taskMonitorCountSwitch()
+{
+	task_t current = task_get_current();
+
+	for(int i = 0; i < MAX_SWITCH_COUNTERS; i++)
+	{
+		if(switchCounter[i].task == current) {switchCounter[i].count++; return;}
+		if(switchCounter[i].task == NULL)
+		{
+			switchCounter[i].task = current;
+			switchCounter[i].count = 1;
+			return;
+		}
+	}
+}
+
+static SwitchCounter * findSwitchCounter(task_t task)
+{
+	for(int i = 0; i < MAX_SWITCH_COUNTERS; i++) if(switchCounter[i].task == task) return &switchCounter[i];
+	return NULL;
+}
+
+bool taskMonitorSample(uint32_t now, uint32_t interval)
+{
+	if(lastSample != 0 && now - lastSample < interval) return false;
+
+	uint32_t totalRunTime = 0;
+	int count = uxTaskGetSystemState(status, MAX_MONITORED_TASKS, &totalRunTime);
+	tooManyTasks = count == 0;
+	if(count == 0) return false;
+
+	uint32_t totalDelta = totalRunTime - lastTotalRunTime;
+	uint32_t timeDelta = now - lastSample;
+	TaskHistory newHistory[MAX_MONITORED_TASKS];
+
+	for(int i = 0; i < count; i++)
+	{
+		TaskUsage & u = usage[i];
+		const TaskHistory * previous = NULL;
+		for(int a = 0; a < historyCount; a++) if(history[a].taskNumber == status[i].xTaskNumber) previous = &history[a];
+
+		SwitchCounter * counter = findSwitchCounter(status[i].xHandle);
+		uint32_t switches = counter == NULL ? 0 : counter->count;
+
+		strncpy(u.name, status[i].pcTaskName, sizeof(u.name) - 1);
+		u.name[sizeof(u.name) - 1] = '\0';
+		u.taskNumber = status[i].xTaskNumber;
+		u.priority = status[i].uxCurrentPriority;
+		u.state = status[i].eCurrentState;
+		u.stackFreeBytes = status[i].usStackHighWaterMark * sizeof(task_stack_t);
+		u.ownSwitchCount = counter != NULL;
+
+		if(previous != NULL && totalDelta > 0) u.cpuPercent = (status[i].ulRunTimeCounter - previous->runTime) * 100.0 / totalDelta;
+		else u.cpuPercent = 0;
+
+		if(previous != NULL && timeDelta > 0) u.switchRate = (switches - previous->switches) * 1000.0 / timeDelta;
+		else u.switchRate = 0;
+
+		newHistory[i] = {status[i].xTaskNumber, status[i].ulRunTimeCounter, switches};
+	}
+
+	std::copy(newHistory, newHistory + count, history);
+	historyCount = count;
+	usageCount = count;
+	lastTotalRunTime = totalRunTime;
+	lastSample = now;
+
+	std::sort(usage, usage + usageCount, [](const TaskUsage & a, const TaskUsage & b) {return a.cpuPercent > b.cpuPercent;});
+
+	return true;
+}
+
+int taskMonitorCount() {return usageCount;}
+
+const TaskUsage & taskMonitorGet(int index) {return usage[index];}
+
+std::string taskMonitorReport()
+{
+	if(tooManyTasks) return "More than " + std::to_string(MAX_MONITORED_TASKS) + " tasks\n";
+
+	std::string a = "Task: CPU%, free stack B, sw/s\n";
+	char line[96];
+
+	for(int i = 0; i < usageCount; i++)
+	{
+		const TaskUsage & u = usage[i];
+		if(u.ownSwitchCount) snprintf(line, sizeof(line), "%s (%s %lu): %.1f, %lu, %.0f\n", u.name, stateName[u.state], (unsigned long)u.priority, u.cpuPercent, (unsigned long)u.stackFreeBytes, u.switchRate);
+		else snprintf(line, sizeof(line), "%s (%s %lu): %.1f, %lu, -\n", u.name, stateName[u.state], (unsigned long)u.priority, u.cpuPercent, (unsigned long)u.stackFreeBytes);
+		a += line;
+	}
+
+	return a;
+}
+
+bool taskMonitorStream(uint32_t now, uint32_t interval)
+{
+	static uint32_t lastStream = 0;
+	if(now - lastStream < interval || usageCount == 0) return false;
+	lastStream = now;
+
+	for(int i = 0; i < usageCount; i++)
+	{
+		const TaskUsage & u = usage[i];
+		printf("TASK %lu %s prio=%lu state=%s cpu=%.2f stack=%lu sw=%.1f\n", (unsigned long)now, u.name, (unsigned long)u.priority,
+			stateName[u.state], u.cpuPercent, (unsigned long)u.stackFreeBytes, u.ownSwitchCount ? u.switchRate : -1.0);
+	}
+	return true;
+}
@@ -0,0 +1,1154 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "main.h"
+#include "pros/apix.h"
+#include "vdml/registry.h"
+#include "profiler.hpp"
+#include "taskMonitor.hpp"
+#include "checkpoint.hpp"
+#include "testEngine.hpp"
+
+int maxMotorsRunning = 8;
+int testingTimeout = 8000;
+int currentMotorsRunning = 0;
+PortData portData[PORT_COUNT];
+
+// The velocity and acceleration filters are per sample, so lowering these changes settle detection
+int readingInterval = 3;
+int headlessReadingInterval = 3;
+double errorPercent = 5;
+double settleStartAcceleration = 500;
+double settledAcceleration = 250;
+double unsettledAcceleration = 300;
+double failScore = -40;
+double warnScore = -35;
+TestPoint testPointList[] = {
+	{6000, 117, 70},
+	{12000, 237, 160},
+	{-6000, -117, 73},
+	{-12000, -236, 156},
+};
+
+int velocityStepTest = 0;
+int velocityStepTimeout = 1000;
+int velocityStepList[testPointCount] = {60, 150, -60, -150};
+
+int rampSweepTest = 0;
+int rampSweepTime = 1000;
+double rampMovingSpeed = 5;
+
+int positionTest = 0;
+int positionTestBudget = 2000;
+int positionMoveTimeout = 800;
+int positionMoveVelocity = 150;
+double positionTolerance = 3;
+double positionErrorAllowance = 5;
+PositionMove positionMoveList[] = {
+	{false, 90},
+	{false, 0},
+	{false, 90},
+	{false, 0},
+	{true, 90},
+	{true, -90},
+};
+
+int encoderTest = 0;
+int encoderWindow = 50;
+double encoderMinSpeed = 20;
+double encoderMaxAcceleration = 500;
+int encoderReversalLimit = 2;
+double encoderSkipTolerance = 10;
+double encoderSkipLimit = 20;
+double encoderJitterLimit = 15;
+
+int averageCoastTime = 885;
+int averageBreakTime = 196;
+
+TestPointResult testResultSum[testPointCount] = {{0, 0}, {0, 0}, {0, 0}, {0, 0}};
+int testResultCount[testPointCount] = {0, 0, 0, 0};
+int coastTimeResultSum = 0;
+int breakTimeResultSum = 0;
+int totalResultCount = 0;
+
+long firstMotorAdmitted = -1;
+
+#define RECORD_QUEUE_LENGTH 32
+
+static pros::mutex_t engineMutex = NULL;
+static pros::task_t engineTask = NULL;
+static volatile EngineMode engineMode = ENGINE_MODE_UI;
+static bool enginePaused = false;
+
+static SampleTiming sampleTiming[ENGINE_MODE_COUNT] = {};
+static uint64_t lastSampleUs[PORT_COUNT] = {};
+static const char * modeName[ENGINE_MODE_COUNT] = {"UI", "Headless"};
+
+static TestRecord recordQueue[RECORD_QUEUE_LENGTH];
+static int recordHead = 0;
+static int recordCount = 0;
+static uint32_t recordsDropped = 0;
+
+static TraceStats traceStats = {};
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+EngineLock::EngineLock() {pros::c::mutex_take(engineMutex, TIMEOUT_MAX);}
+
+EngineLock::~EngineLock() {pros::c::mutex_give(engineMutex);}
+
+static void resetPort(int i, int state)
+{
+	if(portData[i].state >= 3 || portData[i].state <= 9) currentMotorsRunning--;
+
+	portData[i].lastReading = 0;
+	portData[i].time.clear();
+	portData[i].appliedVoltage.clear();
+	portData[i].requestedVoltage.clear();
+	portData[i].current.clear();
+	portData[i].velocity.clear();
+	portData[i].results.clear();
+	portData[i].velocityResults.clear();
+	portData[i].velocityStep = -1;
+	portData[i].rampDone = false;
+	portData[i].rampStart = -1;
+	portData[i].rampFit = RampFit();
+	portData[i].positionResults.clear();
+	portData[i].positionMove = -1;
+	portData[i].trace.clear();
+	portData[i].traceKeyframes.clear();
+	portData[i].traceSamples = 0;
+	portData[i].coastTime = 0;
+	portData[i].breakTime = 0;
+
+	pros::c::motor_move(i + 1, 0);
+	lastSampleUs[i] = 0;
+	portData[i].requestedVoltageValue = 0;
+	portData[i].state = state;
+	portData[i].motorWorking = false;
+	portData[i].currentWorking = false;
+	portData[i].timedOut = false;
+	portData[i].breakModeWorking = true;
+	portData[i].encoder = EncoderCheck();
+	portData[i].encoderWorking = true;
+	portData[i].motorFaults = portData[i].motorFlags = portData[i].pointFaults = 0;
+	portData[i].events.clear();
+	portData[i].eventsDropped = 0;
+
+	portData[i].revision++;
+}
+
+void engineRetest(int port)
+{
+	EngineLock lock;
+	if(portData[port].device == pros::c::E_DEVICE_MOTOR) resetPort(port, 1);
+}
+
+static void queueRecord(int i)
+{
+	if(recordCount == RECORD_QUEUE_LENGTH)
+	{
+		recordHead = (recordHead + 1) % RECORD_QUEUE_LENGTH;
+		recordCount--;
+		recordsDropped++;
+	}
+
+	TestRecord & record = recordQueue[(recordHead + recordCount) % RECORD_QUEUE_LENGTH];
+	record.time = pros::millis();
+	record.port = i;
+	record.state = portData[i].state;
+	record.averageScore = portData[i].averageScore;
+	record.coastTime = portData[i].coastTime;
+	record.breakTime = portData[i].breakTime;
+	record.timedOut = portData[i].timedOut;
+	record.motorWorking = portData[i].motorWorking;
+	record.currentWorking = portData[i].currentWorking;
+	record.breakModeWorking = portData[i].breakModeWorking;
+	record.encoderWorking = portData[i].encoderWorking;
+	record.resultCount = std::min((int)portData[i].results.size(), 8);
+	for(int a = 0; a < record.resultCount; a++) record.results[a] = portData[i].results[a];
+	recordCount++;
+}
+
+bool enginePopRecord(TestRecord & record)
+{
+	EngineLock lock;
+	if(recordCount == 0) return false;
+
+	record = recordQueue[recordHead];
+	recordHead = (recordHead + 1) % RECORD_QUEUE_LENGTH;
+	recordCount--;
+	return true;
+}
+
+void engineAbort()
+{
+	EngineLock lock;
+	enginePaused = true;
+
+	for(int i = 0; i < PORT_COUNT; i++) if(portData[i].state >= 1 && portData[i].state <= 10) resetPort(i, 0);
+	currentMotorsRunning = 0;
+}
+
+void engineResume()
+{
+	EngineLock lock;
+	enginePaused = false;
+}
+
+bool engineIsPaused() {return enginePaused;}
+
+TestProfile engineGetProfile()
+{
+	EngineLock lock;
+	TestProfile profile;
+
+	profile.testingTimeout = testingTimeout;
+	profile.readingInterval = readingInterval;
+	profile.headlessReadingInterval = headlessReadingInterval;
+	profile.maxMotorsRunning = maxMotorsRunning;
+	for(int i = 0; i < testPointCount; i++) profile.testPoint[i] = testPointList[i];
+	profile.velocityStepTest = velocityStepTest;
+	profile.velocityStepTimeout = velocityStepTimeout;
+	for(int i = 0; i < testPointCount; i++) profile.velocityStepList[i] = velocityStepList[i];
+	profile.positionTest = positionTest;
+	profile.positionTestBudget = positionTestBudget;
+	profile.positionMoveTimeout = positionMoveTimeout;
+	profile.positionMoveVelocity = positionMoveVelocity;
+	profile.positionTolerance = positionTolerance;
+	profile.positionErrorAllowance = positionErrorAllowance;
+	profile.rampSweepTest = rampSweepTest;
+	profile.rampSweepTime = rampSweepTime;
+	profile.rampMovingSpeed = rampMovingSpeed;
+	profile.encoderTest = encoderTest;
+	profile.encoderWindow = encoderWindow;
+	profile.encoderMinSpeed = encoderMinSpeed;
+	profile.encoderMaxAcceleration = encoderMaxAcceleration;
+	profile.encoderReversalLimit = encoderReversalLimit;
+	profile.encoderSkipTolerance = encoderSkipTolerance;
+	profile.encoderSkipLimit = encoderSkipLimit;
+	profile.encoderJitterLimit = encoderJitterLimit;
+
+	return profile;
+}
+
+bool engineProfileValid(const TestProfile & profile)
+{
+	if(profile.testingTimeout <= 0 || profile.readingInterval <= 0 || profile.headlessReadingInterval <= 0 || profile.maxMotorsRunning <= 0) return false;
+	if(profile.velocityStepTimeout < 100 || profile.velocityStepTimeout > 10000) return false;
+	for(int i = 0; i < testPointCount; i++) if(profile.velocityStepList[i] == 0 || abs(profile.velocityStepList[i]) > 600) return false;
+	if(profile.positionTestBudget < 100 || profile.positionTestBudget > 20000) return false;
+	if(profile.positionMoveTimeout < 50 || profile.positionMoveTimeout > profile.positionTestBudget) return false;
+	if(profile.positionMoveVelocity <= 0 || profile.positionMoveVelocity > 600) return false;
+	if(profile.positionTolerance <= 0 || profile.positionErrorAllowance < 0) return false;
+
+	// Each of the four legs needs enough samples for the fits
+	if(profile.rampSweepTime < 400 || profile.rampSweepTime > 10000 || profile.rampMovingSpeed < 0) return false;
+
+	if(profile.encoderWindow < 10 || profile.encoderWindow > 1000) return false;
+	if(profile.encoderMinSpeed < 0 || profile.encoderMaxAcceleration <= 0 || profile.encoderReversalLimit < 0) return false;
+	if(profile.encoderSkipTolerance < 0 || profile.encoderSkipLimit < 0 || profile.encoderJitterLimit < 0) return false;
+	return true;
+}
+
+bool engineSetProfile(const TestProfile & profile)
+{
+	EngineLock lock;
+	for(int i = 0; i < PORT_COUNT; i++) if(portData[i].state >= 3 && portData[i].state <= 10) return false;
+
+	testingTimeout = profile.testingTimeout;
+	readingInterval = profile.readingInterval;
+	headlessReadingInterval = profile.headlessReadingInterval;
+	maxMotorsRunning = profile.maxMotorsRunning;
+	for(int i = 0; i < testPointCount; i++) testPointList[i] = profile.testPoint[i];
+	velocityStepTest = profile.velocityStepTest;
+	velocityStepTimeout = profile.velocityStepTimeout;
+	for(int i = 0; i < testPointCount; i++) velocityStepList[i] = profile.velocityStepList[i];
+	positionTest = profile.positionTest;
+	positionTestBudget = profile.positionTestBudget;
+	positionMoveTimeout = profile.positionMoveTimeout;
+	positionMoveVelocity = profile.positionMoveVelocity;
+	positionTolerance = profile.positionTolerance;
+	positionErrorAllowance = profile.positionErrorAllowance;
+	rampSweepTest = profile.rampSweepTest;
+	rampSweepTime = profile.rampSweepTime;
+	rampMovingSpeed = profile.rampMovingSpeed;
+	encoderTest = profile.encoderTest;
+	encoderWindow = profile.encoderWindow;
+	encoderMinSpeed = profile.encoderMinSpeed;
+	encoderMaxAcceleration = profile.encoderMaxAcceleration;
+	encoderReversalLimit = profile.encoderReversalLimit;
+	encoderSkipTolerance = profile.encoderSkipTolerance;
+	encoderSkipLimit = profile.encoderSkipLimit;
+	encoderJitterLimit = profile.encoderJitterLimit;
+
+	return true;
+}
+
+void engineSetMode(EngineMode mode)
+{
+	EngineLock lock;
+	if(mode == engineMode) return;
+
+	engineMode = mode;
+	for(int i = 0; i < PORT_COUNT; i++) lastSampleUs[i] = 0;
+}
+
+EngineMode engineGetMode() {return engineMode;}
+
+SampleTiming engineSampleTiming(EngineMode mode)
+{
+	EngineLock lock;
+	return sampleTiming[mode];
+}
+
+std::string engineTimingReport()
+{
+	double rate[ENGINE_MODE_COUNT], jitter[ENGINE_MODE_COUNT];
+	char line[112];
+	std::string a = "Sampling: n, Hz/port, sd us, max us\n";
+
+	for(int i = 0; i < ENGINE_MODE_COUNT; i++)
+	{
+		SampleTiming timing = engineSampleTiming((EngineMode)i);
+		double mean = timing.count == 0 ? 0 : timing.sumUs / (double)timing.count;
+		rate[i] = mean == 0 ? 0 : 1000000.0 / mean;
+		jitter[i] = timing.count == 0 ? 0 : sqrt(fmax(0, timing.sumSquaresUs / (double)timing.count - mean * mean));
+
+		snprintf(line, sizeof(line), "%s: %lu, %.1f, %.0f, %lu\n", modeName[i], (unsigned long)timing.count, rate[i], jitter[i], (unsigned long)timing.maxUs);
+		a += line;
+	}
+
+	if(rate[ENGINE_MODE_UI] > 0 && rate[ENGINE_MODE_HEADLESS] > 0)
+	{
+		snprintf(line, sizeof(line), "Headless gain: rate %+.0f%%, jitter %+.0f%%\n", (rate[ENGINE_MODE_HEADLESS] / rate[ENGINE_MODE_UI] - 1) * 100,
+			jitter[ENGINE_MODE_UI] == 0 ? 0 : (jitter[ENGINE_MODE_HEADLESS] / jitter[ENGINE_MODE_UI] - 1) * 100);
+		a += line;
+	}
+	if(recordsDropped > 0) a += "Result records dropped: " + std::to_string(recordsDropped) + "\n";
+
+	return a;
+}
+
+// Encodes the finished test's samples and frees the vectors they came from
+static void encodeTrace(int i)
+{
+	PortData & port = portData[i];
+	uint64_t start = vexSystemHighResTimeGet();
+
+	TraceEncoder encoder;
+	uint8_t sample[TRACE_MAX_SAMPLE_BYTES];
+	port.trace.clear();
+	port.traceKeyframes.clear();
+	port.trace.reserve(port.time.size() * 4);
+
+	for(size_t a = 0; a < port.time.size(); a++)
+	{
+		if(encoder.nextIsKeyframe()) port.traceKeyframes.push_back(port.trace.size());
+		TraceSample values = {{(int32_t)port.time[a], port.appliedVoltage[a], port.requestedVoltage[a], port.current[a], port.velocity[a]}};
+		size_t length = encoder.encode(values, sample);
+		port.trace.insert(port.trace.end(), sample, sample + length);
+	}
+	port.trace.shrink_to_fit();
+	port.traceSamples = encoder.samples();
+
+	PortVector<long>().swap(port.time);
+	PortVector<int>().swap(port.appliedVoltage);
+	PortVector<int>().swap(port.requestedVoltage);
+	PortVector<int>().swap(port.current);
+	PortVector<int>().swap(port.velocity);
+
+	traceStats.traces++;
+	traceStats.samples += port.traceSamples;
+	traceStats.rawBytes += port.traceSamples * (sizeof(long) + 4 * sizeof(int));
+	traceStats.encodedBytes += port.trace.size() + port.traceKeyframes.size() * sizeof(uint32_t);
+	traceStats.encodeUs += vexSystemHighResTimeGet() - start;
+}
+
+size_t engineTraceLength(const PortData & port) {return port.time.empty() ? port.traceSamples : port.time.size();}
+
+size_t engineTraceRead(const PortData & port, size_t first, TraceSample * out, size_t count)
+{
+	size_t length = engineTraceLength(port);
+	if(first >= length) return 0;
+	if(count > length - first) count = length - first;
+
+	if(!port.time.empty())
+	{
+		for(size_t a = 0; a < count; a++)
+		{
+			size_t i = first + a;
+			out[a] = {{(int32_t)port.time[i], port.appliedVoltage[i], port.requestedVoltage[i], port.current[i], port.velocity[i]}};
+		}
+		return count;
+	}
+
+	// Start at the keyframe before first and skip up to it
+	size_t keyframe = first / TRACE_KEYFRAME_INTERVAL;
+	if(keyframe >= port.traceKeyframes.size()) return 0;
+	size_t offset = port.traceKeyframes[keyframe];
+	TraceDecoder decoder(port.trace.data() + offset, port.trace.size() - offset);
+
+	TraceSample skipped;
+	for(size_t a = keyframe * TRACE_KEYFRAME_INTERVAL; a < first; a++) if(!decoder.next(skipped)) return 0;
+	for(size_t a = 0; a < count; a++) if(!decoder.next(out[a])) return a;
+	return count;
+}
+
+TraceStats engineTraceStats()
+{
+	EngineLock lock;
+	return traceStats;
+}
+
+std::string engineTraceReport()
+{
+	TraceStats stats = engineTraceStats();
+	char line[112];
+	snprintf(line, sizeof(line), "Traces: %lu, %lu samples, %.1fx smaller, %.2f us/sample\n", (unsigned long)stats.traces, (unsigned long)stats.samples,
+		stats.encodedBytes == 0 ? 0 : stats.rawBytes / (double)stats.encodedBytes, stats.samples == 0 ? 0 : stats.encodeUs / (double)stats.samples);
+	return line;
+}
+
+static VelocityStepResult measureVelocityStep(const PortData & port, int setpoint)
+{
+	VelocityStepResult result = {setpoint, -1, 0, -1, 0};
+	size_t first = port.velocityStepSample;
+	if(first >= port.velocity.size()) return result;
+
+	double start = first > 0 ? port.velocity[first - 1] : 0;
+	double step = setpoint - start;
+	if(step == 0) return result;
+	double direction = step > 0 ? 1 : -1;
+	double band = fabs(setpoint) * errorPercent / 100;
+
+	long rise10 = -1, rise90 = -1, lastOutside = port.velocityStepStart;
+	double peak = 0, errorSum = 0;
+	int errorCount = 0;
+	for(size_t a = first; a < port.velocity.size(); a++)
+	{
+		double progress = (port.velocity[a] - start) / step;
+		if(rise10 < 0 && progress >= 0.1) rise10 = port.time[a];
+		if(rise90 < 0 && progress >= 0.9) rise90 = port.time[a];
+		peak = std::max(peak, (port.velocity[a] - setpoint) * direction);
+		if(fabs(port.velocity[a] - setpoint) > band) lastOutside = port.time[a];
+		if(port.time[a] > port.time.back() - 100)
+		{
+			errorSum += port.velocity[a] - setpoint;
+			errorCount++;
+		}
+	}
+
+	if(rise90 >= 0) result.riseTime = rise90 - rise10;
+	result.overshoot = peak / fabs(step) * 100;
+	if(fabs(port.velocity.back() - setpoint) <= band) result.settleTime = lastOutside - port.velocityStepStart;
+	result.steadyStateError = errorSum / errorCount;
+	return result;
+}
+
+static void finishTestPoints(int i)
+{
+	currentMotorsRunning--;
+	pros::c::motor_move(i + 1, 0);
+	portData[i].state++;
+	portData[i].testPointStep = 0;
+	portData[i].revision++;
+}
+
+static void startVelocityStep(int i)
+{
+	pros::c::motor_move_velocity(i + 1, velocityStepList[portData[i].testPoint]);
+	portData[i].requestedVoltageValue = 0;
+	portData[i].velocityStep = portData[i].testPoint;
+	portData[i].velocityStepStart = pros::millis();
+	portData[i].velocityStepSample = portData[i].velocity.size();
+	portData[i].testPointStep = 0;
+}
+
+// Moves on from a finished test point, to the brake tests after the last one
+static void nextTestPoint(int i)
+{
+	portData[i].testPoint++;
+	portData[i].testPointStep = 0;
+	portData[i].pointFaults = 0;
+
+	if(portData[i].testPoint >= testPointCount) finishTestPoints(i);
+	// The ramp already covered every voltage, so only the velocity steps are left
+	else if(portData[i].rampDone) startVelocityStep(i);
+}
+
+// Raw counts per turn at the reported velocity's scale, which follows the set gearing
+static int encoderCountsPerTurn(int i)
+{
+	switch(pros::c::motor_get_gearing(i + 1))
+	{
+		case pros::E_MOTOR_GEARSET_36: return 1800;
+		case pros::E_MOTOR_GEARSET_18: return 900;
+		case pros::E_MOTOR_GEARSET_06: return 300;
+		default: return 0;
+	}
+}
+
+std::string engineFaultNames(uint32_t faults, uint32_t flags)
+{
+	std::string a;
+	if(faults & pros::E_MOTOR_FAULT_MOTOR_OVER_TEMP) a += " OT";
+	if(faults & pros::E_MOTOR_FAULT_DRIVER_FAULT) a += " DRV";
+	if(faults & pros::E_MOTOR_FAULT_OVER_CURRENT) a += " OC";
+	if(faults & pros::E_MOTOR_FAULT_DRV_OVER_CURRENT) a += " DOC";
+	if(flags & pros::E_MOTOR_FLAGS_BUSY) a += " BUSY";
+	return a.empty() ? "clear" : a.substr(1);
+}
+
+// Logs changes in the motor's faults and flags; called every tick while testing
+static void sampleFaults(int i)
+{
+	PortData & port = portData[i];
+	uint32_t faults = pros::c::motor_get_faults(i + 1);
+	uint32_t flags = pros::c::motor_get_flags(i + 1);
+	if(faults == PROS_ERR || flags == PROS_ERR) return;
+
+	flags &= MOTOR_EVENT_FLAGS;
+	port.pointFaults |= faults;
+	if(faults == port.motorFaults && flags == port.motorFlags) return;
+
+	port.motorFaults = faults;
+	port.motorFlags = flags;
+	if(port.events.size() < MOTOR_EVENT_LIMIT) port.events.push_back({pros::millis(), faults, flags});
+	else port.eventsDropped++;
+	port.revision++;
+}
+
+double engineEncoderJitter(const EncoderCheck & check) {return check.windows == 0 ? 0 : sqrt(check.sumSquares / check.windows);}
+
+// Called on every sample; holding is whether the test is holding a voltage
+static void encoderCheck(int i, bool holding)
+{
+	EncoderCheck & check = portData[i].encoder;
+	uint32_t stamp = 0;
+	int32_t count = holding ? pros::c::motor_get_raw_position(i + 1, &stamp) : PROS_ERR;
+	int countsPerTurn = encoderCountsPerTurn(i);
+	if(count == PROS_ERR || countsPerTurn == 0)
+	{
+		check.lastStamp = check.windowStamp = 0;
+		return;
+	}
+
+	// The motor reports every 10 ms; wait for a new reading
+	if(stamp == check.lastStamp) return;
+
+	int direction = portData[i].requestedVoltageValue > 0 ? 1 : -1;
+	double velocity = pros::c::motor_get_actual_velocity(i + 1);
+	bool moving = velocity * direction >= encoderMinSpeed && fabs(portData[i].acceleration) <= encoderMaxAcceleration;
+
+	if(moving && check.lastStamp != 0)
+	{
+		if((count - check.lastCount) * direction < -2) check.reversals++;
+		if(check.windowStamp != 0) check.windowExpected += velocity * (stamp - check.lastStamp) * countsPerTurn / 60000.0;
+	}
+
+	if(moving && check.windowStamp != 0 && stamp - check.windowStamp >= (uint32_t)encoderWindow)
+	{
+		double counted = count - check.windowCount;
+		double error = (counted - check.windowExpected) * 60000.0 / countsPerTurn / (stamp - check.windowStamp);
+		check.windows++;
+		check.sumSquares += error * error;
+		if((check.windowExpected - counted) * direction > fabs(check.windowExpected) * encoderSkipTolerance / 100 + 3) check.skips++;
+		check.windowStamp = 0;
+	}
+
+	if(!moving) check.windowStamp = 0;
+	else if(check.windowStamp == 0)
+	{
+		check.windowStamp = stamp;
+		check.windowCount = count;
+		check.windowExpected = 0;
+	}
+
+	check.lastCount = count;
+	check.lastStamp = stamp;
+}
+
+double engineRampValue(const double (&curve)[2][3], double voltage)
+{
+	const double * c = curve[voltage > 0 ? 0 : 1];
+	double v = voltage / 1000;
+	return c[0] + c[1] * v + c[2] * v * v;
+}
+
+// Least squares y = c[0] + c[1] x + c[2] x^2 from running sums
+struct QuadraticFit
+{
+	double x[5] = {};
+	double y[3] = {};
+
+	void add(double xi, double yi)
+	{
+		double power = 1;
+		for(int k = 0; k < 5; k++)
+		{
+			if(k < 3) y[k] += yi * power;
+			x[k] += power;
+			power *= xi;
+		}
+	}
+
+	bool solve(double (&c)[3]) const
+	{
+		if(x[0] < 10) return false;
+
+		double m[3][4];
+		for(int r = 0; r < 3; r++)
+		{
+			for(int k = 0; k < 3; k++) m[r][k] = x[r + k];
+			m[r][3] = y[r];
+		}
+		for(int p = 0; p < 3; p++)
+		{
+			int pivot = p;
+			for(int r = p + 1; r < 3; r++) if(fabs(m[r][p]) > fabs(m[pivot][p])) pivot = r;
+			if(fabs(m[pivot][p]) < 1e-9) return false;
+			for(int k = 0; k < 4; k++) std::swap(m[p][k], m[pivot][k]);
+			for(int r = 0; r < 3; r++)
+			{
+				if(r == p) continue;
+				double factor = m[r][p] / m[p][p];
+				for(int k = p; k < 4; k++) m[r][k] -= factor * m[p][k];
+			}
+		}
+		for(int r = 0; r < 3; r++) c[r] = m[r][3] / m[r][r];
+		return true;
+	}
+};
+
+static void fitRamp(int i)
+{
+	PortData & port = portData[i];
+	RampFit & fit = port.rampFit;
+	QuadraticFit velocity[2], current[2];
+	double start[2] = {0, 0}, stop[2] = {0, 0};
+
+	for(size_t a = port.rampSample; a < port.velocity.size(); a++)
+	{
+		double volts = port.appliedVoltage[a] / 1000.0;
+		if(volts == 0 || fabs(port.velocity[a]) < rampMovingSpeed) continue;
+
+		int direction = volts > 0 ? 0 : 1;
+		velocity[direction].add(volts, port.velocity[a]);
+		current[direction].add(volts, port.current[a]);
+
+		// Legs 0 and 2 ramp up, 1 and 3 back down
+		int leg = (port.time[a] - port.rampStart) * 4 / rampSweepTime;
+		if(leg % 2 == 0 && start[direction] == 0) start[direction] = fabs(volts);
+		if(leg % 2 == 1) stop[direction] = fabs(volts);
+	}
+
+	fit.valid = true;
+	for(int d = 0; d < 2; d++)
+	{
+		fit.valid = fit.valid && velocity[d].solve(fit.velocity[d]) && current[d].solve(fit.current[d]);
+		fit.deadBand[d] = (start[d] + stop[d]) / 2 * 1000;
+	}
+
+	if(fit.valid)
+	{
+		for(int d = 0; d < 2; d++)
+		{
+			double full = engineRampValue(fit.velocity, d == 0 ? 12000 : -12000);
+			fit.nonLinearity[d] = full == 0 ? 0 : fabs(fit.velocity[d][2] * 144 / full) * 100;
+		}
+		double reverse = fabs(engineRampValue(fit.velocity, -12000));
+		fit.asymmetry = reverse == 0 ? 0 : (fabs(engineRampValue(fit.velocity, 12000)) / reverse - 1) * 100;
+	}
+
+	// A failed fit leaves zeros for the score to fail on; a fault anywhere in the sweep taints every point
+	for(int a = 0; a < testPointCount; a++)
+	{
+		int voltage = testPointList[a].voltage;
+		if(fit.valid) port.results.push_back({engineRampValue(fit.velocity, voltage), (int)lround(engineRampValue(fit.current, voltage)), port.pointFaults});
+		else port.results.push_back({0, 0, port.pointFaults});
+	}
+
+	port.rampDone = true;
+	port.testPoint = 0;
+	port.testPointStep = 0;
+	port.revision++;
+	if(velocityStepTest) startVelocityStep(i);
+	else finishTestPoints(i);
+}
+
+static void rampTick(int i)
+{
+	PortData & port = portData[i];
+	if(port.rampStart < 0)
+	{
+		port.rampStart = pros::millis();
+		port.rampSample = port.velocity.size();
+		port.pointFaults = 0;
+	}
+
+	long elapsed = pros::millis() - port.rampStart;
+	if(elapsed >= rampSweepTime)
+	{
+		fitRamp(i);
+		return;
+	}
+
+	double phase = elapsed * 4.0 / rampSweepTime;
+	int leg = phase;
+	double fraction = leg % 2 == 0 ? phase - leg : 1 - (phase - leg);
+	int voltage = lround(12000 * fraction) * (leg < 2 ? 1 : -1);
+
+	pros::c::motor_move_voltage(i + 1, voltage);
+	port.requestedVoltageValue = voltage;
+
+	if(fabs(pros::c::motor_get_actual_velocity(i + 1)) > 10) port.motorWorking = true;
+	if(pros::millis() - port.start > 1000 && !port.motorWorking)
+	{
+		port.state = 8;
+		port.testPoint = 0;
+		port.testPointStep = 0;
+	}
+}
+
+static void velocityStepTick(int i)
+{
+	PortData & port = portData[i];
+	int setpoint = velocityStepList[port.velocityStep];
+
+	// Settled once within errorPercent of the setpoint for 100 ms, like the voltage test points
+	if(port.velocity.size() > port.velocityStepSample)
+	{
+		if(fabs(port.velocity.back() - setpoint) > fabs(setpoint) * errorPercent / 100) port.testPointStep = 0;
+		else if(port.testPointStep == 0)
+		{
+			port.testPointStep = 2;
+			port.testStart = pros::millis();
+		}
+	}
+
+	bool settled = port.testPointStep == 2 && pros::millis() - port.testStart > 100;
+	if(settled || pros::millis() - port.velocityStepStart > velocityStepTimeout)
+	{
+		port.velocityResults.push_back(measureVelocityStep(port, setpoint));
+		port.velocityStep = -1;
+		nextTestPoint(i);
+	}
+}
+
+PositionSummary enginePositionSummary(const PortData & port)
+{
+	PositionSummary summary = {(int)port.positionResults.size(), 0, 0, 0};
+	if(summary.moves == 0) return summary;
+
+	int reached = 0;
+	for(const PositionMoveResult & move : port.positionResults)
+	{
+		summary.meanError += fabs(move.error);
+		if(move.time >= 0)
+		{
+			summary.meanTime += move.time;
+			reached++;
+		}
+		if(move.relative) continue;
+
+		for(const PositionMoveResult & other : port.positionResults)
+			if(!other.relative && other.target == move.target) summary.spread = std::max(summary.spread, fabs(move.error - other.error));
+	}
+	summary.meanError /= summary.moves;
+	summary.meanTime = reached == 0 ? -1 : summary.meanTime / reached;
+	return summary;
+}
+
+static void startPositionMove(int i)
+{
+	PortData & port = portData[i];
+	const PositionMove & move = positionMoveList[port.positionMove];
+
+	port.positionTarget = move.relative ? pros::c::motor_get_position(i + 1) + move.target : move.target;
+	if(move.relative) pros::c::motor_move_relative(i + 1, move.target, positionMoveVelocity);
+	else pros::c::motor_move_absolute(i + 1, move.target, positionMoveVelocity);
+	port.positionMoveStart = pros::millis();
+	port.positionStillSince = 0;
+	port.positionReached = -1;
+}
+
+static void endPositionTest(int i)
+{
+	pros::c::motor_move_voltage(i + 1, 0);
+	portData[i].positionMove = -1;
+	portData[i].state = 10;
+}
+
+static void positionMoveTick(int i)
+{
+	PortData & port = portData[i];
+	long now = pros::millis();
+
+	if(now - port.positionTestStart > positionTestBudget)
+	{
+		endPositionTest(i);
+		return;
+	}
+
+	double error = pros::c::motor_get_position(i + 1) - port.positionTarget;
+	if(port.positionReached < 0 && fabs(error) <= positionTolerance) port.positionReached = now - port.positionMoveStart;
+
+	if(fabs(pros::c::motor_get_actual_velocity(i + 1)) >= 2) port.positionStillSince = 0;
+	else if(port.positionStillSince == 0) port.positionStillSince = now;
+
+	bool stopped = port.positionReached >= 0 && port.positionStillSince != 0 && now - port.positionStillSince > 50;
+	if(!stopped && now - port.positionMoveStart <= positionMoveTimeout) return;
+
+	port.positionResults.push_back({(int)lround(port.positionTarget), error, port.positionReached, positionMoveList[port.positionMove].relative});
+	port.revision++;
+
+	if(++port.positionMove >= positionMoveCount) endPositionTest(i);
+	else startPositionMove(i);
+}
+
+// testingTimeout plus the time the optional phases are allowed on top of it
+static long testingBudget()
+{
+	long budget = testingTimeout;
+	if(rampSweepTest) budget += rampSweepTime;
+	if(velocityStepTest) budget += (long)testPointCount * velocityStepTimeout;
+	if(positionTest) budget += positionTestBudget;
+	return budget;
+}
+
+void engineTick()
+{
+	for(int i = 0; i < PORT_COUNT; i++)
+	{
+		pros::c::v5_device_e_t port;
+		{
+			PROFILE_ZONE(ZONE_DEVICE_POLL);
+			port = pros::c::registry_get_plugged_type(i);
+		}
+
+		EngineLock lock;
+
+		if(port != portData[i].device) portData[i].revision++;
+
+		if(port == pros::c::E_DEVICE_MOTOR)
+		{
+			PROFILE_ZONE(ZONE_STATE_MACHINE);
+
+			if(portData[i].state == 0)
+			{
+				portData[i].lastPlug = pros::millis();
+				portData[i].device = port;
+				portData[i].state++;
+			}
+			if(portData[i].state == 1
+				&& pros::millis() - portData[i].lastPlug > 150
+				&& fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5) portData[i].state++;
+			if(portData[i].state == 2 && currentMotorsRunning < maxMotorsRunning && !enginePaused)
+			{
+				currentMotorsRunning++;
+				portData[i].state++;
+				portData[i].testPoint = 0;
+				portData[i].testPointStep = 0;
+				portData[i].testingStart = pros::millis();
+				portData[i].start = pros::millis();
+				portData[i].testStart = pros::millis();
+				portData[i].motorWorking = false;
+				portData[i].currentWorking = false;
+				portData[i].encoder = EncoderCheck();
+				portData[i].encoderWorking = true;
+				portData[i].motorFaults = portData[i].motorFlags = portData[i].pointFaults = 0;
+				portData[i].events.clear();
+				portData[i].eventsDropped = 0;
+				portData[i].rampDone = false;
+				portData[i].rampStart = -1;
+
+				if(firstMotorAdmitted < 0)
+				{
+					firstMotorAdmitted = pros::millis();
+					printf("STARTUP first motor admitted at %ld ms (port %d)\n", firstMotorAdmitted, i + 1);
+				}
+			}
+			if(portData[i].state == 3 && portData[i].velocityStep >= 0) velocityStepTick(i);
+			else if(portData[i].state == 3 && rampSweepTest && !portData[i].rampDone) rampTick(i);
+			else if(portData[i].state == 3)
+			{
+				int power = testPointList[portData[i].testPoint].voltage;
+
+				pros::c::motor_move_voltage(i + 1, power);
+				portData[i].requestedVoltageValue = power;
+
+				if(fabs(pros::c::motor_get_actual_velocity(i + 1)) > 10) portData[i].motorWorking = true;
+
+				if(pros::millis() - portData[i].start > 1000 && !portData[i].motorWorking)
+				{
+					portData[i].state = 8;
+					portData[i].testPoint = 0;
+					portData[i].testPointStep = 0;
+				}
+
+				if(fabs(portData[i].acceleration) > settleStartAcceleration) portData[i].testPointStep = 1;
+				if(fabs(portData[i].acceleration) < settledAcceleration && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
+				if(fabs(portData[i].acceleration) > unsettledAcceleration && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
+				if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
+				{
+					portData[i].results.push_back({pros::c::motor_get_actual_velocity(i + 1), pros::c::motor_get_current_draw(i + 1), portData[i].pointFaults});
+
+					if(velocityStepTest) startVelocityStep(i);
+					else nextTestPoint(i);
+				}
+			}
+			if(portData[i].state == 4)
+			{
+				pros::c::motor_move_voltage(i + 1, 12000);
+				portData[i].requestedVoltageValue = 12000;
+
+				if(fabs(portData[i].acceleration) > settleStartAcceleration) portData[i].testPointStep = 1;
+				if(fabs(portData[i].acceleration) < settledAcceleration && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
+				if(fabs(portData[i].acceleration) > unsettledAcceleration && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
+				if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
+				{
+					portData[i].start = pros::millis();
+					pros::c::motor_set_brake_mode(i + 1, pros::E_MOTOR_BRAKE_COAST);
+					pros::c::motor_move_voltage(i + 1, 0);
+					portData[i].requestedVoltageValue = 0;
+					portData[i].state++;
+					portData[i].testPointStep = 0;
+				}
+			}
+			if(portData[i].state == 5)
+			{
+				if(std::fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5)
+				{
+					portData[i].coastTime = pros::millis() - portData[i].start;
+					portData[i].state++;
+				}
+			}
+			if(portData[i].state == 6)
+			{
+				pros::c::motor_move_voltage(i + 1, 12000);
+				portData[i].requestedVoltageValue = 12000;
+
+				if(fabs(portData[i].acceleration) > settleStartAcceleration) portData[i].testPointStep = 1;
+				if(fabs(portData[i].acceleration) < settledAcceleration && portData[i].testPointStep == 1) {portData[i].testPointStep = 2;portData[i].testStart = pros::millis();}
+				if(fabs(portData[i].acceleration) > unsettledAcceleration && portData[i].testPointStep == 2) portData[i].testPointStep = 1;
+				if(pros::millis() - portData[i].testStart > 100 && portData[i].testPointStep == 2)
+				{
+					portData[i].start = pros::millis();
+					pros::c::motor_set_brake_mode(i + 1, pros::E_MOTOR_BRAKE_BRAKE);
+					pros::c::motor_move_voltage(i + 1, 0);
+					portData[i].requestedVoltageValue = 0;
+					portData[i].state++;
+					portData[i].testPointStep = 0;
+				}
+			}
+			if(portData[i].state == 7 && portData[i].positionMove >= 0) positionMoveTick(i);
+			else if(portData[i].state == 7)
+			{
+				if(std::fabs(pros::c::motor_get_actual_velocity(i + 1)) < 5)
+				{
+					portData[i].breakTime = pros::millis() - portData[i].start;
+
+					if(positionTest)
+					{
+						pros::c::motor_set_encoder_units(i + 1, pros::E_MOTOR_ENCODER_DEGREES);
+						pros::c::motor_tare_position(i + 1);
+						portData[i].positionMove = 0;
+						portData[i].positionTestStart = pros::millis();
+						startPositionMove(i);
+					}
+					else portData[i].state = 10;
+				}
+			}
+			if(portData[i].state == 8)
+			{
+				portData[i].velocityStep = -1;
+				portData[i].rampStart = -1;
+				portData[i].pointFaults = 0;
+				portData[i].start = pros::millis();
+				if(portData[i].requestedVoltageValue <= 0)
+				{
+					pros::c::motor_move_voltage(i + 1, 12000);
+					portData[i].requestedVoltageValue = 12000;
+				}
+				else
+				{
+					pros::c::motor_move_voltage(i + 1, -12000);
+					portData[i].requestedVoltageValue = -12000;
+				}
+				portData[i].state++;
+			}
+			if(portData[i].state == 9)
+			{
+				if(fabs(pros::c::motor_get_actual_velocity(i + 1)) > 10)
+				{
+					portData[i].motorWorking = true;
+					portData[i].testingStart = pros::millis();
+					portData[i].state = 3;
+				}
+
+				if(pros::millis() - portData[i].start > 1000 && !portData[i].motorWorking)
+				{
+					portData[i].state = 10;
+				}
+			}
+			if(portData[i].state == 10)
+			{
+				pros::c::motor_move_voltage(i + 1, 0);
+
+				double totalScore = 0;
+				int totalScoreValues = 0;
+				bool faulted = false;
+
+				for(size_t a = 0; a < portData[i].results.size(); a++)
+				{
+					int testPoint = a % (sizeof(testPointList) / sizeof(TestPoint));
+
+					// A brown-out or thermal cutback says nothing about the motor's normal speed and current
+					if(portData[i].results[a].faults != 0)
+					{
+						faulted = true;
+						continue;
+					}
+
+					double ssPercent = portData[i].results[a].settleSpeed / (double)testPointList[testPoint].settleSpeed * 100.0 - 100.0;
+					double scPercent = testPointList[testPoint].settleCurrent / (double)(portData[i].results[a].settleCurrent + 0.0001) * 100.0 - 100.0;
+
+					totalScore += ssPercent;
+					totalScore += scPercent;
+					totalScoreValues += 2;
+
+					testResultSum[a].settleSpeed += portData[i].results[a].settleSpeed;
+					testResultSum[a].settleCurrent += portData[i].results[a].settleCurrent;
+					testResultCount[a]++;
+				}
+
+				double bPercent = tanh((averageBreakTime - portData[i].breakTime) * 0.005) * 100.0;
+				if(bPercent > 10) bPercent = 10;
+
+				totalScore += portData[i].coastTime / (double)averageCoastTime * 100.0 - 100.0;
+				totalScoreValues++;
+
+				if(bPercent < -60) portData[i].breakModeWorking = false;
+				else
+				{
+					totalScore += tanh(abs(averageBreakTime - portData[i].breakTime) * 0.005) * -100.0;
+					totalScoreValues++;
+				}
+
+				PositionSummary position = enginePositionSummary(portData[i]);
+				if(position.moves > 0)
+				{
+					totalScore += tanh(std::max(0.0, position.meanError + position.spread - positionErrorAllowance) * 0.05) * -100.0;
+					totalScoreValues++;
+				}
+
+				coastTimeResultSum += portData[i].coastTime;
+				breakTimeResultSum += portData[i].breakTime;
+				totalResultCount++;
+
+				portData[i].averageScore = totalScore / totalScoreValues;
+
+				const EncoderCheck & encoder = portData[i].encoder;
+				portData[i].encoderWorking = encoder.windows == 0 || (encoder.reversals <= (uint32_t)encoderReversalLimit
+					&& encoder.skips * 100.0 / encoder.windows <= encoderSkipLimit && engineEncoderJitter(encoder) <= encoderJitterLimit);
+
+				if(portData[i].averageScore < failScore || !portData[i].motorWorking || !portData[i].currentWorking || portData[i].timedOut || !portData[i].breakModeWorking
+					|| !portData[i].encoderWorking) portData[i].state = 102;
+				else if(portData[i].averageScore < warnScore || faulted) portData[i].state = 101;
+				else portData[i].state = 100;
+
+				encodeTrace(i);
+				queueRecord(i);
+				portData[i].revision++;
+			}
+
+			if(pros::millis() - portData[i].testingStart > testingBudget() && portData[i].state >= 3 && portData[i].state <= 9)
+			{
+				portData[i].state = 10;
+				portData[i].timedOut = true;
+			}
+
+			if(portData[i].state >= 3 && portData[i].state <= 9)
+			{
+				if(abs(pros::c::motor_get_current_draw(i + 1)) > 10) portData[i].currentWorking = true;
+				sampleFaults(i);
+			}
+
+			int interval = engineMode == ENGINE_MODE_HEADLESS ? headlessReadingInterval : readingInterval;
+			if(pros::millis() - portData[i].lastReading > interval && portData[i].state >= 3 && portData[i].state <= 9)
+			{
+				PROFILE_ZONE(ZONE_SAMPLING);
+
+				uint64_t now = vexSystemHighResTimeGet();
+				if(lastSampleUs[i] != 0)
+				{
+					SampleTiming & timing = sampleTiming[engineMode];
+					uint32_t delta = now - lastSampleUs[i];
+					timing.count++;
+					timing.sumUs += delta;
+					timing.sumSquaresUs += (uint64_t)delta * delta;
+					if(delta > timing.maxUs) timing.maxUs = delta;
+				}
+				lastSampleUs[i] = now;
+
+				portData[i].time.push_back(pros::millis());
+				portData[i].appliedVoltage.push_back(pros::c::motor_get_voltage(i + 1));
+				portData[i].requestedVoltage.push_back(portData[i].requestedVoltageValue);
+				portData[i].current.push_back(pros::c::motor_get_current_draw(i + 1));
+				if(portData[i].velocity.size() == 0) portData[i].velocity.push_back(pros::c::motor_get_actual_velocity(i + 1));
+				else portData[i].velocity.push_back(portData[i].velocity.end()[-1] * 0.7 + pros::c::motor_get_actual_velocity(i + 1) * 0.3);
+
+				int velocityChange = portData[i].velocity.end()[-1] - portData[i].velocity.end()[-2];
+				int timeChange = portData[i].time.end()[-1] - portData[i].time.end()[-2];
+				if(portData[i].velocity.size() > 2) portData[i].acceleration = portData[i].acceleration * 0.7 + velocityChange * 1000.0 / timeChange * 0.3;
+
+				encoderCheck(i, encoderTest && portData[i].state == 3 && portData[i].velocityStep < 0 && portData[i].requestedVoltageValue != 0);
+
+				portData[i].lastReading = pros::millis();
+				portData[i].revision++;
+			}
+		}
+		else if(port == pros::c::E_DEVICE_RADIO) portData[i].device = port;
+		else if(port == pros::c::E_DEVICE_VISION) portData[i].device = port;
+		else if(portData[i].state != 0 && portData[i].device == pros::c::E_DEVICE_MOTOR)
+		{
+			portData[i].device = port;
+			resetPort(i, 0);
+		}
+		else portData[i].device = port;
+	}
+}
+
+static void engineLoop(void * parameter)
+{
+	uint32_t wake = pros::millis();
+
+	while(true)
+	{
+		uint32_t loopStart = profilerTicks();
+
+		engineTick();
+
+		profilerRecord(ZONE_LOOP, profilerTicksToNs(profilerTicks() - loopStart));
+		taskMonitorCountSwitch();
+
+		// Headless runs on a fixed 1 ms period so samples land right when the interval elapses
+		if(engineMode == ENGINE_MODE_HEADLESS) pros::c::task_delay_until(&wake, 1);
+		else
+		{
+			pros::delay(3);
+			wake = pros::millis();
+		}
+	}
+}
+
+void engineStart()
+{
+	if(engineTask != NULL) return;
+
+	engineMutex = pros::c::mutex_create();
+	checkpointLoad();
+	engineTask = pros::c::task_create(engineLoop, NULL, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "Test Engine");
+}
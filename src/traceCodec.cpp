@@ -0,0 +1,67 @@
+#include "traceCodec.hpp"
+#include "varint.hpp"
+
+// Arithmetic wraps at 32 bits on both sides, so any int32 residual round-trips
+static int32_t predict(int channel, const int32_t * previous, int32_t step)
+{
+	return channel == TRACE_TIME ? (int32_t)((uint32_t)previous[TRACE_TIME] + step) : previous[channel];
+}
+
+static int32_t difference(int32_t a, int32_t b) {return (int32_t)((uint32_t)a - (uint32_t)b);}
+
+size_t TraceEncoder::encode(const TraceSample & sample, uint8_t * out)
+{
+	size_t length = 1;
+
+	if(nextIsKeyframe())
+	{
+		out[0] = TRACE_KEYFRAME_FLAG | ((1 << TRACE_CHANNELS) - 1);
+		for(int c = 0; c < TRACE_CHANNELS; c++) length += varintPut(out + length, zigzagEncode(sample.value[c]));
+		step = 0;
+	}
+	else
+	{
+		uint8_t mask = 0;
+		for(int c = 0; c < TRACE_CHANNELS; c++)
+		{
+			int32_t residual = difference(sample.value[c], predict(c, previous, step));
+			if(residual == 0) continue;
+			mask |= 1 << c;
+			length += varintPut(out + length, zigzagEncode(residual));
+		}
+		out[0] = mask;
+		step = difference(sample.value[TRACE_TIME], previous[TRACE_TIME]);
+	}
+
+	for(int c = 0; c < TRACE_CHANNELS; c++) previous[c] = sample.value[c];
+	count++;
+	return length;
+}
+
+bool TraceDecoder::next(TraceSample & sample)
+{
+	if(cursor >= end) return false;
+
+	uint8_t header = *cursor++;
+	bool keyframe = header & TRACE_KEYFRAME_FLAG;
+	if(!keyframe && !started) return false;
+
+	for(int c = 0; c < TRACE_CHANNELS; c++)
+	{
+		int32_t base = keyframe ? 0 : predict(c, previous, step);
+		if(header & (1 << c))
+		{
+			uint64_t value;
+			size_t used = varintGet(cursor, end, value);
+			if(used == 0) return false;
+			cursor += used;
+			sample.value[c] = (int32_t)((uint32_t)base + (uint32_t)zigzagDecode(value));
+		}
+		else sample.value[c] = base;
+	}
+
+	step = keyframe ? 0 : difference(sample.value[TRACE_TIME], previous[TRACE_TIME]);
+	for(int c = 0; c < TRACE_CHANNELS; c++) previous[c] = sample.value[c];
+	started = true;
+	return true;
+}
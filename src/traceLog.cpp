@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include "lzBlock.hpp"
+#include "traceLog.hpp"
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+bool traceLogCompress = true;
+
+static LzWork lzWork;
+static uint8_t lzBlock[LZ_COMPRESS_BOUND(LZ_BLOCK_SIZE)];
+static TraceLogStats stats = {};
+
+bool traceLogWrite(FILE * file, const TestRecord & record)
+{
+	TraceLogHeader header = {TRACE_LOG_MAGIC, record.time, (uint8_t)(record.port + 1), (uint8_t)record.state, TRACE_KEYFRAME_INTERVAL};
+	std::vector<uint8_t> payload;
+	{
+		EngineLock lock;
+		const PortData & port = portData[record.port];
+		if(port.state != record.state || port.traceSamples == 0) return false;
+
+		header.samples = port.traceSamples;
+		header.bytes = port.trace.size();
+		size_t keyframeBytes = port.traceKeyframes.size() * sizeof(uint32_t);
+		payload.resize(keyframeBytes + port.trace.size());
+		memcpy(payload.data(), port.traceKeyframes.data(), keyframeBytes);
+		memcpy(payload.data() + keyframeBytes, port.trace.data(), port.trace.size());
+	}
+
+	if(!traceLogCompress)
+	{
+		header.storedBytes = payload.size();
+		uint64_t start = vexSystemHighResTimeGet();
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+		stats.writeUs += vexSystemHighResTimeGet() - start;
+		stats.segments++;
+		stats.rawBytes += payload.size();
+		stats.storedBytes += payload.size();
+		return ok;
+	}
+
+	// Compress block by block into stored; a block that doesn't shrink is kept as is
+	uint64_t start = vexSystemHighResTimeGet();
+	std::vector<uint8_t> stored;
+	stored.reserve(payload.size() + (payload.size() / LZ_BLOCK_SIZE + 1) * sizeof(LzBlockHeader));
+
+	for(size_t offset = 0; offset < payload.size(); offset += LZ_BLOCK_SIZE)
+	{
+		LzBlockHeader block;
+		block.rawLength = std::min(payload.size() - offset, (size_t)LZ_BLOCK_SIZE);
+		int length = lzCompress(lzWork, payload.data() + offset, block.rawLength, lzBlock, sizeof(lzBlock));
+		bool compressed = length >= 0 && length < block.rawLength;
+		block.storedLength = compressed ? length : block.rawLength;
+
+		stored.insert(stored.end(), (uint8_t *)&block, (uint8_t *)&block + sizeof(block));
+		const uint8_t * data = compressed ? lzBlock : payload.data() + offset;
+		stored.insert(stored.end(), data, data + block.storedLength);
+	}
+	stats.compressUs += vexSystemHighResTimeGet() - start;
+
+	header.flags = TRACE_LOG_LZ;
+	header.storedBytes = stored.size();
+
+	start = vexSystemHighResTimeGet();
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(stored.data(), 1, stored.size(), file) == stored.size();
+	stats.writeUs += vexSystemHighResTimeGet() - start;
+
+	stats.segments++;
+	stats.rawBytes += payload.size();
+	stats.storedBytes += stored.size();
+	return ok;
+}
+
+const TraceLogStats & traceLogStats() {return stats;}
+
+std::string traceLogReport()
+{
+	char line[112];
+	snprintf(line, sizeof(line), "Trace log: %lu segments, LZ %s %.2fx at %.1f MB/s, write %.0f us/KB\n", (unsigned long)stats.segments,
+		traceLogCompress ? "on" : "off", stats.storedBytes == 0 ? 0 : stats.rawBytes / (double)stats.storedBytes,
+		stats.compressUs == 0 ? 0 : stats.rawBytes / (double)stats.compressUs, stats.storedBytes == 0 ? 0 : stats.writeUs * 1024.0 / stats.storedBytes);
+	return line;
+}
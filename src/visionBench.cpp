@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include "main.h"
+#include "visionBench.hpp"
+#include "controllerLatency.hpp"
+#include "taskMonitor.hpp"
+
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+#define VISION_DWELL_MS 3000
+
+const uint8_t visionExposures[VISION_EXPOSURE_STEPS] = {30, 60, 90, 120};
+
+struct VisionFrame
+{
+	int32_t count;
+	pros::vision_object_s_t objects[VISION_MAX_OBJECTS];
+};
+
+static pros::task_t visionTask = NULL;
+static pros::mutex_t visionMutex = NULL;
+static volatile bool running = false;
+static bool exposureChanged = false;
+static VisionBench bench = {-1};
+
+static VisionFrame lastFrame;
+static bool haveFrame;
+static uint64_t lastFrameUs;
+static uint64_t exposureSetUs;
+static bool awaitingFrame;
+static uint32_t stepStart;
+
+class VisionLock
+{
+public:
+	VisionLock() {pros::c::mutex_take(visionMutex, TIMEOUT_MAX);}
+	~VisionLock() {pros::c::mutex_give(visionMutex);}
+};
+
+static void setExposure(int step)
+{
+	bench.step = step;
+	pros::c::vision_set_exposure(bench.port + 1, visionExposures[step]);
+	exposureSetUs = vexSystemHighResTimeGet();
+	awaitingFrame = true;
+	exposureChanged = true;
+	stepStart = pros::millis();
+}
+
+static void restoreExposure()
+{
+	if(!exposureChanged) return;
+	if(bench.originalExposure != PROS_ERR) pros::c::vision_set_exposure(bench.port + 1, bench.originalExposure);
+	exposureChanged = false;
+}
+
+// Reads the objects in view, or returns false if the sensor did not answer
+static bool readFrame(VisionFrame & frame)
+{
+	uint8_t port = bench.port + 1;
+	memset(&frame, 0, sizeof(frame));
+
+	frame.count = pros::c::vision_get_object_count(port);
+	if(frame.count == PROS_ERR) return false;
+
+	// Both reads fail with EDOM when nothing matches
+	int32_t read = 0;
+	if(bench.mode == VISION_READ_SIZE && frame.count > 0) read = pros::c::vision_read_by_size(port, 0, std::min(frame.count, (int32_t)VISION_MAX_OBJECTS), frame.objects);
+	if(bench.mode == VISION_READ_SIGNATURE) read = pros::c::vision_read_by_sig(port, 0, 1, VISION_MAX_OBJECTS, frame.objects);
+	if(read == PROS_ERR && errno != EDOM) return false;
+	if(bench.mode == VISION_READ_SIGNATURE) frame.count = read == PROS_ERR ? 0 : read;
+	return true;
+}
+
+static void poll()
+{
+	VisionFrame frame;
+	uint64_t startUs = vexSystemHighResTimeGet();
+	bool ok = readFrame(frame);
+	uint64_t nowUs = vexSystemHighResTimeGet();
+
+	uint32_t callUs = nowUs - startUs;
+	bench.call[std::min(callUs / VISION_CALL_BIN_US, (uint32_t)VISION_CALL_BINS - 1)]++;
+	bench.maxCallUs = std::max(bench.maxCallUs, callUs);
+	bench.polls++;
+	bench.connected = ok;
+	if(!ok)
+	{
+		bench.errors++;
+		haveFrame = false;
+		return;
+	}
+
+	if(haveFrame && memcmp(&frame, &lastFrame, sizeof(frame)) != 0)
+	{
+		VisionStep & step = bench.steps[bench.step];
+		uint32_t ms = (nowUs - lastFrameUs) / 1000;
+		step.interval[std::min(ms, (uint32_t)VISION_INTERVAL_BINS - 1)]++;
+		step.frames++;
+		step.objects += frame.count;
+		controllerHistogramPeriod(step.interval, VISION_INTERVAL_BINS, step.periodMs, step.jitterMs);
+		if(step.periodMs > 0) step.rate = 1000.0 / step.periodMs;
+		lastFrameUs = nowUs;
+
+		if(awaitingFrame)
+		{
+			uint32_t latencyMs = (nowUs - exposureSetUs) / 1000;
+			step.latency[std::min(latencyMs / VISION_LATENCY_BIN_MS, (uint32_t)VISION_LATENCY_BINS - 1)]++;
+			step.latencyCount++;
+			awaitingFrame = false;
+		}
+	}
+	if(!haveFrame) lastFrameUs = nowUs;
+	haveFrame = true;
+	lastFrame = frame;
+}
+
+static void visionLoop(void * parameter)
+{
+	uint32_t wake = pros::millis();
+
+	while(true)
+	{
+		if(!running)
+		{
+			{
+				VisionLock lock;
+				restoreExposure();
+			}
+			taskMonitorCountSwitch();
+			pros::delay(20);
+			wake = pros::millis();
+			continue;
+		}
+
+		{
+			VisionLock lock;
+			if(!exposureChanged || pros::millis() - stepStart >= VISION_DWELL_MS) setExposure(exposureChanged ? (bench.step + 1) % VISION_EXPOSURE_STEPS : 0);
+			poll();
+		}
+
+		taskMonitorCountSwitch();
+		pros::c::task_delay_until(&wake, 1);
+	}
+}
+
+void visionBenchStart(int port, VisionReadMode mode)
+{
+	if(visionMutex == NULL) visionMutex = pros::c::mutex_create();
+	if(running && port == bench.port && mode == bench.mode) return;
+
+	running = false;
+	{
+		VisionLock lock;
+		restoreExposure();
+		bench = VisionBench();
+		bench.port = port;
+		bench.mode = mode;
+		bench.originalExposure = pros::c::vision_get_exposure(port + 1);
+		haveFrame = false;
+		awaitingFrame = false;
+	}
+	running = true;
+	if(visionTask == NULL) visionTask = pros::c::task_create(visionLoop, NULL, TASK_PRIORITY_DEFAULT + 2, TASK_STACK_DEPTH_DEFAULT, "Vision Bench");
+}
+
+void visionBenchStop() {running = false;}
+
+void visionBenchReset()
+{
+	if(visionMutex == NULL) return;
+	VisionLock lock;
+	memset(bench.call, 0, sizeof(bench.call));
+	memset(bench.steps, 0, sizeof(bench.steps));
+	bench.polls = bench.errors = bench.maxCallUs = 0;
+	haveFrame = false;
+	awaitingFrame = false;
+}
+
+VisionBench visionBenchGet()
+{
+	if(visionMutex == NULL) return bench;
+	VisionLock lock;
+	return bench;
+}
+
+std::string visionBenchReport()
+{
+	VisionBench b = visionBenchGet();
+	if(b.port < 0) return "";
+
+	char line[160];
+	snprintf(line, sizeof(line), "Port %d, by %s: %s\ncall p50 %.0f p99 %.0f max %lu us\n%lu polls, %lu errors\n", b.port + 1,
+		b.mode == VISION_READ_SIZE ? "size" : "sig 1", b.connected ? "connected" : "#ff0000 not answering#",
+		controllerHistogramPercentile(b.call, VISION_CALL_BINS, VISION_CALL_BIN_US, 0.5), controllerHistogramPercentile(b.call, VISION_CALL_BINS, VISION_CALL_BIN_US, 0.99),
+		(unsigned long)b.maxCallUs, (unsigned long)b.polls, (unsigned long)b.errors);
+	std::string a = line;
+
+	for(int i = 0; i < VISION_EXPOSURE_STEPS; i++)
+	{
+		const VisionStep & s = b.steps[i];
+		snprintf(line, sizeof(line), "%sExp %d: %.0f Hz, jitter %.1f, %.1f obj\nlatency p50 %.0f p90 %.0f, n %lu\n", i == b.step ? "> " : "", visionExposures[i],
+			s.rate, s.jitterMs, s.frames == 0 ? 0 : s.objects / (double)s.frames,
+			controllerHistogramPercentile(s.latency, VISION_LATENCY_BINS, VISION_LATENCY_BIN_MS, 0.5),
+			controllerHistogramPercentile(s.latency, VISION_LATENCY_BINS, VISION_LATENCY_BIN_MS, 0.9), (unsigned long)s.latencyCount);
+		a += line;
+	}
+	return a;
+}